@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <library/system.h>
+#include <fmt/format.h>
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+
+
+namespace
+{
+
+    static auto constexpr default_actor_count = (1 << 20);
+    static auto constexpr round_trips = 8;
+    static auto constexpr fan_out_rounds = 8;
+
+    struct message
+    {
+        std::uint32_t remaining_;
+    };
+
+    using actor_type = maniscalco::system::actor<message, work_contract_group_type::mode>;
+
+
+    //=========================================================================
+    void wait_for
+    (
+        std::atomic<std::size_t> const & counter,
+        std::size_t expected
+    )
+    {
+        while (counter.load(std::memory_order_acquire) != expected)
+            std::this_thread::yield();
+    }
+
+
+    //=========================================================================
+    void report
+    (
+        char const * name,
+        std::size_t messageCount,
+        std::chrono::nanoseconds elapsed
+    )
+    {
+        std::cout << fmt::format("{:<12}{:>14}{:>14.1f}{:>16.2f}\n", name, messageCount, 
+                (double)elapsed.count() / messageCount, (double)messageCount * 1000.0 / elapsed.count());
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    // ping-pong: actors are paired and each pair exchanges round_trips messages back and forth.
+    // fan-out: one thread sends a message to every actor, fan_out_rounds times.
+    int argc,
+    char const ** argv
+)
+{
+    using namespace maniscalco::system;
+
+    std::size_t actorCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : default_actor_count;
+    actorCount = std::max<std::size_t>(2, actorCount & ~std::size_t(1));
+
+    work_contract_group_type workContractGroup(actorCount);
+    thread_pool::configuration threadPoolConfiguration;
+    auto workerCount = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < workerCount; ++i)
+        threadPoolConfiguration.threads_.push_back({.function_ = [&](auto const & stopToken)
+                {
+                    while (!stopToken.stop_requested())
+                        workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+                }});
+    thread_pool threadPool(threadPoolConfiguration);
+
+    std::atomic<std::size_t> pingPongsCompleted{0};
+    std::atomic<std::size_t> fanOutReceived{0};
+    std::vector<std::unique_ptr<actor_type>> actors(actorCount);
+    for (std::size_t i = 0; i < actorCount; ++i)
+        actors[i] = std::make_unique<actor_type>(workContractGroup, [&, i](message && m)
+                {
+                    if (m.remaining_ == ~std::uint32_t(0))
+                        fanOutReceived.fetch_add(1, std::memory_order_relaxed);
+                    else if (m.remaining_ > 0)
+                        actors[i ^ 1]->send(message{m.remaining_ - 1});
+                    else
+                        pingPongsCompleted.fetch_add(1, std::memory_order_release);
+                });
+
+    std::cout << fmt::format("{} actors, {} workers\n", actorCount, workerCount);
+    std::cout << fmt::format("{:<12}{:>14}{:>14}{:>16}\n", "", "messages", "ns per msg", "msgs per us");
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < actorCount; i += 2)
+        actors[i]->send(message{(2 * round_trips) - 1});
+    wait_for(pingPongsCompleted, actorCount / 2);
+    report("ping-pong", actorCount * round_trips, std::chrono::steady_clock::now() - startTime);
+
+    startTime = std::chrono::steady_clock::now();
+    for (auto round = 0; round < fan_out_rounds; ++round)
+        for (auto & actor : actors)
+            actor->send(message{~std::uint32_t(0)});
+    wait_for(fanOutReceived, actorCount * fan_out_rounds);
+    report("fan-out", actorCount * fan_out_rounds, std::chrono::steady_clock::now() - startTime);
+
+    threadPool.stop(synchronization_mode::blocking);
+    return 0;
+}
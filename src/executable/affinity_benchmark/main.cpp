@@ -0,0 +1,120 @@
+#include <cstddef>
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <string>
+
+#include <library/system.h>
+#include <library/system/diagnostics.h>
+#include <fmt/format.h>
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+using work_contract_type = maniscalco::system::work_contract<work_contract_group_type::mode>;
+using performance_counter = maniscalco::system::performance_counter;
+
+
+//=============================================================================
+void measure
+(
+    // each contract owns per core state (state_size bytes which it sweeps on every execution)
+    // and re-invokes itself.  without affinity any worker executes any contract and the state
+    // follows the contract from core to core.  with affinity contract i is restricted to worker
+    // (i % workers) so its state stays in that core's cache.
+    std::string const & name,
+    bool useAffinity,
+    std::vector<performance_counter::event> const & events
+)
+{
+    static auto constexpr test_duration = std::chrono::milliseconds(1000);
+    static auto constexpr contracts_per_worker = 4;
+    static auto constexpr state_size = (16 << 10);
+
+    maniscalco::system::thread_pool::thread_configuration worker;
+    work_contract_group_type * group = nullptr;
+    std::atomic<std::size_t> totalTaskCount;
+    thread_local std::size_t taskCount;
+    worker.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested()) 
+                    group->execute_next_contract(std::chrono::milliseconds(10)); 
+                totalTaskCount += taskCount;
+                taskCount = 0;
+            };
+    auto threadPoolConfiguration = maniscalco::system::thread_pool::configuration::from_placement(
+            {.policy_ = maniscalco::system::placement_policy::one_per_physical_core}, worker);
+    auto workerCount = threadPoolConfiguration.threads_.size();
+    auto contractCount = (workerCount * contracts_per_worker);
+
+    work_contract_group_type workContractGroup(1024);
+    group = &workContractGroup;
+    std::vector<std::vector<std::uint64_t>> state(contractCount, std::vector<std::uint64_t>(state_size / sizeof(std::uint64_t)));
+    std::vector<work_contract_type> workContracts(contractCount);
+    for (std::size_t i = 0; i < contractCount; ++i)
+    {
+        auto work = [&, index = i]()
+                {
+                    ++taskCount;
+                    for (auto & value : state[index])
+                        ++value;
+                    workContracts[index].invoke();
+                };
+        workContracts[i] = (useAffinity) ? 
+                workContractGroup.create_contract(work, maniscalco::system::contract_affinity{.workerMask_ = (1ull << (i % std::min<std::size_t>(workerCount, 64)))}) :
+                workContractGroup.create_contract(work);
+    }
+    for (auto & workContract : workContracts)
+        workContract.invoke();
+
+    // counters are opened before the workers are created so that worker threads are included
+    std::vector<performance_counter> counters;
+    for (auto event : events)
+        counters.emplace_back(event, performance_counter::include_child_threads);
+
+    for (auto & counter : counters)
+        counter.start();
+    auto startTime = std::chrono::steady_clock::now();
+    {
+        maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+        std::this_thread::sleep_for(test_duration);
+        threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+    }
+    auto elapsedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    for (auto & counter : counters)
+        counter.stop();
+    for (auto & workContract : workContracts)
+        workContract.surrender();
+
+    std::cout << fmt::format("{:<16} workers = {:<3} tasks per sec = {:>10}", name, workerCount, (std::size_t)(totalTaskCount / elapsedTime));
+    for (auto && [index, counter] : ranges::v3::views::enumerate(counters))
+    {
+        if (auto value = counter.get_value(); value.has_value())
+            std::cout << fmt::format(", {} per task = {:.1f}", performance_counter::get_name(events[index]), (double)*value / std::max<std::size_t>(totalTaskCount, 1));
+        else
+            std::cout << fmt::format(", {} = n/a", performance_counter::get_name(events[index]));
+    }
+    std::cout << std::endl;
+}
+
+
+//=============================================================================
+int main
+(
+    int, 
+    char const **
+)
+{    
+    using namespace maniscalco::system;
+    static auto constexpr num_loops = 3;
+
+    std::vector<performance_counter::event> events{performance_counter::event::l1d_load_misses, performance_counter::event::llc_load_misses};
+    for (auto i = 0; i < num_loops; ++i)
+    {
+        measure("any worker", false, events);
+        measure("affine", true, events);
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <library/system.h>
+#include <library/system/logging.h>
+#include <fmt/format.h>
+
+#include <fcntl.h>
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+
+
+namespace
+{
+
+    static auto constexpr record_count = 1000000;
+    static auto constexpr warm_up_count = 10000;
+    static auto constexpr ring_capacity = (1 << 22);
+
+    // heap allocations made while measuring
+    std::atomic<std::size_t> allocationCount{0};
+
+
+    //=========================================================================
+    template <typename F, typename W>
+    void measure
+    (
+        // cost to the calling thread of each log call, and including the time taken to
+        // write everything out (flush), per record
+        char const * name,
+        F && logRecord,
+        W && flush,
+        std::function<std::uint64_t()> getDroppedCount = nullptr
+    )
+    {
+        for (std::size_t i = 0; i < warm_up_count; ++i)
+            logRecord(i);
+        flush();
+        auto allocationsBefore = allocationCount.load();
+        auto droppedCountBefore = (getDroppedCount) ? getDroppedCount() : 0;
+        auto startTime = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < record_count; ++i)
+            logRecord(i);
+        auto logTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+        flush();
+        auto totalTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+        std::cout << fmt::format("{:<32}{:>12.1f}{:>12.1f}{:>14}{:>10}\n", name, (double)logTime.count() / record_count,
+                (double)totalTime.count() / record_count, allocationCount.load() - allocationsBefore,
+                ((getDroppedCount) ? getDroppedCount() : 0) - droppedCountBefore);
+    }
+
+} // namespace
+
+
+//=============================================================================
+void * operator new
+(
+    std::size_t size
+)
+{
+    ++allocationCount;
+    if (auto address = std::malloc(std::max<std::size_t>(size, 1)); address != nullptr)
+        return address;
+    throw std::bad_alloc();
+}
+
+
+//=============================================================================
+// not inlined: gcc would pair the free() with an operator new call and warn (-Wmismatched-new-delete)
+[[gnu::noinline]] void operator delete
+(
+    void * address
+) noexcept
+{
+    std::free(address);
+}
+
+
+//=============================================================================
+[[gnu::noinline]] void operator delete
+(
+    void * address,
+    std::size_t
+) noexcept
+{
+    std::free(address);
+}
+
+
+//=============================================================================
+int main
+(
+    // logging to /dev/null: the async_logger (binary records, formatted and written by a
+    // contract) against formatting and writing synchronously to a std::ofstream
+    int,
+    char const **
+)
+{
+    using namespace maniscalco::system;
+
+    work_contract_group_type workContractGroup(8);
+    thread_pool::configuration threadPoolConfiguration;
+    threadPoolConfiguration.threads_.push_back({.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested())
+                    workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+            }});
+    thread_pool threadPool(threadPoolConfiguration);
+
+    std::string symbol = "MSFT";
+
+    std::cout << fmt::format("{:<32}{:>12}{:>12}{:>14}{:>10}\n", "", "ns per call", "ns total", "allocations", "dropped");
+
+    {
+        async_logger logger(workContractGroup, file_descriptor(::open("/dev/null", O_WRONLY)), ring_capacity);
+        auto getDroppedCount = [&](){return logger.get_dropped_count();};
+        measure("async_logger (numbers)", [&](std::size_t i)
+                {
+                    logger.log<"order {} filled at {} quantity {}">(i, 101.25, 300);
+                },
+                [&](){logger.flush();}, getDroppedCount);
+
+        measure("async_logger (string)", [&](std::size_t i)
+                {
+                    logger.log<"order {} for {} filled at {}">(i, symbol, 101.25);
+                },
+                [&](){logger.flush();}, getDroppedCount);
+    }
+
+    std::ofstream stream("/dev/null");
+    measure("std::ofstream (numbers)", [&](std::size_t i)
+            {
+                stream << fmt::format("order {} filled at {} quantity {}", i, 101.25, 300) << '\n';
+            },
+            [&](){stream.flush();});
+
+    measure("std::ofstream (string)", [&](std::size_t i)
+            {
+                stream << fmt::format("order {} for {} filled at {}", i, symbol, 101.25) << '\n';
+            },
+            [&](){stream.flush();});
+
+    threadPool.stop(synchronization_mode::blocking);
+    return 0;
+}
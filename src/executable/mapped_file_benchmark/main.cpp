@@ -0,0 +1,156 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <library/system.h>
+#include <library/system/memory.h>
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    static auto constexpr record_count = (4 << 20);
+    static auto constexpr read_size = (64 << 10);
+
+    struct record
+    {
+        std::uint64_t   sequence_;
+        std::int64_t    timestamp_;
+        double          price_;
+        std::uint32_t   quantity_;
+        char            symbol_[36];
+    };
+    static_assert(sizeof(record) == 64);
+
+
+    //=========================================================================
+    double process
+    (
+        record const & r
+    )
+    {
+        return (r.price_ * r.quantity_) + r.symbol_[r.sequence_ % 4];
+    }
+
+
+    //=========================================================================
+    void drop_page_cache
+    (
+        std::filesystem::path const & path
+    )
+    {
+        // evict the (clean) pages of the file so that the next replay reads from storage
+        maniscalco::system::file_descriptor fileDescriptor(::open(path.c_str(), O_RDONLY));
+        ::posix_fadvise(fileDescriptor.get(), 0, 0, POSIX_FADV_DONTNEED);
+    }
+
+
+    //=========================================================================
+    template <typename F>
+    void measure
+    (
+        char const * name,
+        std::filesystem::path const & path,
+        F && replay
+    )
+    {
+        auto run = [&]()
+                {
+                    auto startTime = std::chrono::steady_clock::now();
+                    auto checksum = replay();
+                    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+                    if (checksum == 0)
+                        std::cout << "unexpected checksum\n";
+                    return elapsed;
+                };
+        drop_page_cache(path);
+        auto cold = run();
+        auto warm = run();
+        auto gigabytesPerSecond = [](auto elapsed){return ((double)record_count * sizeof(record)) / elapsed.count();};
+        std::cout << fmt::format("{:<36}{:>12.2f}{:>12.2f}{:>14.1f}\n", name, gigabytesPerSecond(cold), gigabytesPerSecond(warm),
+                (double)warm.count() / record_count);
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    // write a journal of fixed size records by appending to a mapped_file then replay it
+    // through the mapping against read() into a buffer.  cold runs follow eviction of the
+    // file from the page cache.
+    int argc,
+    char const ** argv
+)
+{
+    using namespace maniscalco::system;
+
+    std::filesystem::path path = (argc > 1) ? argv[1] : "/tmp/mapped_file_benchmark.journal";
+
+    {
+        mapped_file journal(path, {.ioMode_ = io_mode::read_write, .growthSize_ = (64 << 20), .truncate_ = true});
+        record r{.price_ = 101.25, .symbol_ = "MSFT"};
+        auto startTime = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < record_count; ++i)
+        {
+            r.sequence_ = i;
+            r.timestamp_ = i * 1000;
+            r.quantity_ = (i % 1000);
+            journal.append(&r, sizeof(r));
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+        std::cout << fmt::format("appended {} MB in {} ms ({:.1f} ns per record)\n", (record_count * sizeof(record)) >> 20,
+                elapsed.count() / 1000000, (double)elapsed.count() / record_count);
+        journal.sync();
+    }
+
+    std::cout << fmt::format("{:<36}{:>12}{:>12}{:>14}\n", "", "cold GB/s", "warm GB/s", "warm ns/rec");
+
+    measure("read() into 64KB buffer", path, [&]()
+            {
+                file_descriptor fileDescriptor(::open(path.c_str(), O_RDONLY));
+                std::vector<record> buffer(read_size / sizeof(record));
+                double checksum = 0;
+                while (true)
+                {
+                    auto result = ::read(fileDescriptor.get(), buffer.data(), read_size);
+                    if (result <= 0)
+                        break;
+                    // records never straddle reads from a regular file with a whole record read size
+                    for (std::size_t i = 0; i < (result / sizeof(record)); ++i)
+                        checksum += process(buffer[i]);
+                }
+                return checksum;
+            });
+
+    auto replayMapping = [&](mapped_file::configuration const & config)
+            {
+                mapped_file journal(path, config);
+                auto records = reinterpret_cast<record const *>(journal.data());
+                double checksum = 0;
+                for (std::size_t i = 0; i < (journal.size() / sizeof(record)); ++i)
+                    checksum += process(records[i]);
+                return checksum;
+            };
+
+    measure("mapped_file", path, [&](){return replayMapping({});});
+    measure("mapped_file (sequential)", path, [&](){return replayMapping({.accessPattern_ = mapped_file::access_pattern::sequential});});
+    measure("mapped_file (populate)", path, [&](){return replayMapping({.populate_ = true});});
+    measure("mapped_file (sequential, huge)", path, [&]()
+            {
+                return replayMapping({.accessPattern_ = mapped_file::access_pattern::sequential, .pageType_ = page_type::transparent_huge});
+            });
+
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <library/system.h>
+#include <library/system/parallel.h>
+#include <fmt/format.h>
+
+#ifdef PARALLEL_BENCHMARK_HAVE_PARALLEL_STL
+#include <execution>
+#include <oneapi/tbb/global_control.h>
+#endif
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+using parallel_executor_type = maniscalco::system::parallel_executor<work_contract_group_type::mode>;
+
+
+namespace
+{
+
+    static auto constexpr element_count = (1 << 24);
+    static auto constexpr sort_element_count = (1 << 23);
+    static auto constexpr repetitions = 5;
+
+    // reductions are stored here so that they can not be optimized away
+    volatile double reduceSink;
+
+    struct result
+    {
+        double for_;
+        double reduce_;
+        double sort_;
+    };
+
+
+    //=========================================================================
+    template <typename F>
+    double best_of
+    (
+        // best of several runs in milliseconds
+        F && function
+    )
+    {
+        auto best = std::chrono::nanoseconds::max();
+        for (auto i = 0; i < repetitions; ++i)
+        {
+            auto startTime = std::chrono::steady_clock::now();
+            function();
+            best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime));
+        }
+        return ((double)best.count() / 1000000.0);
+    }
+
+
+    //=========================================================================
+    result measure_work_contracts
+    (
+        // threadCount - 1 pool workers service the group and the calling thread participates
+        std::size_t threadCount,
+        std::vector<double> const & input,
+        std::vector<std::uint64_t> const & sortInput
+    )
+    {
+        work_contract_group_type workContractGroup(64);
+        maniscalco::system::thread_pool::configuration threadPoolConfiguration;
+        for (std::size_t i = 1; i < threadCount; ++i)
+            threadPoolConfiguration.threads_.push_back({.function_ = [&](auto const & stopToken)
+                    {
+                        while (!stopToken.stop_requested())
+                            workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+                    }});
+        maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+        parallel_executor_type parallelExecutor(workContractGroup, threadCount - 1);
+
+        std::vector<double> output(input.size());
+        std::vector<std::uint64_t> sortData;
+        result measurement;
+        measurement.for_ = best_of([&]()
+                {
+                    parallelExecutor.parallel_for(0, input.size(), [&](std::size_t i){output[i] = std::sqrt(input[i]) * std::sin(input[i]);}, 1024);
+                });
+        measurement.reduce_ = best_of([&]()
+                {
+                    reduceSink = parallelExecutor.parallel_reduce(0, input.size(), 0.0, [&](std::size_t i){return input[i] * input[i];}, std::plus<>(), 1024);
+                });
+        measurement.sort_ = best_of([&]()
+                {
+                    sortData = sortInput;
+                    parallelExecutor.parallel_sort(sortData.begin(), sortData.end());
+                });
+        if (!std::is_sorted(sortData.begin(), sortData.end()))
+            std::cerr << "parallel_sort failed\n";
+        threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+        return measurement;
+    }
+
+
+#ifdef PARALLEL_BENCHMARK_HAVE_PARALLEL_STL
+    //=========================================================================
+    result measure_parallel_stl
+    (
+        std::size_t threadCount,
+        std::vector<double> const & input,
+        std::vector<std::uint64_t> const & sortInput
+    )
+    {
+        tbb::global_control globalControl(tbb::global_control::max_allowed_parallelism, threadCount);
+        std::vector<double> output(input.size());
+        std::vector<std::uint64_t> sortData;
+        result measurement;
+        measurement.for_ = best_of([&]()
+                {
+                    std::transform(std::execution::par, input.begin(), input.end(), output.begin(), [](double x){return std::sqrt(x) * std::sin(x);});
+                });
+        measurement.reduce_ = best_of([&]()
+                {
+                    reduceSink = std::transform_reduce(std::execution::par, input.begin(), input.end(), 0.0, std::plus<>(), [](double x){return x * x;});
+                });
+        measurement.sort_ = best_of([&]()
+                {
+                    sortData = sortInput;
+                    std::sort(std::execution::par, sortData.begin(), sortData.end());
+                });
+        return measurement;
+    }
+#endif
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    // scaling of parallel_executor (parallel_for, parallel_reduce and parallel_sort) with
+    // thread count, alongside std::execution::par when the parallel stl is available.
+    int,
+    char const **
+)
+{
+    std::mt19937_64 random;
+    std::vector<double> input(element_count);
+    for (auto & value : input)
+        value = (double)(random() % 1000000);
+    std::vector<std::uint64_t> sortInput(sort_element_count);
+    for (auto & value : sortInput)
+        value = random();
+
+    std::vector<std::size_t> threadCounts;
+    std::size_t hardwareConcurrency = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t threadCount = 1; threadCount < hardwareConcurrency; threadCount *= 2)
+        threadCounts.push_back(threadCount);
+    threadCounts.push_back(hardwareConcurrency);
+
+    std::cout << fmt::format("{:>8}{:>18}{:>18}{:>18}{:>14}{:>14}{:>14}\n", "threads", 
+            "for ms", "reduce ms", "sort ms", "par for ms", "par reduce ms", "par sort ms");
+    std::optional<result> baseline;
+    for (auto threadCount : threadCounts)
+    {
+        auto measurement = measure_work_contracts(threadCount, input, sortInput);
+        if (!baseline)
+            baseline = measurement;
+        auto cell = [](double milliseconds, double baselineMilliseconds)
+                {
+                    return fmt::format("{:.2f} ({:.1f}x)", milliseconds, baselineMilliseconds / milliseconds);
+                };
+        std::cout << fmt::format("{:>8}{:>18}{:>18}{:>18}", threadCount, cell(measurement.for_, baseline->for_), 
+                cell(measurement.reduce_, baseline->reduce_), cell(measurement.sort_, baseline->sort_));
+        #ifdef PARALLEL_BENCHMARK_HAVE_PARALLEL_STL
+            auto parallelStl = measure_parallel_stl(threadCount, input, sortInput);
+            std::cout << fmt::format("{:>14.2f}{:>14.2f}{:>14.2f}", parallelStl.for_, parallelStl.reduce_, parallelStl.sort_);
+        #else
+            std::cout << fmt::format("{:>14}{:>14}{:>14}", "n/a", "n/a", "n/a");
+        #endif
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <library/system.h>
+#include <fmt/format.h>
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+
+
+namespace
+{
+
+    static auto constexpr sample_count = 20000;
+    static auto constexpr sample_interval = std::chrono::microseconds(50);
+
+
+    //=========================================================================
+    std::int64_t now
+    (
+    )
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+
+    //=========================================================================
+    void measure
+    (
+        // the main thread invokes a contract every sample_interval and the contract records
+        // the delay from invocation to execution on a single worker configured by the prototype
+        std::string const & name,
+        maniscalco::system::thread_pool::thread_configuration worker
+    )
+    {
+        work_contract_group_type workContractGroup(8);
+        worker.function_ = [&](auto const & stopToken)
+                {
+                    while (!stopToken.stop_requested())
+                        workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+                };
+        worker.setupFailureHandler_ = [&](auto const & failures)
+                {
+                    for (auto const & failure : failures)
+                        std::cout << fmt::format("{}: worker {} could not apply {} ({})\n", name, 
+                                maniscalco::system::worker_context::get_current()->get_worker_index(), 
+                                maniscalco::system::realtime_profile::get_name(failure.setting_), std::strerror(failure.errorCode_));
+                };
+        // the worker on the last cpu and the invoking (main) thread elsewhere when there is more than one
+        if (auto cpuCount = std::thread::hardware_concurrency(); cpuCount > 1)
+        {
+            worker.cpuSet_ = {cpuCount - 1};
+            maniscalco::system::set_cpu_affinity(maniscalco::system::cpu_id(0));
+        }
+
+        std::atomic<std::int64_t> invokeTime{0};
+        std::atomic<std::size_t> executionCount{0};
+        std::vector<std::int64_t> latencies;
+        latencies.reserve(sample_count);
+        auto workContract = workContractGroup.create_contract([&]()
+                {
+                    latencies.push_back(now() - invokeTime.load(std::memory_order_acquire));
+                    executionCount.fetch_add(1, std::memory_order_release);
+                });
+
+        maniscalco::system::thread_pool threadPool({.threads_ = {worker}});
+        for (std::size_t sample = 0; sample < sample_count; ++sample)
+        {
+            std::this_thread::sleep_for(sample_interval);
+            invokeTime.store(now(), std::memory_order_release);
+            workContract.invoke();
+            while (executionCount.load(std::memory_order_acquire) == sample)
+                std::this_thread::yield();
+        }
+        threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p){return latencies[std::min<std::size_t>(latencies.size() * p, latencies.size() - 1)] / 1000.0;};
+        double mean = 0;
+        for (auto latency : latencies)
+            mean += latency;
+        mean /= latencies.size();
+        double variance = 0;
+        for (auto latency : latencies)
+            variance += ((latency - mean) * (latency - mean));
+        std::cout << fmt::format("{:<30}{:>10.2f}{:>10.2f}{:>10.2f}{:>10.2f}{:>12.2f}\n", name, percentile(0.5), percentile(0.99), 
+                percentile(0.999), latencies.back() / 1000.0, std::sqrt(variance / latencies.size()) / 1000.0) << std::flush;
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    // invoke to execute latency (and its jitter) with a default worker, which parks when
+    // idle, against workers with a real time profile
+    int, 
+    char const **
+)
+{
+    using namespace maniscalco::system;
+
+    realtime_profile profile{.schedulingPolicy_ = realtime_profile::scheduling_policy::fifo, .priority_ = 50, 
+            .timerSlack_ = std::chrono::nanoseconds(1), .stackPrefaultSize_ = (256 << 10), .lockMemory_ = true};
+
+    std::cout << fmt::format("{:<30}{:>10}{:>10}{:>10}{:>10}{:>12}\n", "worker", "p50 us", "p99 us", "p99.9 us", "max us", "stddev us");
+    measure("default (parking)", {});
+    measure("realtime profile (parking)", {.realtime_ = profile});
+    measure("busy poll", {.workerContext_ = {.busyPoll_ = true}});
+    // a real time worker which never sleeps starves everything else on its cpu
+    if (std::thread::hardware_concurrency() > 1)
+        measure("realtime profile, busy poll", {.realtime_ = profile, .workerContext_ = {.busyPoll_ = true}});
+    else
+        std::cout << fmt::format("{:<30}skipped, needs a cpu of its own\n", "realtime profile, busy poll");
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <library/system.h>
+#include <library/system/execution.h>
+#include <fmt/format.h>
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+using execution_context_type = maniscalco::system::execution::execution_context<work_contract_group_type::mode>;
+
+
+namespace
+{
+
+    static auto constexpr operation_count = 64;
+    static auto constexpr rounds = 20000;
+
+    // heap allocations made while measuring
+    std::atomic<std::size_t> allocationCount{0};
+
+
+    struct counting_receiver
+    {
+        void set_value(){completed_->fetch_add(1, std::memory_order_release);}
+        void set_error(std::exception_ptr){std::terminate();}
+        void set_stopped(){std::terminate();}
+
+        std::atomic<std::size_t> * completed_;
+    };
+
+
+    //=========================================================================
+    template <typename F>
+    void run_rounds
+    (
+        // start operation_count operations per round and wait for all of them to complete
+        std::atomic<std::size_t> & completed,
+        F && startAll
+    )
+    {
+        for (auto round = 0; round < rounds; ++round)
+        {
+            completed.store(0, std::memory_order_relaxed);
+            startAll();
+            while (completed.load(std::memory_order_acquire) != operation_count)
+                std::this_thread::yield();
+        }
+    }
+
+
+    //=========================================================================
+    template <typename F>
+    void report
+    (
+        char const * name,
+        F && measure
+    )
+    {
+        auto allocationsBefore = allocationCount.load();
+        auto startTime = std::chrono::steady_clock::now();
+        measure();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+        auto allocations = allocationCount.load() - allocationsBefore;
+        std::cout << fmt::format("{:<32}{:>12.1f}{:>16}\n", name, (double)elapsed.count() / (rounds * operation_count), allocations);
+    }
+
+} // namespace
+
+
+//=============================================================================
+void * operator new
+(
+    std::size_t size
+)
+{
+    ++allocationCount;
+    if (auto address = std::malloc(std::max<std::size_t>(size, 1)); address != nullptr)
+        return address;
+    throw std::bad_alloc();
+}
+
+
+//=============================================================================
+[[gnu::noinline]] void operator delete
+(
+    void * address
+) noexcept
+{
+    std::free(address);
+}
+
+
+//=============================================================================
+[[gnu::noinline]] void operator delete
+(
+    void * address,
+    std::size_t
+) noexcept
+{
+    std::free(address);
+}
+
+
+//=============================================================================
+int main
+(
+    // cost of completing on a work_contract_group through schedule() | then(...) compared
+    // with invoking plain work contracts.  operation states are connected once and restarted
+    // each round so the steady state makes no heap allocations.
+    int,
+    char const **
+)
+{
+    using namespace maniscalco::system;
+    using namespace maniscalco::system::execution;
+
+    work_contract_group_type workContractGroup(512);
+    thread_pool::configuration threadPoolConfiguration;
+    auto workerCount = std::max(1u, std::thread::hardware_concurrency() - 1);
+    for (std::size_t i = 0; i < workerCount; ++i)
+        threadPoolConfiguration.threads_.push_back({.function_ = [&](auto const & stopToken)
+                {
+                    while (!stopToken.stop_requested())
+                        workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+                }});
+    thread_pool threadPool(threadPoolConfiguration);
+
+    std::atomic<std::size_t> completed{0};
+    std::atomic<std::size_t> counter{0};
+
+    // plain work contracts
+    std::vector<work_contract<work_contract_group_type::mode>> workContracts;
+    for (auto i = 0; i < operation_count; ++i)
+        workContracts.push_back(workContractGroup.create_contract([&]()
+                {
+                    counter.fetch_add(1, std::memory_order_relaxed);
+                    completed.fetch_add(1, std::memory_order_release);
+                }));
+
+    // senders.  one slot per operation, and a small context to exercise the overflow path.
+    execution_context_type executionContext(workContractGroup, operation_count);
+    execution_context_type smallExecutionContext(workContractGroup, 4);
+    auto makeOperations = [&](execution_context_type & context)
+            {
+                auto sender = context.get_scheduler().schedule() | then([&](){counter.fetch_add(1, std::memory_order_relaxed);});
+                std::vector<connect_result_t<decltype(sender), counting_receiver>> operations;
+                operations.reserve(operation_count);
+                for (auto i = 0; i < operation_count; ++i)
+                    operations.push_back(sender.connect(counting_receiver{&completed}));
+                return operations;
+            };
+    auto operations = makeOperations(executionContext);
+    auto overflowOperations = makeOperations(smallExecutionContext);
+
+    std::cout << fmt::format("{} workers, {} concurrent operations\n", workerCount, operation_count);
+    std::cout << fmt::format("{:<32}{:>12}{:>16}\n", "", "ns per op", "allocations");
+    report("work_contract::invoke", [&]()
+            {
+                run_rounds(completed, [&](){for (auto & workContract : workContracts) workContract.invoke();});
+            });
+    report("schedule() | then()", [&]()
+            {
+                run_rounds(completed, [&](){for (auto & operation : operations) operation.start();});
+            });
+    report("schedule() | then() (overflow)", [&]()
+            {
+                run_rounds(completed, [&](){for (auto & operation : overflowOperations) operation.start();});
+            });
+
+    threadPool.stop(synchronization_mode::blocking);
+    return 0;
+}
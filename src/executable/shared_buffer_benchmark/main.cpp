@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <library/system.h>
+#include <library/system/memory.h>
+#include <fmt/format.h>
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+
+
+namespace
+{
+
+    static auto constexpr message_count = 1000000;
+    static auto constexpr warm_up_count = 10000;
+    static auto constexpr payload_size = 256;
+
+    // heap allocations made while measuring
+    std::atomic<std::size_t> allocationCount{0};
+
+
+    //=========================================================================
+    template <typename M, typename P, typename C>
+    void measure
+    (
+        // a producer thread passes messages through a ring to a contract which consumes them
+        char const * name,
+        work_contract_group_type & workContractGroup,
+        P && produce,
+        C && consume
+    )
+    {
+        maniscalco::system::bounded_ring<M> ring({.capacity_ = 1024, .singleProducer_ = true, .singleConsumer_ = true});
+        std::atomic<std::size_t> consumed{0};
+        auto workContract = workContractGroup.create_contract([&]()
+                {
+                    std::size_t count = 0;
+                    while (auto message = ring.try_pop())
+                    {
+                        consume(*message);
+                        ++count;
+                    }
+                    consumed.fetch_add(count, std::memory_order_release);
+                });
+
+        auto run = [&](std::size_t count)
+                {
+                    auto target = consumed.load() + count;
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        auto message = produce(i);
+                        while (!ring.try_push(std::move(message)))
+                        {
+                            workContract.invoke();
+                            std::this_thread::yield();
+                        }
+                        workContract.invoke();
+                    }
+                    while (consumed.load(std::memory_order_acquire) != target)
+                        std::this_thread::yield();
+                };
+
+        run(warm_up_count);
+        auto allocationsBefore = allocationCount.load();
+        auto startTime = std::chrono::steady_clock::now();
+        run(message_count);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+        std::cout << fmt::format("{:<28}{:>12.1f}{:>16}\n", name, (double)elapsed.count() / message_count, allocationCount.load() - allocationsBefore);
+    }
+
+} // namespace
+
+
+//=============================================================================
+void * operator new
+(
+    std::size_t size
+)
+{
+    ++allocationCount;
+    if (auto address = std::malloc(std::max<std::size_t>(size, 1)); address != nullptr)
+        return address;
+    throw std::bad_alloc();
+}
+
+
+//=============================================================================
+[[gnu::noinline]] void operator delete
+(
+    void * address
+) noexcept
+{
+    std::free(address);
+}
+
+
+//=============================================================================
+[[gnu::noinline]] void operator delete
+(
+    void * address,
+    std::size_t
+) noexcept
+{
+    std::free(address);
+}
+
+
+//=============================================================================
+int main
+(
+    // passing payload_size byte messages from a thread to a contract: pooled shared_buffer
+    // handles against std::shared_ptr<std::string> and copied std::string.
+    int,
+    char const **
+)
+{
+    using namespace maniscalco::system;
+
+    work_contract_group_type workContractGroup(8);
+    thread_pool::configuration threadPoolConfiguration;
+    threadPoolConfiguration.threads_.push_back({.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested())
+                    workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+            }});
+    thread_pool threadPool(threadPoolConfiguration);
+
+    char payload[payload_size];
+    std::memset(payload, 'x', sizeof(payload));
+    std::atomic<std::size_t> checksum{0};
+
+    std::cout << fmt::format("{:<28}{:>12}{:>16}\n", "", "ns per msg", "allocations");
+
+    shared_buffer_pool sharedBufferPool({.bufferSize_ = payload_size});
+    measure<shared_buffer>("shared_buffer", workContractGroup, [&](std::size_t)
+            {
+                auto buffer = sharedBufferPool.allocate();
+                std::memcpy(buffer.data(), payload, payload_size);
+                buffer.resize(payload_size);
+                return buffer;
+            },
+            [&](shared_buffer const & buffer){checksum.fetch_add((std::size_t)buffer.data()[0], std::memory_order_relaxed);});
+
+    measure<std::shared_ptr<std::string>>("std::shared_ptr<std::string>", workContractGroup, [&](std::size_t)
+            {
+                return std::make_shared<std::string>(payload, payload_size);
+            },
+            [&](auto const & message){checksum.fetch_add((std::size_t)(*message)[0], std::memory_order_relaxed);});
+
+    measure<std::string>("std::string (copied)", workContractGroup, [&](std::size_t)
+            {
+                return std::string(payload, payload_size);
+            },
+            [&](std::string const & message){checksum.fetch_add((std::size_t)message[0], std::memory_order_relaxed);});
+
+    std::cout << fmt::format("slabs hold {} buffers\n", sharedBufferPool.get_capacity());
+    threadPool.stop(synchronization_mode::blocking);
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <library/system/diagnostics/statistics_page.h>
+#include <fmt/format.h>
+
+
+using statistics_page = maniscalco::system::statistics_page;
+
+
+namespace
+{
+
+    //=========================================================================
+    std::string format_delay
+    (
+        // upper bound of the histogram bucket containing the given percentile
+        statistics_page::worker_snapshot const & worker,
+        double percentile
+    )
+    {
+        std::uint64_t total = 0;
+        for (auto count : worker.queueingDelay_)
+            total += count;
+        if (total == 0)
+            return "-";
+        std::uint64_t sum = 0;
+        for (auto bucket = 0; bucket < statistics_page::queueing_delay_bucket_count; ++bucket)
+        {
+            sum += worker.queueingDelay_[bucket];
+            if (sum >= (total * percentile))
+            {
+                auto nanoseconds = (1ull << bucket);
+                if (nanoseconds < 1000)
+                    return fmt::format("<{}ns", nanoseconds);
+                if (nanoseconds < 1000000)
+                    return fmt::format("<{}us", nanoseconds / 1000);
+                return fmt::format("<{}ms", nanoseconds / 1000000);
+            }
+        }
+        return "-";
+    }
+
+
+    //=========================================================================
+    void print
+    (
+        statistics_page::snapshot const & snapshot,
+        std::map<std::size_t, statistics_page::worker_snapshot> const & previous,
+        double seconds
+    )
+    {
+        std::cout << fmt::format("publish count {}\n", snapshot.publishCount_);
+        std::cout << fmt::format("{:>8}{:>8}{:>16}{:>14}{:>12}{:>12}{:>12}{:>12}\n",
+                "worker", "cpu", "executions", "exec/s", "parks", "wakes", "delay p50", "delay p99");
+        for (auto const & worker : snapshot.workers_)
+        {
+            std::string rate = "-";
+            if (auto iter = previous.find(worker.index_); (iter != previous.end()) && (seconds > 0))
+                rate = fmt::format("{:.0f}", (worker.executions_ - iter->second.executions_) / seconds);
+            std::cout << fmt::format("{:>8}{:>8}{:>16}{:>14}{:>12}{:>12}{:>12}{:>12}\n", worker.index_,
+                    (worker.cpuId_ == ~0ull) ? std::string("-") : std::to_string(worker.cpuId_), worker.executions_, rate,
+                    worker.parks_, worker.wakes_, format_delay(worker, 0.5), format_delay(worker, 0.99));
+        }
+        std::cout << fmt::format("{:>8}{:>12}{:>12}\n", "group", "capacity", "active");
+        for (auto const & group : snapshot.groups_)
+            std::cout << fmt::format("{:>8}{:>12}{:>12}\n", group.groupId_, group.capacity_, group.activeContracts_);
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    // print the contents of a statistics page published by a running process.
+    // with an interval the page is re-read periodically and execution rates are shown.
+    int argc,
+    char const ** argv
+)
+{
+    if ((argc < 2) || (argc > 3))
+    {
+        std::cerr << "usage: statistics_reader <page name> [interval milliseconds]\n";
+        return 1;
+    }
+
+    std::chrono::milliseconds interval((argc == 3) ? std::stoul(argv[2]) : 0);
+    std::map<std::size_t, statistics_page::worker_snapshot> previous;
+    auto previousTime = std::chrono::steady_clock::now();
+    while (true)
+    {
+        auto snapshot = statistics_page::read(argv[1]);
+        auto now = std::chrono::steady_clock::now();
+        if (!snapshot)
+        {
+            std::cerr << "statistics page " << argv[1] << " not found or of an unsupported version\n";
+            return 1;
+        }
+        print(*snapshot, previous, std::chrono::duration<double>(now - previousTime).count());
+        if (interval.count() == 0)
+            break;
+        previous.clear();
+        for (auto const & worker : snapshot->workers_)
+            previous[worker.index_] = worker;
+        previousTime = now;
+        std::this_thread::sleep_for(interval);
+        std::cout << "\n";
+    }
+    return 0;
+}
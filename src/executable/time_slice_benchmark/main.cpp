@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <library/system.h>
+#include <fmt/format.h>
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+using work_contract_type = maniscalco::system::work_contract<work_contract_group_type::mode>;
+
+
+namespace
+{
+
+    static auto constexpr job_units = (1 << 20);        // a few milliseconds of work per job
+    static auto constexpr units_per_check = 64;         // units between calls to should_yield()
+    static auto constexpr sample_count = 2000;
+    static auto constexpr sample_interval = std::chrono::microseconds(200);
+
+
+    //=========================================================================
+    std::int64_t now
+    (
+    )
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+
+    //=========================================================================
+    void measure
+    (
+        // a single worker shares its time between a bulk contract, which works through
+        // jobs of job_units units and starts the next as soon as one completes, and a
+        // latency critical contract invoked every sample_interval.  reports the delay from
+        // invocation of the latency critical contract to its execution along with the
+        // bulk contract's throughput.
+        std::string const & name,
+        maniscalco::system::time_slice const & timeSlice
+    )
+    {
+        work_contract_group_type workContractGroup({.capacity_ = 8, .timeSlice_ = timeSlice});
+        maniscalco::system::thread_pool::configuration threadPoolConfiguration;
+        threadPoolConfiguration.threads_.assign(1, {.function_ = [&](auto const & stopToken)
+                {
+                    while (!stopToken.stop_requested())
+                        workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+                }});
+
+        std::size_t jobPosition = 0;
+        std::atomic<std::size_t> unitsCompleted{0};
+        std::uint64_t volatile sink = 0;
+        auto bulkContract = workContractGroup.create_contract([&]()
+                {
+                    std::uint64_t sum = sink;
+                    while (true)
+                    {
+                        for (auto i = 0; i < units_per_check; ++i)
+                            sum = (sum * 6364136223846793005ull) + jobPosition + i;
+                        unitsCompleted.fetch_add(units_per_check, std::memory_order_relaxed);
+                        if ((jobPosition += units_per_check) == job_units)
+                        {
+                            // job complete.  start the next one on the next execution.
+                            jobPosition = 0;
+                            break;
+                        }
+                        if (maniscalco::system::this_contract::should_yield())
+                            break;
+                    }
+                    sink = sum;
+                    maniscalco::system::this_contract::yield();
+                });
+
+        std::atomic<std::int64_t> invokeTime{0};
+        std::atomic<std::size_t> executionCount{0};
+        std::vector<std::int64_t> latencies;
+        latencies.reserve(sample_count);
+        auto latencyContract = workContractGroup.create_contract([&]()
+                {
+                    latencies.push_back(now() - invokeTime.load(std::memory_order_acquire));
+                    executionCount.fetch_add(1, std::memory_order_release);
+                });
+
+        bulkContract.invoke();
+        maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+        auto startTime = std::chrono::steady_clock::now();
+        for (std::size_t sample = 0; sample < sample_count; ++sample)
+        {
+            std::this_thread::sleep_for(sample_interval);
+            invokeTime.store(now(), std::memory_order_release);
+            latencyContract.invoke();
+            while (executionCount.load(std::memory_order_acquire) == sample)
+                std::this_thread::yield();
+        }
+        auto elapsedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p){return latencies[std::min<std::size_t>(latencies.size() * p, latencies.size() - 1)] / 1000.0;};
+        std::cout << fmt::format("{:<24}{:>12.1f}{:>12.1f}{:>12.1f}{:>16.1f}\n", name, percentile(0.5), percentile(0.99), 
+                latencies.back() / 1000.0, unitsCompleted / elapsedTime / 1e6);
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    int, 
+    char const **
+)
+{
+    using namespace maniscalco::system;
+    
+    std::cout << fmt::format("{:<24}{:>12}{:>12}{:>12}{:>16}\n", "time slice", "p50 us", "p99 us", "max us", "bulk Munits/s");
+    measure("none (whole job)", {});
+    measure("1 ms", {.duration_ = std::chrono::milliseconds(1)});
+    measure("100 us", {.duration_ = std::chrono::microseconds(100)});
+    measure("20 us", {.duration_ = std::chrono::microseconds(20)});
+    measure("256 iterations", {.iterations_ = 256});
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <library/system/diagnostics/tracer.h>
+#include <fmt/format.h>
+
+
+using tracer = maniscalco::system::tracer;
+
+
+namespace
+{
+
+    //=========================================================================
+    std::vector<tracer::record> load
+    (
+        char const * path
+    )
+    {
+        std::ifstream stream(path, std::ios::binary);
+        tracer::file_header header;
+        if ((!stream.read(reinterpret_cast<char *>(&header), sizeof(header))) || (header.magic_ != tracer::file_header::magic))
+            throw std::runtime_error(fmt::format("{} is not a trace file", path));
+        if ((header.version_ != tracer::file_header::current_version) || (header.recordSize_ != sizeof(tracer::record)))
+            throw std::runtime_error(fmt::format("{}: unsupported trace version {}", path, header.version_));
+        std::vector<tracer::record> records(header.recordCount_);
+        stream.read(reinterpret_cast<char *>(records.data()), records.size() * sizeof(tracer::record));
+        records.resize(stream.gcount() / sizeof(tracer::record));
+        return records;
+    }
+
+
+    //=========================================================================
+    char const * get_name
+    (
+        tracer::event event
+    )
+    {
+        switch (event)
+        {
+            case tracer::event::contract_invoke: return "invoke";
+            case tracer::event::contract_execute_begin: return "execute";
+            case tracer::event::contract_execute_end: return "execute";
+            case tracer::event::contract_surrender: return "surrender";
+            case tracer::event::worker_park: return "parked";
+            case tracer::event::worker_unpark: return "parked";
+            case tracer::event::thread_start: return "thread start";
+            case tracer::event::thread_stop: return "thread stop";
+        }
+        return "unknown";
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    // convert a binary trace written by tracer::write into chrome trace json.
+    // execution and parked intervals become complete events on the timeline of the 
+    // cpu on which they began so that perfetto shows one track per core.
+    int argc, 
+    char const ** argv
+)
+{    
+    if (argc != 3)
+    {
+        std::cerr << "usage: trace_converter <trace file> <json file>\n";
+        return 1;
+    }
+
+    try
+    {
+        auto records = load(argv[1]);
+        std::ofstream output(argv[2], std::ios::trunc);
+        if (!output)
+            throw std::runtime_error(fmt::format("failed to open {}", argv[2]));
+
+        auto origin = records.empty() ? 0 : records.front().timestamp_;
+        auto to_microseconds = [&](std::uint64_t timestamp){return ((double)(timestamp - origin) / 1000.0);};
+
+        std::vector<std::string> events;
+        std::map<std::uint32_t, bool> cpus;
+        // open interval per recording thread (execution or parked)
+        std::map<std::uint32_t, tracer::record> open;
+
+        for (auto const & record : records)
+        {
+            cpus[record.cpuId_] = true;
+            switch (record.event_)
+            {
+                case tracer::event::contract_execute_begin:
+                case tracer::event::worker_park:
+                {
+                    open[record.threadIndex_] = record;
+                    break;
+                }
+                case tracer::event::contract_execute_end:
+                case tracer::event::worker_unpark:
+                {
+                    if (auto iter = open.find(record.threadIndex_); iter != open.end())
+                    {
+                        auto const & begin = iter->second;
+                        events.push_back(fmt::format(R"({{"name":"{}","cat":"group {}","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":0,"tid":{},"args":{{"group":{},"contract":{},"thread":{}}}}})",
+                                (begin.event_ == tracer::event::worker_park) ? std::string("parked") : fmt::format("contract {}", begin.contractId_),
+                                begin.groupId_, to_microseconds(begin.timestamp_), to_microseconds(record.timestamp_) - to_microseconds(begin.timestamp_),
+                                begin.cpuId_, begin.groupId_, begin.contractId_, begin.threadIndex_));
+                        open.erase(iter);
+                    }
+                    break;
+                }
+                default:
+                {
+                    events.push_back(fmt::format(R"({{"name":"{}","cat":"group {}","ph":"i","s":"t","ts":{:.3f},"pid":0,"tid":{},"args":{{"group":{},"contract":{},"thread":{}}}}})",
+                            get_name(record.event_), record.groupId_, to_microseconds(record.timestamp_), record.cpuId_, 
+                            record.groupId_, record.contractId_, record.threadIndex_));
+                    break;
+                }
+            }
+        }
+
+        output << "{\"traceEvents\":[\n";
+        output << R"({"name":"process_name","ph":"M","pid":0,"args":{"name":"work contracts"}})";
+        for (auto const & [cpu, _] : cpus)
+            output << ",\n" << fmt::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"cpu {}"}}}})", cpu, cpu);
+        for (auto const & event : events)
+            output << ",\n" << event;
+        output << "\n]}\n";
+        std::cout << "converted " << records.size() << " records\n";
+    }
+    catch (std::exception const & exception)
+    {
+        std::cerr << exception.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <cstddef>
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <random>
+#include <string>
+
+#include <library/system.h>
+#include <library/system/diagnostics.h>
+#include <fmt/format.h>
+
+
+using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
+using work_contract_type = maniscalco::system::work_contract<work_contract_group_type::mode>;
+using performance_counter = maniscalco::system::performance_counter;
+
+
+namespace
+{
+
+    //=========================================================================
+    char const * to_string
+    (
+        maniscalco::system::page_type pageType
+    )
+    {
+        switch (pageType)
+        {
+            case maniscalco::system::page_type::normal: return "normal";
+            case maniscalco::system::page_type::transparent_huge: return "transparent_huge";
+            case maniscalco::system::page_type::huge: return "huge";
+        }
+        return "unknown";
+    }
+
+} // namespace
+
+
+//=============================================================================
+void measure
+(
+    // same random walk as work_contract_demo: each contract invokes another random 
+    // contract upon completion, keeping a fixed number of contracts invoked at all 
+    // times.  reports throughput and hardware counters per executed contract.
+    std::string const & name,
+    work_contract_group_type::configuration const & groupConfiguration,
+    std::vector<performance_counter::event> const & events
+)
+{
+    static auto constexpr test_duration = std::chrono::milliseconds(1000);
+    static auto constexpr max_concurrent_contracts = 256;
+    auto const max_contracts = groupConfiguration.capacity_;
+
+    std::vector<std::uint32_t> next(max_contracts);
+    std::mt19937_64 random;
+    for (auto i = 0; i < max_contracts; ++i)
+        next[i] = random() % max_contracts;
+
+    work_contract_group_type workContractGroup(groupConfiguration);
+    std::atomic<std::size_t> totalTaskCount;
+    thread_local std::size_t taskCount;
+    std::vector<work_contract_type> workContracts(max_contracts);
+    for (auto i = 0; i < max_contracts; ++i)
+        workContracts[i] = workContractGroup.create_contract([&, index = i]() mutable{++taskCount; workContracts[index = next[index]].invoke();});
+    for (auto i = 0; i < max_concurrent_contracts; ++i)
+        workContracts[i].invoke();
+
+    // counters are opened before the workers are created so that worker threads are included
+    std::vector<performance_counter> counters;
+    for (auto event : events)
+        counters.emplace_back(event, performance_counter::include_child_threads);
+
+    maniscalco::system::thread_pool::thread_configuration worker;
+    worker.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested()) 
+                    workContractGroup.execute_next_contract(); 
+                totalTaskCount += taskCount;
+                taskCount = 0;
+            };
+    auto threadPoolConfiguration = maniscalco::system::thread_pool::configuration::from_placement(
+            {.policy_ = maniscalco::system::placement_policy::one_per_physical_core}, worker);
+
+    for (auto & counter : counters)
+        counter.start();
+    auto startTime = std::chrono::steady_clock::now();
+    {
+        maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+        std::this_thread::sleep_for(test_duration);
+        threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+    }
+    auto elapsedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    for (auto & counter : counters)
+        counter.stop();
+
+    std::cout << fmt::format("{:<24} pages = {:<16} workers = {:<3} tasks per sec = {:>12}", name, to_string(workContractGroup.get_page_type()), 
+            threadPoolConfiguration.threads_.size(), (std::size_t)(totalTaskCount / elapsedTime));
+    for (auto && [index, counter] : ranges::v3::views::enumerate(counters))
+    {
+        if (auto value = counter.get_value(); value.has_value())
+            std::cout << fmt::format(", {} per task = {:.3f}", performance_counter::get_name(events[index]), (double)*value / std::max<std::size_t>(totalTaskCount, 1));
+        else
+            std::cout << fmt::format(", {} = n/a", performance_counter::get_name(events[index]));
+    }
+    std::cout << std::endl;
+}
+
+
+//=============================================================================
+int main
+(
+    int, 
+    char const **
+)
+{    
+    using namespace maniscalco::system;
+    static auto constexpr max_contracts = (1 << 20);
+    static auto constexpr num_loops = 3;
+
+    for (auto i = 0; i < num_loops; ++i)
+    {
+        measure("normal pages", {.capacity_ = max_contracts, .pageType_ = page_type::normal}, {performance_counter::event::dtlb_load_misses});
+        measure("transparent huge pages", {.capacity_ = max_contracts, .pageType_ = page_type::transparent_huge}, {performance_counter::event::dtlb_load_misses});
+        measure("huge pages", {.capacity_ = max_contracts, .pageType_ = page_type::huge}, {performance_counter::event::dtlb_load_misses});
+    }
+    return 0;
+}
@@ -5,6 +5,8 @@
 #include <condition_variable>
 #include <mutex>
 #include <cstdint>
+#include <functional>
+#include <string>
 #include <library/system.h>
 #include <atomic>
 #include <vector>
@@ -12,6 +14,11 @@
 
 #include <library/system.h>
 
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 using work_contract_group_type = maniscalco::system::waitable_work_contract_group;
 using work_contract_type = maniscalco::system::work_contract<work_contract_group_type::mode>;
 
@@ -93,6 +100,233 @@ void basic_example
 }
 
 
+//=============================================================================
+void multiple_group_example
+(
+    // service two work contract groups from a single pool of workers.
+    // while both groups are busy the high priority group gets three
+    // executions for every one execution of the low priority group.
+    // workers park only once both groups are empty.
+)
+{
+    static auto constexpr max_number_of_contracts = 32;
+    work_contract_group_type highPriorityGroup(max_number_of_contracts);
+    work_contract_group_type lowPriorityGroup(max_number_of_contracts);
+
+    maniscalco::system::work_contract_executor executor;
+    executor.add_group(highPriorityGroup, 3);
+    executor.add_group(lowPriorityGroup, 1);
+
+    static auto constexpr num_executions = 3000;
+    std::atomic<std::size_t> highPriorityCount{0};
+    std::atomic<std::size_t> lowPriorityCount{0};
+    std::atomic<std::size_t> lowPriorityCountAtHighPriorityCompletion{0};
+    work_contract_type highPriorityContract;
+    work_contract_type lowPriorityContract;
+    highPriorityContract = highPriorityGroup.create_contract([&]()
+            {
+                if (++highPriorityCount < num_executions) 
+                    highPriorityContract.invoke();
+                else
+                    lowPriorityCountAtHighPriorityCompletion = lowPriorityCount.load();
+            });
+    lowPriorityContract = lowPriorityGroup.create_contract([&](){if (++lowPriorityCount < num_executions) lowPriorityContract.invoke();});
+
+    maniscalco::system::thread_pool::thread_configuration worker;
+    worker.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested()) 
+                    executor.execute_next_contract();
+            };
+    maniscalco::system::thread_pool threadPool({.threads_ = {worker}});
+
+    highPriorityContract.invoke();
+    lowPriorityContract.invoke();
+    while ((highPriorityCount < num_executions) || (lowPriorityCount < num_executions))
+        ;
+    std::cout << "high priority executions = " << num_executions << ", low priority executions at the same time = " << 
+            lowPriorityCountAtHighPriorityCompletion << "\n";
+    executor.stop();
+    threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+}
+
+
+//=============================================================================
+void nested_group_example
+(
+    // two tenants, each with its own child work contract group, share one parent 
+    // group and its workers.  each time a tenant's group is scheduled it executes 
+    // at most a batch of its own contracts so neither tenant can starve the other.
+)
+{
+    using nested_work_contract_group_type = maniscalco::system::nested_work_contract_group<work_contract_group_type::mode>;
+
+    static auto constexpr max_number_of_contracts = 32;
+    static auto constexpr batch_size = 4;
+    static auto constexpr num_executions = 1000;
+    work_contract_group_type parentGroup(max_number_of_contracts);
+    // the tenants are destroyed while the parent group still has its worker
+    std::jthread workerThread([&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested()) 
+                    parentGroup.execute_next_contract(std::chrono::milliseconds(10));
+            });
+    nested_work_contract_group_type tenantA(parentGroup, max_number_of_contracts, batch_size);
+    nested_work_contract_group_type tenantB(parentGroup, max_number_of_contracts, batch_size);
+
+    std::atomic<std::size_t> countA{0};
+    std::atomic<std::size_t> countB{0};
+    work_contract_type contractA;
+    work_contract_type contractB;
+    contractA = tenantA.create_contract([&](){if (++countA < num_executions) contractA.invoke();});
+    contractB = tenantB.create_contract([&](){if (++countB < num_executions) contractB.invoke();});
+
+    contractA.invoke();
+    contractB.invoke();
+    while ((countA < num_executions) || (countB < num_executions))
+        ;
+    std::cout << "tenant A executions = " << countA << ", tenant B executions = " << countB << "\n";
+}
+
+
+//=============================================================================
+void shared_group_example
+(
+    // a child process invokes a contract owned by this process by id.  the contract's 
+    // execution is visible to the child through a shared counter so each invoke is a 
+    // complete cross process round trip.
+)
+{
+    static auto constexpr num_round_trips = 10000;
+    maniscalco::system::shared_work_contract_group sharedGroup({.name_ = "work_contract_demo", .capacity_ = 8});
+    auto executions = new (::mmap(nullptr, sizeof(std::atomic<std::size_t>), PROT_READ | PROT_WRITE, 
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0)) std::atomic<std::size_t>{0};
+    auto contractId = sharedGroup.create_contract([&](){++*executions;});
+
+    std::jthread workerThread([&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested()) 
+                    sharedGroup.execute_next_contract(std::chrono::milliseconds(10));
+            });
+
+    std::cout.flush();
+    if (auto pid = ::fork(); pid == 0)
+    {
+        maniscalco::system::shared_work_contract_group::client client("work_contract_demo");
+        auto startTime = std::chrono::steady_clock::now();
+        for (std::size_t i = 1; i <= num_round_trips; ++i)
+        {
+            client.invoke(contractId);
+            while (executions->load() < i)
+                std::this_thread::yield();
+        }
+        auto elapsedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+        std::cout << "cross process round trips = " << num_round_trips << ", ns per round trip = " << 
+                (elapsedTime.count() / num_round_trips) << std::endl;
+        ::_exit(0);
+    }
+    else
+    {
+        ::waitpid(pid, nullptr, 0);
+    }
+    workerThread.request_stop();
+    sharedGroup.stop();
+    ::munmap(executions, sizeof(std::atomic<std::size_t>));
+}
+
+
+//=============================================================================
+void pollable_group_example
+(
+    // service a work contract group from an epoll event loop rather than a dedicated 
+    // worker.  the group's descriptor is only signalled when the group goes from 
+    // empty to non-empty so many invokes cost a single wake up of the loop.
+)
+{
+    static auto constexpr num_contracts = 16;
+    static auto constexpr num_rounds = 100;
+    static auto constexpr batch_size = 8;
+    maniscalco::system::pollable_work_contract_group<> pollableGroup(num_contracts);
+
+    std::atomic<std::size_t> executions{0};
+    std::vector<maniscalco::system::work_contract<maniscalco::system::work_contract_mode::non_waitable>> contracts;
+    for (auto i = 0; i < num_contracts; ++i)
+        contracts.push_back(pollableGroup.create_contract([&](){++executions;}));
+
+    maniscalco::system::file_descriptor epollFileDescriptor(::epoll_create1(EPOLL_CLOEXEC));
+    epoll_event event{.events = EPOLLIN, .data = {.fd = pollableGroup.get_file_descriptor().get()}};
+    ::epoll_ctl(epollFileDescriptor.get(), EPOLL_CTL_ADD, pollableGroup.get_file_descriptor().get(), &event);
+
+    std::size_t wakeUps = 0;
+    for (auto round = 0; round < num_rounds; ++round)
+    {
+        for (auto & contract : contracts)
+            contract.invoke();
+        // the event loop: one readiness per activation, drained in batches
+        while (pollableGroup.get_active_contract_count() > 0)
+        {
+            if (::epoll_wait(epollFileDescriptor.get(), &event, 1, 1000) == 1)
+            {
+                ++wakeUps;
+                pollableGroup.drain(batch_size);
+            }
+        }
+    }
+    std::cout << "pollable group executions = " << executions << ", event loop wake ups = " << wakeUps << "\n";
+}
+
+
+//=============================================================================
+void fork_join_example
+(
+    // a contract computes fibonacci by recursive fork/join on a work stealing executor
+    // which shares its workers with the contract's group.  the contract's worker joins
+    // by executing tasks (help first) while idle workers steal the rest.
+)
+{
+    static auto constexpr num_worker_threads = 4;
+    maniscalco::system::work_stealing_executor workStealingExecutor(num_worker_threads);
+    work_contract_group_type workContractGroup(8);
+    workContractGroup.set_activation_handler([&](){workStealingExecutor.wake();});
+
+    std::function<std::uint64_t(std::uint64_t)> fibonacci = [&](auto n) -> std::uint64_t
+            {
+                if (n < 16)
+                    return (n < 2) ? n : (fibonacci(n - 1) + fibonacci(n - 2));
+                std::uint64_t a;
+                maniscalco::system::task_group taskGroup(workStealingExecutor);
+                taskGroup.spawn([&, n](){a = fibonacci(n - 1);});
+                auto b = fibonacci(n - 2);
+                taskGroup.wait();
+                return (a + b);
+            };
+
+    std::atomic<std::uint64_t> result{0};
+    auto workContract = workContractGroup.create_contract([&](){result = fibonacci(32);});
+
+    maniscalco::system::thread_pool::thread_configuration worker;
+    worker.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested())
+                    if ((!workStealingExecutor.try_execute_next_task()) && (!workContractGroup.try_execute_next_contract()))
+                        workStealingExecutor.park([&](){return (workContractGroup.get_active_contract_count() > 0);});
+            };
+    maniscalco::system::thread_pool::configuration threadPoolConfiguration;
+    threadPoolConfiguration.threads_.assign(num_worker_threads, worker);
+    maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+
+    workContract.invoke();
+    while (result == 0)
+        std::this_thread::yield();
+    auto statistics = workStealingExecutor.get_statistics();
+    std::cout << "fibonacci(32) = " << result << ", tasks executed = " << statistics.executed_ << 
+            ", tasks stolen = " << statistics.stolen_ << "\n";
+    threadPool.stop();
+    workStealingExecutor.stop();
+    threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+}
+
+
 //=============================================================================
 void measure_multithreaded_concurrent_contracts
 (
@@ -100,7 +334,6 @@ void measure_multithreaded_concurrent_contracts
     // there are always some preconfigured number of contracts invoked.
 )
 {
-    static auto const num_worker_threads = std::thread::hardware_concurrency() / 2;
     static auto constexpr test_duration = std::chrono::milliseconds(1000);
     static auto constexpr max_contracts = (1 << 20);
     static auto constexpr max_concurrent_contracts = 256;
@@ -133,22 +366,22 @@ void measure_multithreaded_concurrent_contracts
         workContracts[i].invoke();
 
     // create a worker thread pool and direct the threads to service the work contract group - also very simple
-    std::vector<maniscalco::system::thread_pool::thread_configuration> threads(num_worker_threads);
-    for (auto && [index, thread] : ranges::v3::views::enumerate(threads))
-    {
-        thread.cpuId_ = index;
-        thread.function_ = [&]
-                (
-                    auto const & stopToken
-                ) mutable
-                {
-                    while (!stopToken.stop_requested()) 
-                        workContractGroup.execute_next_contract(); 
-                    totalTaskCount += taskCount;
-                    taskCount = 0;
-                };
-    }
-    maniscalco::system::thread_pool threadPool({.threads_ = threads});
+    // one worker per physical core so that workers never share a core with an smt sibling
+    maniscalco::system::thread_pool::thread_configuration worker;
+    worker.function_ = [&]
+            (
+                auto const & stopToken
+            ) mutable
+            {
+                while (!stopToken.stop_requested()) 
+                    workContractGroup.execute_next_contract(); 
+                totalTaskCount += taskCount;
+                taskCount = 0;
+            };
+    auto threadPoolConfiguration = maniscalco::system::thread_pool::configuration::from_placement(
+            {.policy_ = maniscalco::system::placement_policy::one_per_physical_core}, worker);
+    auto const num_worker_threads = threadPoolConfiguration.threads_.size();
+    maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
 
     auto startTime = std::chrono::system_clock::now();
     std::this_thread::sleep_for(test_duration);
@@ -162,6 +395,233 @@ void measure_multithreaded_concurrent_contracts
 }
 
 
+//=============================================================================
+void reactive_graph_example
+(
+    // a diamond of derived values.  a burst of price updates coalesces into far fewer
+    // recomputations and the total never sees a mix of old and new inputs.
+)
+{
+    work_contract_group_type workContractGroup(8);
+    maniscalco::system::thread_pool::configuration threadPoolConfiguration;
+    threadPoolConfiguration.threads_.assign(2, {.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested())
+                    workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+            }});
+    maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+
+    std::atomic<std::size_t> recomputations{0};
+    maniscalco::system::reactive_graph reactiveGraph(workContractGroup);
+    auto price = reactiveGraph.add_input(100.0);
+    auto quantity = reactiveGraph.add_input(10);
+    auto notional = reactiveGraph.add_node([](double p, int q){return p * q;}, price, quantity);
+    auto fee = reactiveGraph.add_node([](double p){return p * 0.01;}, price);
+    auto total = reactiveGraph.add_node([&](double n, double f){++recomputations; return n + f;}, notional, fee);
+
+    static auto constexpr num_updates = 10000;
+    for (auto i = 1; i <= num_updates; ++i)
+        price.set(100.0 + i);
+    while (!reactiveGraph.is_stable())
+        std::this_thread::yield();
+    std::cout << "reactive graph: " << num_updates << " price updates, " << recomputations << 
+            " recomputations of total = " << total.get() << "\n";
+    threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+}
+
+
+//=============================================================================
+void pipeline_example
+(
+    // parse -> normalize -> enrich -> publish with a deliberately slow enrich stage.
+    // the per stage statistics show enrich's ring full and the stages before it blocked.
+)
+{
+    work_contract_group_type workContractGroup(16);
+    maniscalco::system::thread_pool::configuration threadPoolConfiguration;
+    threadPoolConfiguration.threads_.assign(2, {.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested())
+                    workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+            }});
+    maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+
+    std::atomic<std::size_t> published{0};
+    auto pipeline = maniscalco::system::make_pipeline<std::string>(workContractGroup)
+            .add_stage("parse", [](std::string && text){return std::stoull(text);}, {.parallelism_ = 2, .ordered_ = true})
+            .add_stage("normalize", [](std::uint64_t && value){return (value % 1000);})
+            .add_stage("enrich", [](std::uint64_t && value)
+                    {
+                        auto volatile sum = value;
+                        for (auto i = 0; i < 20000; ++i)
+                            sum = sum + i;
+                        return std::uint64_t(sum);
+                    }, {.capacity_ = 256})
+            .add_stage("publish", [&](std::uint64_t &&){++published;})
+            .build();
+
+    static auto constexpr num_messages = 20000;
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<maniscalco::system::pipeline_stage_statistics> statistics;
+    std::chrono::microseconds elapsed;
+    for (auto i = 0; i < num_messages; )
+    {
+        if (!pipeline.try_push(std::to_string(i)))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (++i == (num_messages / 2))
+        {
+            // sample mid stream
+            statistics = pipeline.get_statistics();
+            elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+        }
+    }
+    while (published != num_messages)
+        std::this_thread::yield();
+    std::cout << "pipeline: after " << elapsed.count() << " us\n";
+    for (auto const & stage : statistics)
+        std::cout << "    " << stage.name_ << ": " << (stage.processed_ * 1000000 / std::max<std::int64_t>(elapsed.count(), 1)) << 
+                " items/sec, occupancy " << stage.queued_ << "/" << stage.capacity_ << ", blocked " << stage.blocked_ << "\n";
+    threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+}
+
+
+//=============================================================================
+void rcu_example
+(
+    // contracts price orders against a fee schedule read through an rcu_pointer while the
+    // main thread publishes new schedules.  old schedules are destroyed once every worker
+    // has returned from the contract which might still be reading them.
+)
+{
+    struct fee_schedule
+    {
+        std::uint64_t   version_;
+        double          rate_;
+    };
+
+    work_contract_group_type workContractGroup(8);
+    maniscalco::system::thread_pool::configuration threadPoolConfiguration;
+    threadPoolConfiguration.threads_.assign(2, {.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested())
+                    workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+            }});
+    maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+
+    maniscalco::system::rcu_pointer<fee_schedule> feeSchedule(std::make_unique<fee_schedule const>(0, 0.001));
+    std::atomic<std::size_t> ordersPriced{0};
+    std::atomic<std::uint64_t> latestVersionSeen{0};
+    // prices are stored here so that they can not be optimized away
+    std::atomic<double> feeSink{0.0};
+    std::vector<work_contract_type> workContracts(4);
+    for (auto & workContract : workContracts)
+        workContract = workContractGroup.create_contract([&, &self = workContract]()
+                {
+                    auto schedule = feeSchedule.get();
+                    feeSink.store(schedule->rate_ * 1000.0, std::memory_order_relaxed);
+                    latestVersionSeen = std::max(latestVersionSeen.load(), schedule->version_);
+                    ++ordersPriced;
+                    self.invoke();
+                });
+    for (auto & workContract : workContracts)
+        workContract.invoke();
+
+    static auto constexpr num_updates = 1000;
+    for (std::uint64_t version = 1; version <= num_updates; ++version)
+    {
+        feeSchedule.update(std::make_unique<fee_schedule const>(version, 0.001 * (version % 10 + 1)));
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+    auto pendingBeforeSynchronize = maniscalco::system::qsbr::get_pending_count();
+    maniscalco::system::qsbr::synchronize();
+    std::cout << "rcu: " << num_updates << " fee schedule updates, " << ordersPriced << " orders priced, latest version seen = " << 
+            latestVersionSeen << ", retired schedules pending = " << pendingBeforeSynchronize << " then " << 
+            maniscalco::system::qsbr::get_pending_count() << " after synchronize\n";
+    threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+}
+
+
+//=============================================================================
+void stall_watchdog_example
+(
+    // one contract blocks (a sleep standing in for a stray syscall or lock) while the others
+    // keep running.  the watchdog reports the stalled contract along with its stack.
+)
+{
+    maniscalco::system::stall_watchdog stallWatchdog({.threshold_ = std::chrono::milliseconds(50), .captureStack_ = true, 
+            .stallHandler_ = [](auto const & stall)
+            {
+                std::cout << "stall watchdog: contract " << stall.contractId_ << " of group " << stall.groupId_ << " on worker " << 
+                        stall.workerIndex_ << " (cpu " << (std::int64_t)stall.cpuId_ << ") executing for at least " << 
+                        std::chrono::duration_cast<std::chrono::milliseconds>(stall.duration_).count() << " ms\n";
+                for (auto const & frame : stall.stack_)
+                    std::cout << "    " << frame << "\n";
+            }});
+
+    work_contract_group_type workContractGroup(8);
+    maniscalco::system::thread_pool::configuration threadPoolConfiguration{.stallWatchdog_ = &stallWatchdog};
+    threadPoolConfiguration.threads_.assign(2, {.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested())
+                    workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+            }});
+    maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+
+    std::atomic<bool> done{false};
+    auto blockingContract = workContractGroup.create_contract([&](){std::this_thread::sleep_for(std::chrono::milliseconds(200)); done = true;});
+    blockingContract.invoke();
+    while (!done)
+        std::this_thread::yield();
+    std::cout << "stall watchdog: " << stallWatchdog.get_stall_count() << " stalls reported\n";
+    threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+}
+
+
+//=============================================================================
+void elastic_thread_pool_example
+(
+    // a pool of between one and four workers which grows during a burst of work and
+    // shrinks back once the group has been idle for a while.
+)
+{
+    work_contract_group_type workContractGroup(64);
+    maniscalco::system::thread_pool::configuration threadPoolConfiguration{.elastic_ = maniscalco::system::thread_pool::elastic_configuration{
+            .minWorkers_ = 1, .loadProbe_ = [&](){return workContractGroup.get_active_contract_count();}, .scaleUpLoad_ = 4, 
+            .scaleUpDelay_ = std::chrono::milliseconds(20), .scaleDownDelay_ = std::chrono::milliseconds(200)}};
+    threadPoolConfiguration.threads_.assign(4, {.function_ = [&](auto const & stopToken)
+            {
+                while (!stopToken.stop_requested())
+                    workContractGroup.execute_next_contract(std::chrono::milliseconds(10));
+            }});
+    maniscalco::system::thread_pool threadPool(threadPoolConfiguration);
+
+    std::atomic<bool> burst{true};
+    std::vector<work_contract_type> workContracts(32);
+    for (auto & workContract : workContracts)
+        workContract = workContractGroup.create_contract([&, &self = workContract]()
+                {
+                    auto volatile sum = 0;
+                    for (auto i = 0; i < 20000; ++i)
+                        sum = sum + i;
+                    if (burst)
+                        self.invoke();
+                });
+
+    std::cout << "elastic thread_pool: idle workers = " << threadPool.get_worker_count();
+    for (auto & workContract : workContracts)
+        workContract.invoke();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    std::cout << ", during burst workers = " << threadPool.get_worker_count();
+    burst = false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    std::cout << ", after burst workers = " << threadPool.get_worker_count() << "\n";
+    threadPool.stop(maniscalco::system::synchronization_mode::blocking);
+}
+
+
 //=============================================================================
 int main
 (
@@ -199,6 +659,16 @@ int main
     bare_minimum_example();
     basic_example();
     work_contract_after_group_destroyed_test();
+    multiple_group_example();
+    nested_group_example();
+    shared_group_example();
+    pollable_group_example();
+    fork_join_example();
+    reactive_graph_example();
+    pipeline_example();
+    rcu_example();
+    stall_watchdog_example();
+    elastic_thread_pool_example();
 
     static auto constexpr num_loops = 10;
     for (auto i = 0; i < num_loops; ++i)
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <library/system/work_contract/work_contract_group.h>
+#include <library/system/work_contract/work_contract.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+
+namespace maniscalco::system
+{
+
+    // an actor owns one work contract and a lock free multiple producer, single consumer
+    // mailbox.  send() (from any thread) enqueues the message and invokes the contract, so
+    // messages are handled one at a time, in the order in which they were enqueued, and a
+    // burst of sends results in a single execution which drains them together.  each
+    // execution handles at most messageBudget messages before invoking the contract again
+    // and yielding the worker to other actors.
+    //
+    //      actor<message> session(workContractGroup, [](message && m){...});
+    //      session.send(message{...});
+    //
+    // the actor must not be destroyed while its contract is executing.  messages still in
+    // the mailbox are discarded on destruction.
+    template <typename M, work_contract_mode T = work_contract_mode::waitable>
+    class actor
+    {
+    public:
+
+        using message_type = M;
+        using work_contract_group_type = work_contract_group<T>;
+        using handler_type = std::function<void(M &&)>;
+
+        static auto constexpr default_message_budget = 64;
+
+        actor
+        (
+            work_contract_group_type &,
+            handler_type,
+            std::size_t = default_message_budget
+        );
+
+        ~actor();
+
+        actor(actor const &) = delete;
+        actor & operator = (actor const &) = delete;
+
+        template <typename ... A>
+        void send
+        (
+            A && ...
+        );
+
+        // messages handled so far.  approximate while the actor is running.
+        std::size_t get_handled_count() const;
+
+    private:
+
+        struct node
+        {
+            std::atomic<node *> next_{nullptr};
+        };
+
+        struct message_node :
+            node
+        {
+            template <typename ... A>
+            message_node(A && ... args):value_(std::forward<A>(args) ...){}
+
+            M   value_;
+        };
+
+        // per thread cache of message nodes.  nodes are released by the consuming worker
+        // and reused by whichever thread sends from it next.
+        class node_cache
+        {
+        public:
+
+            ~node_cache()
+            {
+                while (head_ != nullptr)
+                    ::operator delete(std::exchange(head_, head_->next_.load(std::memory_order_relaxed)));
+            }
+
+            void * allocate()
+            {
+                if (head_ == nullptr)
+                    return ::operator new(sizeof(message_node));
+                --size_;
+                return std::exchange(head_, head_->next_.load(std::memory_order_relaxed));
+            }
+
+            void release
+            (
+                node * released
+            )
+            {
+                if (size_ >= capacity)
+                    return ::operator delete(released);
+                released->next_.store(head_, std::memory_order_relaxed);
+                head_ = released;
+                ++size_;
+            }
+
+        private:
+
+            static auto constexpr capacity = 4096;
+
+            node *      head_{nullptr};
+            std::size_t size_{0};
+        };
+
+        static node_cache & get_node_cache();
+
+        void execute();
+
+        node * pop();
+
+        handler_type                handler_;
+
+        std::size_t                 messageBudget_;
+
+        std::atomic<std::size_t>    handledCount_{0};
+
+        node *                      head_;      // consumer only.  a node whose message has been consumed.
+
+        node                        stub_;
+
+        std::atomic<node *>         tail_;      // not padded: actors are meant to be numerous and small
+
+        work_contract<T>            contract_;
+
+    }; // class actor
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <typename M, maniscalco::system::work_contract_mode T>
+inline maniscalco::system::actor<M, T>::actor
+(
+    work_contract_group_type & workContractGroup,
+    handler_type handler,
+    std::size_t messageBudget
+):
+    handler_(std::move(handler)),
+    messageBudget_(std::max<std::size_t>(messageBudget, 1)),
+    head_(&stub_),
+    tail_(&stub_),
+    contract_(workContractGroup.create_contract([this](){execute();}))
+{
+    if (!contract_.is_valid())
+        throw std::runtime_error("actor: work_contract_group has no free contracts");
+}
+
+
+//=============================================================================
+template <typename M, maniscalco::system::work_contract_mode T>
+inline maniscalco::system::actor<M, T>::~actor
+(
+)
+{
+    contract_.surrender();
+    while (auto current = pop())
+        std::destroy_at(&static_cast<message_node *>(current)->value_);
+    if (head_ != &stub_)
+        get_node_cache().release(head_);
+}
+
+
+//=============================================================================
+template <typename M, maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::actor<M, T>::get_node_cache
+(
+) -> node_cache &
+{
+    thread_local node_cache nodeCache;
+    return nodeCache;
+}
+
+
+//=============================================================================
+template <typename M, maniscalco::system::work_contract_mode T>
+template <typename ... A>
+inline void maniscalco::system::actor<M, T>::send
+(
+    A && ... args
+)
+{
+    auto newNode = new (get_node_cache().allocate()) message_node(std::forward<A>(args) ...);
+    // vyukov mpsc: link after the exchange.  until then the consumer sees the mailbox as
+    // empty and the invoke below causes it to execute again.
+    auto previous = tail_.exchange(newNode, std::memory_order_acq_rel);
+    previous->next_.store(newNode, std::memory_order_release);
+    contract_.invoke();
+}
+
+
+//=============================================================================
+template <typename M, maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::actor<M, T>::pop
+(
+) -> node *
+{
+    // the message of the returned node is destroyed by the caller.  the node itself
+    // becomes the new head and is released by the following pop.
+    auto next = head_->next_.load(std::memory_order_acquire);
+    if (next == nullptr)
+        return nullptr;
+    auto previous = std::exchange(head_, next);
+    if (previous != &stub_)
+        get_node_cache().release(previous);
+    return next;
+}
+
+
+//=============================================================================
+template <typename M, maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::actor<M, T>::execute
+(
+)
+{
+    for (std::size_t i = 0; i < messageBudget_; ++i)
+    {
+        auto current = pop();
+        if (current == nullptr)
+            return;
+        handledCount_.store(handledCount_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        // the node stays in the mailbox (as its head) until the next pop so the message
+        // is destroyed here, even if the handler throws
+        auto message = &static_cast<message_node *>(current)->value_;
+        struct destroy_message{M * message_; ~destroy_message(){std::destroy_at(message_);}} destroyMessage{message};
+        handler_(std::move(*message));
+    }
+    // budget exhausted.  yield the worker and continue later.
+    if (head_->next_.load(std::memory_order_acquire) != nullptr)
+        contract_.invoke();
+}
+
+
+//=============================================================================
+template <typename M, maniscalco::system::work_contract_mode T>
+inline std::size_t maniscalco::system::actor<M, T>::get_handled_count
+(
+) const
+{
+    return handledCount_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "./cpu_id.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    class cpu_set
+    {
+    public:
+
+        using value_type = cpu_id;
+        using const_iterator = std::vector<cpu_id>::const_iterator;
+
+        cpu_set() = default;
+
+        cpu_set
+        (
+            std::initializer_list<cpu_id>
+        );
+
+        // parse a linux cpu list string such as "0-3,8,10-11"
+        static cpu_set from_string
+        (
+            std::string_view
+        );
+
+        void insert
+        (
+            cpu_id
+        );
+
+        void erase
+        (
+            cpu_id
+        );
+
+        bool contains
+        (
+            cpu_id
+        ) const;
+
+        std::size_t size() const;
+
+        bool empty() const;
+
+        cpu_id front() const;
+
+        const_iterator begin() const;
+
+        const_iterator end() const;
+
+        std::string to_string() const;
+
+        bool operator == (cpu_set const &) const = default;
+
+    private:
+
+        std::vector<cpu_id> cpus_;  // sorted, unique
+    };
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+inline maniscalco::system::cpu_set::cpu_set
+(
+    std::initializer_list<cpu_id> cpus
+)
+{
+    for (auto cpu : cpus)
+        insert(cpu);
+}
+
+
+//=============================================================================
+inline auto maniscalco::system::cpu_set::from_string
+(
+    std::string_view source
+) -> cpu_set
+{
+    cpu_set result;
+    auto parse = [](std::string_view token, cpu_id & value)
+            {
+                while ((!token.empty()) && ((token.front() == ' ') || (token.front() == '\n')))
+                    token.remove_prefix(1);
+                while ((!token.empty()) && ((token.back() == ' ') || (token.back() == '\n')))
+                    token.remove_suffix(1);
+                auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+                return ((ec == std::errc()) && (ptr == token.data() + token.size()) && (!token.empty()));
+            };
+
+    while (!source.empty())
+    {
+        auto comma = source.find(',');
+        auto token = source.substr(0, comma);
+        source = (comma == std::string_view::npos) ? std::string_view() : source.substr(comma + 1);
+
+        cpu_id first{};
+        cpu_id last{};
+        if (auto dash = token.find('-'); dash != std::string_view::npos)
+        {
+            if ((!parse(token.substr(0, dash), first)) || (!parse(token.substr(dash + 1), last)))
+                continue;
+        }
+        else if (parse(token, first))
+        {
+            last = first;
+        }
+        else
+        {
+            continue;
+        }
+        for (auto cpu = first; cpu <= last; ++cpu)
+            result.insert(cpu);
+    }
+    return result;
+}
+
+
+//=============================================================================
+inline void maniscalco::system::cpu_set::insert
+(
+    cpu_id cpu
+)
+{
+    if (auto iter = std::lower_bound(cpus_.begin(), cpus_.end(), cpu); ((iter == cpus_.end()) || (*iter != cpu)))
+        cpus_.insert(iter, cpu);
+}
+
+
+//=============================================================================
+inline void maniscalco::system::cpu_set::erase
+(
+    cpu_id cpu
+)
+{
+    if (auto iter = std::lower_bound(cpus_.begin(), cpus_.end(), cpu); ((iter != cpus_.end()) && (*iter == cpu)))
+        cpus_.erase(iter);
+}
+
+
+//=============================================================================
+inline bool maniscalco::system::cpu_set::contains
+(
+    cpu_id cpu
+) const
+{
+    return std::binary_search(cpus_.begin(), cpus_.end(), cpu);
+}
+
+
+//=============================================================================
+inline std::size_t maniscalco::system::cpu_set::size
+(
+) const
+{
+    return cpus_.size();
+}
+
+
+//=============================================================================
+inline bool maniscalco::system::cpu_set::empty
+(
+) const
+{
+    return cpus_.empty();
+}
+
+
+//=============================================================================
+inline auto maniscalco::system::cpu_set::front
+(
+) const -> cpu_id
+{
+    return cpus_.empty() ? cpu_id(-1) : cpus_.front();
+}
+
+
+//=============================================================================
+inline auto maniscalco::system::cpu_set::begin
+(
+) const -> const_iterator
+{
+    return cpus_.begin();
+}
+
+
+//=============================================================================
+inline auto maniscalco::system::cpu_set::end
+(
+) const -> const_iterator
+{
+    return cpus_.end();
+}
+
+
+//=============================================================================
+inline std::string maniscalco::system::cpu_set::to_string
+(
+) const
+{
+    std::string result;
+    for (auto iter = cpus_.begin(); iter != cpus_.end(); )
+    {
+        auto first = *iter;
+        auto last = first;
+        while ((++iter != cpus_.end()) && (*iter == last + 1))
+            ++last;
+        if (!result.empty())
+            result += ',';
+        result += std::to_string(first);
+        if (last != first)
+            result += '-' + std::to_string(last);
+    }
+    return result;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "./diagnostics/performance_counter.h"
+#include "./diagnostics/stall_watchdog.h"
+#include "./diagnostics/statistics_page.h"
+#include "./diagnostics/tracer.h"
@@ -0,0 +1,131 @@
+#include "./performance_counter.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include <cstring>
+
+
+//=============================================================================
+maniscalco::system::performance_counter::performance_counter
+(
+    event type,
+    bool includeChildThreads
+)
+{
+    #ifdef __linux__
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.inherit = includeChildThreads;
+
+    auto cache_event = [](std::uint64_t cache, std::uint64_t operation, std::uint64_t result)
+            {
+                return (cache | (operation << 8) | (result << 16));
+            };
+
+    switch (type)
+    {
+        case event::cycles:
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case event::instructions:
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case event::cache_misses:
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case event::dtlb_load_misses:
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.config = cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case event::l1d_load_misses:
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.config = cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case event::llc_load_misses:
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.config = cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+    }
+
+    if (auto fd = ::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0); fd > 0)
+        fileDescriptor_ = file_descriptor(fd);
+    #endif
+}
+
+
+//=============================================================================
+bool maniscalco::system::performance_counter::is_valid
+(
+) const
+{
+    return fileDescriptor_.is_valid();
+}
+
+
+//=============================================================================
+void maniscalco::system::performance_counter::start
+(
+)
+{
+    #ifdef __linux__
+    if (is_valid())
+    {
+        ::ioctl(fileDescriptor_.get(), PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fileDescriptor_.get(), PERF_EVENT_IOC_ENABLE, 0);
+    }
+    #endif
+}
+
+
+//=============================================================================
+void maniscalco::system::performance_counter::stop
+(
+)
+{
+    #ifdef __linux__
+    if (is_valid())
+        ::ioctl(fileDescriptor_.get(), PERF_EVENT_IOC_DISABLE, 0);
+    #endif
+}
+
+
+//=============================================================================
+auto maniscalco::system::performance_counter::get_value
+(
+) const -> std::optional<std::uint64_t>
+{
+    std::uint64_t value = 0;
+    if ((is_valid()) && (::read(fileDescriptor_.get(), &value, sizeof(value)) == sizeof(value)))
+        return value;
+    return std::nullopt;
+}
+
+
+//=============================================================================
+char const * maniscalco::system::performance_counter::get_name
+(
+    event type
+)
+{
+    switch (type)
+    {
+        case event::cycles: return "cycles";
+        case event::instructions: return "instructions";
+        case event::cache_misses: return "cache-misses";
+        case event::dtlb_load_misses: return "dTLB-load-misses";
+        case event::l1d_load_misses: return "L1-dcache-load-misses";
+        case event::llc_load_misses: return "LLC-load-misses";
+    }
+    return "unknown";
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <include/file_descriptor.h>
+
+#include <cstdint>
+#include <optional>
+
+
+namespace maniscalco::system
+{
+
+    // hardware event counter (perf_event_open) for the calling thread and, when 
+    // include_child_threads is set, every thread it subsequently creates.  counts 
+    // from child threads are accumulated as those threads exit.
+    class performance_counter
+    {
+    public:
+
+        enum class event : std::uint32_t
+        {
+            cycles                  = 0,
+            instructions            = 1,
+            cache_misses            = 2,
+            dtlb_load_misses        = 3,
+            l1d_load_misses         = 4,
+            llc_load_misses         = 5
+        };
+
+        static auto constexpr include_child_threads = true;
+
+        performance_counter
+        (
+            event,
+            bool = !include_child_threads
+        );
+
+        performance_counter(performance_counter &&) = default;
+        performance_counter & operator = (performance_counter &&) = default;
+
+        bool is_valid() const;
+
+        void start();
+
+        void stop();
+
+        // nullopt if the counter could not be opened (no pmu access, paranoid setting, etc)
+        std::optional<std::uint64_t> get_value() const;
+
+        static char const * get_name
+        (
+            event
+        );
+
+    private:
+
+        file_descriptor fileDescriptor_;
+    };
+
+} // namespace maniscalco::system
@@ -0,0 +1,260 @@
+#include "./stall_watchdog.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <utility>
+
+#include <execinfo.h>
+#include <signal.h>
+
+
+namespace
+{
+
+    static auto constexpr max_stack_depth = 64;
+    static auto constexpr stack_capture_signal = SIGURG;   // ignored by default so a late signal is harmless
+    static auto constexpr stack_capture_timeout = std::chrono::milliseconds(100);
+
+    struct stack_capture
+    {
+        ::pthread_t                         thread_;    // the thread whose stack is wanted
+        std::array<void *, max_stack_depth> frames_;
+        std::atomic<int>                    frameCount_{-1};
+    };
+
+    // the capture which the signal delivered to its thread should fill.  one capture at a time.
+    std::atomic<stack_capture *> pendingCapture{nullptr};
+    std::mutex captureMutex;
+
+    // the handler replaced by capture_stack_handler
+    struct sigaction previousAction;
+
+
+    //=========================================================================
+    void capture_stack_handler
+    (
+        int signal,
+        siginfo_t * signalInfo,
+        void * context
+    )
+    {
+        auto savedErrno = errno;
+        // a late signal (from a capture which timed out) must not fill another thread's capture
+        if (auto capture = pendingCapture.load(std::memory_order_acquire);
+                (capture != nullptr) && (::pthread_equal(capture->thread_, ::pthread_self())) && (pendingCapture.compare_exchange_strong(capture, nullptr)))
+        {
+            capture->frameCount_.store(::backtrace(capture->frames_.data(), max_stack_depth), std::memory_order_release);
+        }
+        else if (previousAction.sa_flags & SA_SIGINFO)
+        {
+            previousAction.sa_sigaction(signal, signalInfo, context);
+        }
+        else if ((previousAction.sa_handler != SIG_DFL) && (previousAction.sa_handler != SIG_IGN))
+        {
+            previousAction.sa_handler(signal);
+        }
+        errno = savedErrno;
+    }
+
+
+    //=========================================================================
+    void install_capture_stack_handler
+    (
+    )
+    {
+        static std::once_flag onceFlag;
+        std::call_once(onceFlag, []()
+                {
+                    // backtrace loads libgcc on first use, which is not safe within a handler
+                    void * frame;
+                    ::backtrace(&frame, 1);
+                    struct sigaction action{};
+                    action.sa_sigaction = capture_stack_handler;
+                    action.sa_flags = SA_RESTART | SA_SIGINFO;
+                    ::sigemptyset(&action.sa_mask);
+                    ::sigaction(stack_capture_signal, &action, &previousAction);
+                });
+    }
+
+} // namespace
+
+
+//=============================================================================
+maniscalco::system::stall_watchdog::stall_watchdog
+(
+    configuration const & config
+):
+    configuration_(config)
+{
+    if (configuration_.scanInterval_.count() <= 0)
+        configuration_.scanInterval_ = std::max<std::chrono::nanoseconds>(configuration_.threshold_ / 4, std::chrono::milliseconds(1));
+    if (configuration_.captureStack_)
+        install_capture_stack_handler();
+    scanThread_ = std::jthread([this](std::stop_token stopToken)
+            {
+                while (true)
+                {
+                    {
+                        std::unique_lock uniqueLock(mutex_);
+                        conditionVariable_.wait_for(uniqueLock, stopToken, configuration_.scanInterval_, [](){return false;});
+                    }
+                    if (stopToken.stop_requested())
+                        break;
+                    scan();
+                }
+            });
+}
+
+
+//=============================================================================
+maniscalco::system::stall_watchdog::~stall_watchdog
+(
+)
+{
+    scanThread_.request_stop();
+    scanThread_.join();
+}
+
+
+//=============================================================================
+auto maniscalco::system::stall_watchdog::register_worker
+(
+    std::size_t workerIndex,
+    std::uint64_t cpuId
+) -> execution_slot *
+{
+    std::lock_guard lockGuard(mutex_);
+    auto iter = std::find_if(workers_.begin(), workers_.end(), [](auto const & worker){return !worker.inUse_;});
+    auto & worker = (iter != workers_.end()) ? *iter : workers_.emplace_back();
+    worker.workerIndex_ = workerIndex;
+    worker.cpuId_ = cpuId;
+    worker.thread_ = ::pthread_self();
+    worker.observedSequence_ = worker.slot_.sequence_.load(std::memory_order_relaxed);
+    worker.reported_ = false;
+    worker.inUse_ = true;
+    return &worker.slot_;
+}
+
+
+//=============================================================================
+void maniscalco::system::stall_watchdog::unregister_worker
+(
+    execution_slot * executionSlot
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    for (auto & worker : workers_)
+        if (&worker.slot_ == executionSlot)
+        {
+            if (std::exchange(worker.reported_, false))
+                --stalledWorkerCount_;
+            worker.inUse_ = false;
+        }
+}
+
+
+//=============================================================================
+void maniscalco::system::stall_watchdog::scan
+(
+)
+{
+    std::vector<stall> stalls;
+    {
+        // held while capturing so that the worker can not exit (unregister) while signalled
+        std::lock_guard lockGuard(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        for (auto & worker : workers_)
+        {
+            if (!worker.inUse_)
+                continue;
+            auto sequence = worker.slot_.sequence_.load(std::memory_order_acquire);
+            if (sequence != worker.observedSequence_)
+            {
+                // a new execution (or none).  duration is measured from the first observation.
+                worker.observedSequence_ = sequence;
+                worker.observedTime_ = now;
+                if (std::exchange(worker.reported_, false))
+                    --stalledWorkerCount_;
+                continue;
+            }
+            if (((sequence & 1) == 0) || (worker.reported_) || ((now - worker.observedTime_) < configuration_.threshold_))
+                continue;
+            auto contract = worker.slot_.contract_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (worker.slot_.sequence_.load(std::memory_order_relaxed) != sequence)
+                continue; // completed while being read
+            worker.reported_ = true;
+            ++stalledWorkerCount_;
+            ++stallCount_;
+            stalls.push_back({.workerIndex_ = worker.workerIndex_, .cpuId_ = worker.cpuId_, .groupId_ = std::uint32_t(contract >> 32),
+                    .contractId_ = std::uint32_t(contract), .duration_ = (now - worker.observedTime_)});
+            if (configuration_.captureStack_)
+            {
+                stalls.back().stack_ = capture_stack(worker);
+                // a stack captured after the execution ended is not the stalled contract's
+                if (worker.slot_.sequence_.load(std::memory_order_acquire) != sequence)
+                    stalls.back().stack_.clear();
+            }
+        }
+    }
+    if (configuration_.stallHandler_)
+        for (auto const & stall : stalls)
+            configuration_.stallHandler_(stall);
+}
+
+
+//=============================================================================
+auto maniscalco::system::stall_watchdog::capture_stack
+(
+    worker const & worker
+) -> std::vector<std::string>
+{
+    std::lock_guard lockGuard(captureMutex);
+    stack_capture capture;
+    capture.thread_ = worker.thread_;
+    pendingCapture.store(&capture, std::memory_order_release);
+    if (::pthread_kill(worker.thread_, stack_capture_signal) != 0)
+    {
+        pendingCapture.store(nullptr);
+        return {};
+    }
+    auto deadline = std::chrono::steady_clock::now() + stack_capture_timeout;
+    while ((capture.frameCount_.load(std::memory_order_acquire) < 0) && (std::chrono::steady_clock::now() < deadline))
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    if ((pendingCapture.exchange(nullptr) == &capture))
+        return {}; // the signal was not handled in time (the thread might be blocking it)
+    // the handler has claimed the capture.  it completes promptly.
+    while (capture.frameCount_.load(std::memory_order_acquire) < 0)
+        std::this_thread::yield();
+
+    std::vector<std::string> stack;
+    auto frameCount = capture.frameCount_.load();
+    if (auto symbols = ::backtrace_symbols(capture.frames_.data(), frameCount); symbols != nullptr)
+    {
+        // skip the handler and the signal trampoline
+        for (auto i = std::min(frameCount, 2); i < frameCount; ++i)
+            stack.emplace_back(symbols[i]);
+        std::free(symbols);
+    }
+    return stack;
+}
+
+
+//=============================================================================
+std::uint64_t maniscalco::system::stall_watchdog::get_stall_count
+(
+) const
+{
+    return stallCount_.load(std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::stall_watchdog::get_stalled_worker_count
+(
+) const
+{
+    return stalledWorkerCount_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+
+
+namespace maniscalco::system
+{
+
+    // detects contracts which hold a worker for too long (blocked in a syscall, on a lock, in
+    // page faults).  each thread_pool worker publishes the contract it is executing into its
+    // own execution_slot (two stores per execution, no clock reads).  a scanning thread stamps
+    // each execution the first time it observes it and reports any which it still observes
+    // after the threshold.  durations are therefore measured to within the scan interval.
+    //
+    // stack capture interrupts the stalled worker with SIGURG and records its stack from
+    // within the signal handler.  signals which are not a capture of the receiving thread are
+    // passed on to any handler installed before the watchdog's.  the watchdog must outlive the
+    // thread_pools which use it.
+    class stall_watchdog
+    {
+    public:
+
+        // written only by the owning worker.  executions nest (a contract may drain another
+        // group) and only the outermost is published.
+        struct alignas(64) execution_slot
+        {
+            std::atomic<std::uint64_t>  sequence_{0};       // odd while a contract is executing
+            std::atomic<std::uint64_t>  contract_{0};       // group id << 32 | contract id
+            std::size_t                 depth_{0};
+
+            void begin
+            (
+                std::uint32_t groupId,
+                std::uint32_t contractId
+            )
+            {
+                if (depth_++ != 0)
+                    return;
+                contract_.store((std::uint64_t(groupId) << 32) | contractId, std::memory_order_release);
+                sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            void end()
+            {
+                if (--depth_ != 0)
+                    return;
+                sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+        };
+
+        struct stall
+        {
+            std::size_t                 workerIndex_;
+            std::uint64_t               cpuId_;             // ~0 if the worker is not pinned
+            std::uint32_t               groupId_;           // the group's trace id
+            std::uint32_t               contractId_;
+            std::chrono::nanoseconds    duration_;          // at least this long
+            std::vector<std::string>    stack_;             // empty unless captureStack_
+        };
+
+        struct configuration
+        {
+            std::chrono::nanoseconds            threshold_{std::chrono::milliseconds(100)};
+            std::chrono::nanoseconds            scanInterval_{0};       // zero for a quarter of the threshold
+            bool                                captureStack_{false};
+            // called on the scanning thread, once per stalled execution
+            std::function<void(stall const &)>  stallHandler_;
+        };
+
+        stall_watchdog
+        (
+            configuration const &
+        );
+
+        ~stall_watchdog();
+
+        stall_watchdog(stall_watchdog const &) = delete;
+        stall_watchdog & operator = (stall_watchdog const &) = delete;
+
+        // called on the worker thread (by thread_pool).  the slot is valid until released.
+        execution_slot * register_worker
+        (
+            std::size_t,        // worker index
+            std::uint64_t       // cpu id
+        );
+
+        void unregister_worker
+        (
+            execution_slot *
+        );
+
+        // stalled executions reported so far
+        std::uint64_t get_stall_count() const;
+
+        // workers currently executing a contract which has been reported
+        std::size_t get_stalled_worker_count() const;
+
+    private:
+
+        struct worker
+        {
+            execution_slot                          slot_;
+            std::size_t                             workerIndex_;
+            std::uint64_t                           cpuId_;
+            ::pthread_t                             thread_;
+            bool                                    inUse_{false};
+            std::uint64_t                           observedSequence_{0};
+            std::chrono::steady_clock::time_point   observedTime_;
+            bool                                    reported_{false};
+        };
+
+        void scan();
+
+        std::vector<std::string> capture_stack
+        (
+            worker const &
+        );
+
+        configuration                   configuration_;
+
+        std::mutex mutable              mutex_;
+
+        std::deque<worker>              workers_;           // stable addresses, slots are reused
+
+        std::atomic<std::uint64_t>      stallCount_{0};
+
+        std::atomic<std::size_t>        stalledWorkerCount_{0};
+
+        std::condition_variable_any     conditionVariable_;
+
+        std::jthread                    scanThread_;
+    };
+
+} // namespace maniscalco::system
@@ -0,0 +1,276 @@
+#include "./statistics_page.h"
+
+#include <include/file_descriptor.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+
+namespace
+{
+
+    //=========================================================================
+    std::string get_path
+    (
+        std::string const & name
+    )
+    {
+        return ("/dev/shm/" + name);
+    }
+
+
+    //=========================================================================
+    template <typename T>
+    bool read_consistent
+    (
+        // seqlock read.  gives up after a bounded number of attempts if the writer is busy.
+        std::atomic<std::uint64_t> const & sequence,
+        T && copy
+    )
+    {
+        for (auto attempt = 0; attempt < 1024; ++attempt)
+        {
+            auto before = sequence.load(std::memory_order_acquire);
+            if (before & 1)
+                continue;
+            copy();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+        return false;
+    }
+
+} // namespace
+
+
+//=============================================================================
+maniscalco::system::statistics_page::statistics_page
+(
+    configuration const & config
+):
+    path_(get_path(config.name_))
+{
+    auto workerOffset = sizeof(header);
+    auto groupOffset = workerOffset + (config.workerCapacity_ * sizeof(worker_statistics));
+    size_ = groupOffset + (config.groupCapacity_ * sizeof(group_statistics));
+
+    file_descriptor fileDescriptor(::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644));
+    if ((!fileDescriptor.is_valid()) || (::ftruncate(fileDescriptor.get(), size_) != 0))
+        throw std::runtime_error("statistics_page: failed to create " + path_);
+    address_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor.get(), 0);
+    if (address_ == MAP_FAILED)
+    {
+        address_ = nullptr;
+        throw std::runtime_error("statistics_page: failed to map " + path_);
+    }
+
+    // file is zero filled by ftruncate.  construct the atomics in place.
+    auto base = static_cast<std::byte *>(address_);
+    workers_ = new (base + workerOffset) worker_statistics[config.workerCapacity_]{};
+    groups_ = new (base + groupOffset) group_statistics[config.groupCapacity_]{};
+    header_ = new (base) header{};
+    header_->version_ = header::current_version;
+    header_->headerSize_ = sizeof(header);
+    header_->workerCapacity_ = config.workerCapacity_;
+    header_->groupCapacity_ = config.groupCapacity_;
+    header_->workerOffset_ = workerOffset;
+    header_->groupOffset_ = groupOffset;
+    header_->workerSize_ = sizeof(worker_statistics);
+    header_->groupSize_ = sizeof(group_statistics);
+    header_->queueingDelayBucketCount_ = queueing_delay_bucket_count;
+    // magic last so that readers never see a partially initialized header
+    std::atomic_thread_fence(std::memory_order_release);
+    std::atomic_ref(header_->magic_).store(header::magic, std::memory_order_release);
+
+    if (config.publishInterval_.count() > 0)
+        publisherThread_ = std::jthread([this, interval = config.publishInterval_](std::stop_token stopToken)
+                {
+                    while (!stopToken.stop_requested())
+                    {
+                        std::this_thread::sleep_for(interval);
+                        publish();
+                    }
+                });
+}
+
+
+//=============================================================================
+maniscalco::system::statistics_page::~statistics_page
+(
+)
+{
+    if (publisherThread_.joinable())
+    {
+        publisherThread_.request_stop();
+        publisherThread_.join();
+    }
+    if (address_ != nullptr)
+        ::munmap(address_, size_);
+    ::unlink(path_.c_str());
+}
+
+
+//=============================================================================
+auto maniscalco::system::statistics_page::allocate_worker_statistics
+(
+    std::size_t index,
+    std::uint64_t cpuId
+) -> worker_statistics *
+{
+    if (index >= header_->workerCapacity_)
+        return nullptr;
+    auto & worker = workers_[index];
+    detail::seqlock_write(worker.sequence_, [&]()
+            {
+                worker.cpuId_.store(cpuId, std::memory_order_relaxed);
+                worker.inUse_.store(1, std::memory_order_relaxed);
+            });
+    return &worker;
+}
+
+
+//=============================================================================
+auto maniscalco::system::statistics_page::allocate_group_statistics
+(
+    std::uint64_t groupId,
+    std::uint64_t capacity
+) -> group_statistics *
+{
+    std::lock_guard lockGuard(mutex_);
+    for (auto i = 0u; i < header_->groupCapacity_; ++i)
+    {
+        auto & group = groups_[i];
+        if (group.inUse_.load(std::memory_order_relaxed) == 0)
+        {
+            detail::seqlock_write(group.sequence_, [&]()
+                    {
+                        group.groupId_.store(groupId, std::memory_order_relaxed);
+                        group.capacity_.store(capacity, std::memory_order_relaxed);
+                        group.activeContracts_.store(0, std::memory_order_relaxed);
+                        group.inUse_.store(1, std::memory_order_relaxed);
+                    });
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
+
+//=============================================================================
+void maniscalco::system::statistics_page::release_group_statistics
+(
+    group_statistics * group
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    if (group != nullptr)
+        detail::seqlock_write(group->sequence_, [&](){group->inUse_.store(0, std::memory_order_relaxed);});
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::statistics_page::add_publisher
+(
+    std::function<void()> publisher
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    publishers_.emplace_back(nextPublisherId_, publisher);
+    return nextPublisherId_++;
+}
+
+
+//=============================================================================
+void maniscalco::system::statistics_page::remove_publisher
+(
+    std::size_t publisherId
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    std::erase_if(publishers_, [&](auto const & publisher){return (publisher.first == publisherId);});
+}
+
+
+//=============================================================================
+void maniscalco::system::statistics_page::publish
+(
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    for (auto const & [_, publisher] : publishers_)
+        publisher();
+    header_->publishCount_.fetch_add(1, std::memory_order_release);
+}
+
+
+//=============================================================================
+auto maniscalco::system::statistics_page::read
+(
+    std::string const & name
+) -> std::optional<snapshot>
+{
+    auto path = get_path(name);
+    file_descriptor fileDescriptor(::open(path.c_str(), O_RDONLY));
+    struct stat fileStatus;
+    if ((!fileDescriptor.is_valid()) || (::fstat(fileDescriptor.get(), &fileStatus) != 0) || ((std::size_t)fileStatus.st_size < sizeof(header)))
+        return std::nullopt;
+    std::size_t size = fileStatus.st_size;
+    auto address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fileDescriptor.get(), 0);
+    if (address == MAP_FAILED)
+        return std::nullopt;
+
+    std::optional<snapshot> result;
+    auto const & pageHeader = *static_cast<header const *>(address);
+    auto magic = std::atomic_ref(const_cast<std::uint64_t &>(pageHeader.magic_)).load(std::memory_order_acquire);
+    if ((magic == header::magic) && (pageHeader.version_ == header::current_version) && 
+        (pageHeader.workerSize_ == sizeof(worker_statistics)) && (pageHeader.groupSize_ == sizeof(group_statistics)) &&
+        ((pageHeader.groupOffset_ + (pageHeader.groupCapacity_ * sizeof(group_statistics))) <= size))
+    {
+        auto base = static_cast<std::byte const *>(address);
+        auto workers = reinterpret_cast<worker_statistics const *>(base + pageHeader.workerOffset_);
+        auto groups = reinterpret_cast<group_statistics const *>(base + pageHeader.groupOffset_);
+        result = snapshot{.publishCount_ = pageHeader.publishCount_.load(std::memory_order_acquire)};
+
+        for (auto i = 0u; i < pageHeader.workerCapacity_; ++i)
+        {
+            auto const & worker = workers[i];
+            if (worker.inUse_.load(std::memory_order_acquire) == 0)
+                continue;
+            worker_snapshot workerSnapshot{.index_ = i};
+            if (read_consistent(worker.sequence_, [&]()
+                    {
+                        workerSnapshot.cpuId_ = worker.cpuId_.load(std::memory_order_relaxed);
+                        workerSnapshot.executions_ = worker.executions_.load(std::memory_order_relaxed);
+                        workerSnapshot.parks_ = worker.parks_.load(std::memory_order_relaxed);
+                        workerSnapshot.wakes_ = worker.wakes_.load(std::memory_order_relaxed);
+                        for (auto j = 0; j < queueing_delay_bucket_count; ++j)
+                            workerSnapshot.queueingDelay_[j] = worker.queueingDelay_[j].load(std::memory_order_relaxed);
+                    }))
+                result->workers_.push_back(workerSnapshot);
+        }
+
+        for (auto i = 0u; i < pageHeader.groupCapacity_; ++i)
+        {
+            auto const & group = groups[i];
+            group_snapshot groupSnapshot;
+            bool inUse = false;
+            if (read_consistent(group.sequence_, [&]()
+                    {
+                        inUse = (group.inUse_.load(std::memory_order_relaxed) != 0);
+                        groupSnapshot.groupId_ = group.groupId_.load(std::memory_order_relaxed);
+                        groupSnapshot.capacity_ = group.capacity_.load(std::memory_order_relaxed);
+                        groupSnapshot.activeContracts_ = group.activeContracts_.load(std::memory_order_relaxed);
+                    }) && (inUse))
+                result->groups_.push_back(groupSnapshot);
+        }
+    }
+    ::munmap(address, size);
+    return result;
+}
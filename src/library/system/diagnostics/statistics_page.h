@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // live counters published into a memory mapped file in /dev/shm so that out of
+    // process monitors can read them without any calls into the scheduler.  every
+    // slot is written by a single writer and protected by its own seqlock, and each
+    // worker writes only to its own cache lines so publishing adds no cross core
+    // traffic on the hot path.
+    //
+    // file layout (version 1):
+    //      header
+    //      worker_statistics[header.workerCapacity_]   at header.workerOffset_
+    //      group_statistics[header.groupCapacity_]     at header.groupOffset_
+    class statistics_page
+    {
+    public:
+
+        static auto constexpr queueing_delay_bucket_count = 32;
+
+        struct alignas(64) header
+        {
+            static auto constexpr magic = 0x5354415453435721ull; // "!WCSTATS"
+            static auto constexpr current_version = 1;
+
+            std::uint64_t               magic_;
+            std::uint32_t               version_;
+            std::uint32_t               headerSize_;
+            std::uint32_t               workerCapacity_;
+            std::uint32_t               groupCapacity_;
+            std::uint32_t               workerOffset_;
+            std::uint32_t               groupOffset_;
+            std::uint32_t               workerSize_;
+            std::uint32_t               groupSize_;
+            std::uint32_t               queueingDelayBucketCount_;
+            std::uint32_t               reserved_;
+            std::atomic<std::uint64_t>  publishCount_;
+        };
+
+        // written only by the owning worker
+        struct alignas(64) worker_statistics
+        {
+            std::atomic<std::uint64_t>  sequence_;      // odd while an update is in progress
+            std::atomic<std::uint64_t>  inUse_;
+            std::atomic<std::uint64_t>  cpuId_;
+            std::atomic<std::uint64_t>  executions_;
+            std::atomic<std::uint64_t>  parks_;
+            std::atomic<std::uint64_t>  wakes_;
+            // bucket i counts invoke to execute delays in [2^(i-1), 2^i) nanoseconds
+            std::atomic<std::uint64_t>  queueingDelay_[queueing_delay_bucket_count];
+
+            void record_execution();
+
+            // execution along with its invoke to execute delay in nanoseconds
+            void record_execution
+            (
+                std::uint64_t
+            );
+
+            void record_park();
+
+            void record_wake();
+        };
+
+        // written only by the publisher
+        struct alignas(64) group_statistics
+        {
+            std::atomic<std::uint64_t>  sequence_;
+            std::atomic<std::uint64_t>  inUse_;
+            std::atomic<std::uint64_t>  groupId_;
+            std::atomic<std::uint64_t>  capacity_;
+            std::atomic<std::uint64_t>  activeContracts_;
+
+            void update
+            (
+                std::uint64_t
+            );
+        };
+
+        // a consistent copy of one slot
+        struct worker_snapshot
+        {
+            std::size_t     index_;
+            std::uint64_t   cpuId_;
+            std::uint64_t   executions_;
+            std::uint64_t   parks_;
+            std::uint64_t   wakes_;
+            std::uint64_t   queueingDelay_[queueing_delay_bucket_count];
+        };
+
+        struct group_snapshot
+        {
+            std::uint64_t   groupId_;
+            std::uint64_t   capacity_;
+            std::uint64_t   activeContracts_;
+        };
+
+        struct snapshot
+        {
+            std::uint64_t                   publishCount_;
+            std::vector<worker_snapshot>    workers_;
+            std::vector<group_snapshot>     groups_;
+        };
+
+        struct configuration
+        {
+            std::string                 name_;                          // file name within /dev/shm
+            std::size_t                 workerCapacity_{256};
+            std::size_t                 groupCapacity_{64};
+            std::chrono::milliseconds   publishInterval_{100};          // zero for no publisher thread
+        };
+
+        // create (or replace) the page
+        statistics_page
+        (
+            configuration const &
+        );
+
+        ~statistics_page();
+
+        statistics_page(statistics_page const &) = delete;
+        statistics_page & operator = (statistics_page const &) = delete;
+
+        // the slot for worker index (nullptr if beyond capacity)
+        worker_statistics * allocate_worker_statistics
+        (
+            std::size_t,        // worker index
+            std::uint64_t       // cpu id
+        );
+
+        group_statistics * allocate_group_statistics
+        (
+            std::uint64_t,      // group id
+            std::uint64_t       // capacity
+        );
+
+        void release_group_statistics
+        (
+            group_statistics *
+        );
+
+        // publishers are called periodically (by the publisher thread, or publish()) to
+        // refresh values which are not updated in place, such as active contract counts
+        std::size_t add_publisher
+        (
+            std::function<void()>
+        );
+
+        void remove_publisher
+        (
+            std::size_t
+        );
+
+        void publish();
+
+        // open an existing page read only.  nullopt if missing or of an incompatible version.
+        static std::optional<snapshot> read
+        (
+            std::string const &
+        );
+
+    private:
+
+        void * address_{nullptr};
+        std::size_t size_{0};
+        std::string path_;
+        header * header_{nullptr};
+        worker_statistics * workers_{nullptr};
+        group_statistics * groups_{nullptr};
+
+        std::mutex mutex_;
+        std::size_t nextPublisherId_{0};
+        std::vector<std::pair<std::size_t, std::function<void()>>> publishers_;
+        std::jthread publisherThread_;
+    };
+
+} // namespace maniscalco::system
+
+
+namespace maniscalco::system::detail
+{
+
+    //=========================================================================
+    template <typename T>
+    inline void seqlock_write
+    (
+        std::atomic<std::uint64_t> & sequence,
+        T && update
+    )
+    {
+        auto value = sequence.load(std::memory_order_relaxed);
+        sequence.store(value + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        update();
+        sequence.store(value + 2, std::memory_order_release);
+    }
+
+
+    //=========================================================================
+    inline void increment
+    (
+        // single writer increment.  no locked instruction required.
+        std::atomic<std::uint64_t> & value
+    )
+    {
+        value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+} // namespace maniscalco::system::detail
+
+
+//=============================================================================
+inline void maniscalco::system::statistics_page::worker_statistics::record_execution
+(
+)
+{
+    detail::seqlock_write(sequence_, [this](){detail::increment(executions_);});
+}
+
+
+//=============================================================================
+inline void maniscalco::system::statistics_page::worker_statistics::record_park
+(
+)
+{
+    detail::seqlock_write(sequence_, [this](){detail::increment(parks_);});
+}
+
+
+//=============================================================================
+inline void maniscalco::system::statistics_page::worker_statistics::record_wake
+(
+)
+{
+    detail::seqlock_write(sequence_, [this](){detail::increment(wakes_);});
+}
+
+
+//=============================================================================
+inline void maniscalco::system::statistics_page::worker_statistics::record_execution
+(
+    std::uint64_t queueingDelay
+)
+{
+    auto bucket = std::min<std::size_t>(std::bit_width(queueingDelay), queueing_delay_bucket_count - 1);
+    detail::seqlock_write(sequence_, [&]()
+            {
+                detail::increment(executions_);
+                detail::increment(queueingDelay_[bucket]);
+            });
+}
+
+
+//=============================================================================
+inline void maniscalco::system::statistics_page::group_statistics::update
+(
+    std::uint64_t activeContracts
+)
+{
+    detail::seqlock_write(sequence_, [&](){activeContracts_.store(activeContracts, std::memory_order_relaxed);});
+}
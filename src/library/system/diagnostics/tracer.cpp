@@ -0,0 +1,152 @@
+#include "./tracer.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include <sched.h>
+
+
+namespace
+{
+
+    //=========================================================================
+    struct ring
+    {
+        ring
+        (
+            std::size_t capacity,
+            std::uint32_t index
+        ):
+            records_(capacity),
+            mask_(capacity - 1),
+            index_(index)
+        {
+        }
+
+        std::vector<maniscalco::system::tracer::record> records_;
+        std::uint64_t                                   mask_;
+        std::uint32_t                                   index_;
+        alignas(64) std::atomic<std::uint64_t>          head_{0};   // written only by the owning thread
+    };
+
+    std::mutex                              registryMutex;
+    // rings outlive their threads so that records from exited threads can still be collected
+    std::vector<std::unique_ptr<ring>>      registry;
+    std::atomic<std::size_t>                ringCapacity{1 << 16};
+    std::atomic<std::uint32_t>              nextGroupId{1};
+    thread_local ring *                     threadRing{nullptr};
+
+
+    //=========================================================================
+    ring & get_thread_ring
+    (
+    )
+    {
+        if (threadRing == nullptr)
+        {
+            std::lock_guard lockGuard(registryMutex);
+            registry.push_back(std::make_unique<ring>(ringCapacity.load(), registry.size()));
+            threadRing = registry.back().get();
+        }
+        return *threadRing;
+    }
+
+} // namespace
+
+
+//=============================================================================
+void maniscalco::system::tracer::enable
+(
+    std::size_t capacity
+)
+{
+    ringCapacity = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+    enabled_ = true;
+}
+
+
+//=============================================================================
+void maniscalco::system::tracer::disable
+(
+)
+{
+    enabled_ = false;
+}
+
+
+//=============================================================================
+std::uint32_t maniscalco::system::tracer::allocate_group_id
+(
+)
+{
+    return nextGroupId++;
+}
+
+
+//=============================================================================
+void maniscalco::system::tracer::write_record
+(
+    event type,
+    std::uint32_t groupId,
+    std::uint32_t contractId
+)
+{
+    auto & threadRing = get_thread_ring();
+    auto head = threadRing.head_.load(std::memory_order_relaxed);
+    auto & record = threadRing.records_[head & threadRing.mask_];
+    record.timestamp_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    record.threadIndex_ = threadRing.index_;
+    record.cpuId_ = ::sched_getcpu();
+    record.groupId_ = groupId;
+    record.contractId_ = contractId;
+    record.event_ = type;
+    threadRing.head_.store(head + 1, std::memory_order_release);
+}
+
+
+//=============================================================================
+auto maniscalco::system::tracer::collect
+(
+) -> std::vector<record>
+{
+    std::vector<record> records;
+    std::lock_guard lockGuard(registryMutex);
+    for (auto const & ring : registry)
+    {
+        auto capacity = ring->records_.size();
+        auto head = ring->head_.load(std::memory_order_acquire);
+        auto first = (head > capacity) ? (head - capacity) : 0;
+        auto begin = records.size();
+        for (auto i = first; i < head; ++i)
+            records.push_back(ring->records_[i & ring->mask_]);
+        // discard anything the writer may have overwritten while we were copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto latestHead = ring->head_.load(std::memory_order_relaxed);
+        if (auto overwritten = ((latestHead + 1) > capacity) ? (latestHead + 1 - capacity) : 0; overwritten > first)
+            records.erase(records.begin() + begin, records.begin() + begin + std::min(overwritten - first, head - first));
+    }
+    std::stable_sort(records.begin(), records.end(), [](auto const & a, auto const & b){return (a.timestamp_ < b.timestamp_);});
+    return records;
+}
+
+
+//=============================================================================
+bool maniscalco::system::tracer::write
+(
+    std::filesystem::path const & path
+)
+{
+    auto records = collect();
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+        return false;
+    file_header header;
+    header.recordCount_ = records.size();
+    stream.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<char const *>(records.data()), records.size() * sizeof(record));
+    return stream.good();
+}
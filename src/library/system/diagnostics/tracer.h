@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // low overhead event tracing.  each thread writes fixed size binary records into its
+    // own ring buffer (a flight recorder: the oldest records are overwritten).  when tracing
+    // is disabled the cost of a trace point is a single relaxed load of a shared flag.
+    // write() snapshots every ring into a binary file which trace_converter turns into
+    // chrome trace json (viewable in perfetto).
+    class tracer
+    {
+    public:
+
+        enum class event : std::uint16_t
+        {
+            contract_invoke         = 0,
+            contract_execute_begin  = 1,
+            contract_execute_end    = 2,
+            contract_surrender      = 3,
+            worker_park             = 4,
+            worker_unpark           = 5,
+            thread_start            = 6,
+            thread_stop             = 7
+        };
+
+        struct record
+        {
+            std::uint64_t   timestamp_;     // steady clock nanoseconds
+            std::uint32_t   threadIndex_;   // index of the recording thread's ring
+            std::uint32_t   cpuId_;
+            std::uint32_t   groupId_;
+            std::uint32_t   contractId_;    // worker index for thread_start and thread_stop
+            event           event_;
+            std::uint16_t   reserved_[3];
+        };
+        static_assert(sizeof(record) == 32);
+
+        struct file_header
+        {
+            static auto constexpr magic = 0x4543415254435721ull; // "!WCTRACE"
+            static auto constexpr current_version = 1;
+
+            std::uint64_t   magic_{magic};
+            std::uint32_t   version_{current_version};
+            std::uint32_t   recordSize_{sizeof(record)};
+            std::uint64_t   recordCount_{0};
+        };
+
+        static bool is_enabled();
+
+        // records per thread, rounded up to a power of two.  applies to rings created afterwards.
+        static void enable
+        (
+            std::size_t = (1 << 16)
+        );
+
+        static void disable();
+
+        static void trace
+        (
+            event,
+            std::uint32_t = 0,      // group id
+            std::uint32_t = 0       // contract id
+        );
+
+        // unique id for a traced entity such as a work_contract_group
+        static std::uint32_t allocate_group_id();
+
+        // snapshot of every thread's ring ordered by timestamp
+        static std::vector<record> collect();
+
+        static bool write
+        (
+            std::filesystem::path const &
+        );
+
+    private:
+
+        static void write_record
+        (
+            event,
+            std::uint32_t,
+            std::uint32_t
+        );
+
+        static inline std::atomic<bool> enabled_{false};
+    };
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+inline bool maniscalco::system::tracer::is_enabled
+(
+)
+{
+    return enabled_.load(std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+inline void maniscalco::system::tracer::trace
+(
+    event type,
+    std::uint32_t groupId,
+    std::uint32_t contractId
+)
+{
+    if (is_enabled())
+        write_record(type, groupId, contractId);
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+#include "./execution/scheduler.h"
+#include "./execution/algorithms.h"
@@ -0,0 +1,682 @@
+#pragma once
+
+#include "./scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+
+namespace maniscalco::system::execution
+{
+
+    namespace detail
+    {
+
+        // std::monostate stands in for void where a value must be stored
+        template <typename T>
+        using storable_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        template <typename F, typename V>
+        struct invoke_result
+        {
+            using type = std::invoke_result_t<F, V &>;
+        };
+
+        template <typename F>
+        struct invoke_result<F, void>
+        {
+            using type = std::invoke_result_t<F>;
+        };
+
+        template <typename S>
+        auto get_context
+        (
+            S const & sender
+        )
+        {
+            if constexpr (requires {sender.get_context();})
+                return sender.get_context();
+            else
+                return nullptr;
+        }
+
+        template <typename S>
+        using context_t = decltype(get_context(std::declval<S const &>()));
+
+        // complete the receiver with a stored value (or no value for void)
+        template <typename V, typename R>
+        void set_stored_value
+        (
+            R & receiver,
+            storable_t<V> & value
+        )
+        {
+            if constexpr (std::is_void_v<V>)
+                receiver.set_value();
+            else
+                receiver.set_value(std::move(value));
+        }
+
+        // pipeable algorithm: sender | closure
+        template <typename F>
+        struct closure
+        {
+            F function_;
+        };
+
+    } // namespace detail
+
+
+    template <sender S, typename F>
+    auto operator |
+    (
+        S && sender,
+        detail::closure<F> closure
+    )
+    {
+        return closure.function_(std::forward<S>(sender));
+    }
+
+
+    //=========================================================================
+    // then: completes with function(value)
+    //=========================================================================
+    template <typename S, typename F>
+    class then_sender
+    {
+    public:
+
+        using value_type = typename detail::invoke_result<F, value_type_t<S>>::type;
+
+        template <typename R>
+        struct receiver
+        {
+            template <typename ... V>
+            void set_value(V && ... value)
+            {
+                if constexpr (std::is_void_v<value_type>)
+                {
+                    try
+                    {
+                        function_(value ...);
+                    }
+                    catch (...)
+                    {
+                        return receiver_.set_error(std::current_exception());
+                    }
+                    receiver_.set_value();
+                }
+                else
+                {
+                    std::optional<value_type> result;
+                    try
+                    {
+                        result.emplace(function_(value ...));
+                    }
+                    catch (...)
+                    {
+                        return receiver_.set_error(std::current_exception());
+                    }
+                    receiver_.set_value(std::move(*result));
+                }
+            }
+
+            void set_error(std::exception_ptr exception){receiver_.set_error(exception);}
+
+            void set_stopped(){receiver_.set_stopped();}
+
+            R   receiver_;
+            F   function_;
+        };
+
+        template <typename R>
+        auto connect(R receiver) &&
+        {
+            return std::move(sender_).connect(then_sender::receiver<R>{std::move(receiver), std::move(function_)});
+        }
+
+        template <typename R>
+        auto connect(R receiver) const &
+        {
+            return sender_.connect(then_sender::receiver<R>{std::move(receiver), function_});
+        }
+
+        auto get_context() const{return detail::get_context(sender_);}
+
+        S   sender_;
+        F   function_;
+    };
+
+
+    template <sender S, typename F>
+    auto then
+    (
+        S && sender,
+        F function
+    )
+    {
+        return then_sender<std::remove_cvref_t<S>, F>{std::forward<S>(sender), std::move(function)};
+    }
+
+
+    template <typename F>
+    auto then
+    (
+        F function
+    )
+    {
+        return detail::closure{[function = std::move(function)](auto && sender) mutable
+                {
+                    return then(std::forward<decltype(sender)>(sender), std::move(function));
+                }};
+    }
+
+
+    //=========================================================================
+    // when_all: completes once every sender has completed.  the value is a tuple of the
+    // values of the non void senders.  the first error (or stop) wins.
+    //=========================================================================
+    template <typename ... S>
+    class when_all_sender
+    {
+    public:
+
+        using value_type = decltype(std::tuple_cat(std::declval<std::conditional_t<std::is_void_v<value_type_t<S>>,
+                std::tuple<>, std::tuple<value_type_t<S>>>>() ...));
+
+        template <typename R>
+        class operation
+        {
+        public:
+
+            operation
+            (
+                std::tuple<S ...> senders,
+                R receiver
+            ):
+                senders_(std::move(senders)),
+                receiver_(std::move(receiver))
+            {
+            }
+
+            operation
+            (
+                operation && other
+            ):
+                senders_(std::move(other.senders_)),
+                receiver_(std::move(other.receiver_))
+            {
+            }
+
+            void start() noexcept
+            {
+                // child operations are connected here, once this operation is at its final address
+                start(std::index_sequence_for<S ...>());
+            }
+
+        private:
+
+            template <std::size_t N>
+            struct receiver
+            {
+                template <typename ... V>
+                void set_value(V && ... value)
+                {
+                    if constexpr (sizeof...(V) > 0)
+                        std::get<N>(operation_->values_).emplace(std::forward<V>(value) ...);
+                    else
+                        std::get<N>(operation_->values_).emplace();
+                    operation_->complete_one();
+                }
+
+                void set_error(std::exception_ptr exception)
+                {
+                    if (auto expected = completed_with_value; operation_->state_.compare_exchange_strong(expected, completed_with_error))
+                        operation_->exception_ = exception;
+                    operation_->complete_one();
+                }
+
+                void set_stopped()
+                {
+                    auto expected = completed_with_value;
+                    operation_->state_.compare_exchange_strong(expected, completed_stopped);
+                    operation_->complete_one();
+                }
+
+                operation * operation_;
+            };
+
+            template <std::size_t ... N>
+            static auto get_operations_type(std::index_sequence<N ...>) -> std::tuple<connect_result_t<S, receiver<N>> ...>;
+
+            using operations_type = decltype(get_operations_type(std::index_sequence_for<S ...>()));
+
+            template <std::size_t ... N>
+            void start(std::index_sequence<N ...>)
+            {
+                operations_.emplace(std::move(std::get<N>(senders_)).connect(receiver<N>{this}) ...);
+                std::apply([](auto & ... operation){(operation.start(), ...);}, *operations_);
+            }
+
+            void complete_one()
+            {
+                if (--remaining_ != 0)
+                    return;
+                switch (state_.load())
+                {
+                    case completed_with_value:
+                    {
+                        value_type result = std::apply([](auto & ... value)
+                                {
+                                    return std::tuple_cat(as_tuple(std::move(*value)) ...);
+                                }, values_);
+                        return receiver_.set_value(std::move(result));
+                    }
+                    case completed_with_error: return receiver_.set_error(exception_);
+                    default: return receiver_.set_stopped();
+                }
+            }
+
+            template <typename V>
+            static auto as_tuple(V && value)
+            {
+                if constexpr (std::is_same_v<std::remove_cvref_t<V>, std::monostate>)
+                    return std::tuple<>();
+                else
+                    return std::tuple<std::remove_cvref_t<V>>(std::forward<V>(value));
+            }
+
+            static auto constexpr completed_with_value = 0;
+            static auto constexpr completed_with_error = 1;
+            static auto constexpr completed_stopped = 2;
+
+            std::tuple<S ...>                                                       senders_;
+            R                                                                       receiver_;
+            std::tuple<std::optional<detail::storable_t<value_type_t<S>>> ...>      values_;
+            std::optional<operations_type>                                          operations_;
+            std::atomic<std::size_t>                                                remaining_{sizeof...(S)};
+            std::atomic<int>                                                        state_{completed_with_value};
+            std::exception_ptr                                                      exception_;
+        };
+
+        template <typename R>
+        operation<R> connect(R receiver) &&{return {std::move(senders_), std::move(receiver)};}
+
+        template <typename R>
+        operation<R> connect(R receiver) const &{return {senders_, std::move(receiver)};}
+
+        auto get_context() const{return detail::get_context(std::get<0>(senders_));}
+
+        std::tuple<S ...>   senders_;
+    };
+
+
+    template <sender ... S>
+    requires (sizeof...(S) > 0)
+    auto when_all
+    (
+        S && ... senders
+    )
+    {
+        return when_all_sender<std::remove_cvref_t<S> ...>{{std::forward<S>(senders) ...}};
+    }
+
+
+    //=========================================================================
+    // bulk: function(i, value) for each i in [0, shape) then completes with the value.
+    // the indices are spread over free slots of the predecessor's execution_context
+    // (the completing thread participates too).  runs serially if there is no context.
+    //=========================================================================
+    template <typename S, typename F>
+    class bulk_sender
+    {
+    public:
+
+        using value_type = value_type_t<S>;
+
+        template <typename R>
+        class operation
+        {
+        public:
+
+            operation
+            (
+                S sender,
+                std::size_t shape,
+                F function,
+                R receiver
+            ):
+                sender_(std::move(sender)),
+                shape_(shape),
+                function_(std::move(function)),
+                receiver_(std::move(receiver))
+            {
+            }
+
+            operation
+            (
+                operation && other
+            ):
+                operation(std::move(other.sender_), other.shape_, std::move(other.function_), std::move(other.receiver_))
+            {
+            }
+
+            void start() noexcept
+            {
+                executionContext_ = detail::get_context(sender_);
+                operation_.emplace(std::move(sender_).connect(upstream_receiver{this}));
+                operation_->start();
+            }
+
+        private:
+
+            struct participant :
+                runnable
+            {
+                operation * operation_;
+            };
+
+            struct upstream_receiver
+            {
+                template <typename ... V>
+                void set_value(V && ... value){operation_->run(std::forward<V>(value) ...);}
+                void set_error(std::exception_ptr exception){operation_->receiver_.set_error(exception);}
+                void set_stopped(){operation_->receiver_.set_stopped();}
+                operation * operation_;
+            };
+
+            template <typename ... V>
+            void run(V && ... value)
+            {
+                value_.emplace(std::forward<V>(value) ...);
+                participants_ = 1;
+                if constexpr (!std::is_null_pointer_v<detail::context_t<S>>)
+                {
+                    if (executionContext_ != nullptr)
+                    {
+                        auto helpers = std::min((shape_ > 0) ? (shape_ - 1) : 0, executionContext_->get_concurrency());
+                        for (std::size_t i = 0; i < helpers; ++i)
+                        {
+                            ++participants_;
+                            if (!executionContext_->try_submit(&participant_))
+                            {
+                                --participants_;
+                                break;
+                            }
+                        }
+                    }
+                }
+                participate();
+            }
+
+            void participate()
+            {
+                for (auto i = next_++; ((i < shape_) && (!failed_.load(std::memory_order_relaxed))); i = next_++)
+                {
+                    try
+                    {
+                        if constexpr (std::is_void_v<value_type>)
+                            function_(i);
+                        else
+                            function_(i, *value_);
+                    }
+                    catch (...)
+                    {
+                        if (!failed_.exchange(true))
+                            exception_ = std::current_exception();
+                    }
+                }
+                if (--participants_ == 0)
+                {
+                    if (failed_)
+                        receiver_.set_error(exception_);
+                    else
+                        detail::set_stored_value<value_type>(receiver_, *value_);
+                }
+            }
+
+            S                                                   sender_;
+            std::size_t                                         shape_;
+            F                                                   function_;
+            R                                                   receiver_;
+            std::optional<connect_result_t<S, upstream_receiver>> operation_;
+            std::optional<detail::storable_t<value_type>>       value_;
+            detail::context_t<S>                                executionContext_{};
+            participant                                         participant_{{.run_ = [](runnable * self)
+                    {
+                        static_cast<participant *>(self)->operation_->participate();
+                    }}, this};
+            std::atomic<std::size_t>                            next_{0};
+            std::atomic<std::size_t>                            participants_{0};
+            std::atomic<bool>                                   failed_{false};
+            std::exception_ptr                                  exception_;
+        };
+
+        template <typename R>
+        operation<R> connect(R receiver) &&{return {std::move(sender_), shape_, std::move(function_), std::move(receiver)};}
+
+        template <typename R>
+        operation<R> connect(R receiver) const &{return {sender_, shape_, function_, std::move(receiver)};}
+
+        auto get_context() const{return detail::get_context(sender_);}
+
+        S           sender_;
+        std::size_t shape_;
+        F           function_;
+    };
+
+
+    template <sender S, typename F>
+    auto bulk
+    (
+        S && sender,
+        std::size_t shape,
+        F function
+    )
+    {
+        return bulk_sender<std::remove_cvref_t<S>, F>{std::forward<S>(sender), shape, std::move(function)};
+    }
+
+
+    template <typename F>
+    auto bulk
+    (
+        std::size_t shape,
+        F function
+    )
+    {
+        return detail::closure{[shape, function = std::move(function)](auto && sender) mutable
+                {
+                    return bulk(std::forward<decltype(sender)>(sender), shape, std::move(function));
+                }};
+    }
+
+
+    //=========================================================================
+    // let_value: function(value) returns a sender which is started in place and whose
+    // completion becomes the completion of the whole.  the value lives until then.
+    //=========================================================================
+    template <typename S, typename F>
+    class let_value_sender
+    {
+    public:
+
+        using inner_sender_type = typename detail::invoke_result<F, value_type_t<S>>::type;
+        using value_type = value_type_t<inner_sender_type>;
+
+        template <typename R>
+        class operation
+        {
+        public:
+
+            operation
+            (
+                S sender,
+                F function,
+                R receiver
+            ):
+                sender_(std::move(sender)),
+                function_(std::move(function)),
+                receiver_(std::move(receiver))
+            {
+            }
+
+            operation(operation && other):
+                sender_(std::move(other.sender_)),
+                function_(std::move(other.function_)),
+                receiver_(std::move(other.receiver_))
+            {
+            }
+
+            void start() noexcept
+            {
+                operation_.emplace(std::move(sender_).connect(upstream_receiver{this}));
+                operation_->start();
+            }
+
+        private:
+
+            struct upstream_receiver
+            {
+                template <typename ... V>
+                void set_value(V && ... value){operation_->run(std::forward<V>(value) ...);}
+                void set_error(std::exception_ptr exception){operation_->receiver_.set_error(exception);}
+                void set_stopped(){operation_->receiver_.set_stopped();}
+                operation * operation_;
+            };
+
+            struct downstream_receiver
+            {
+                template <typename ... V>
+                void set_value(V && ... value){operation_->receiver_.set_value(std::forward<V>(value) ...);}
+                void set_error(std::exception_ptr exception){operation_->receiver_.set_error(exception);}
+                void set_stopped(){operation_->receiver_.set_stopped();}
+                operation * operation_;
+            };
+
+            template <typename ... V>
+            void run(V && ... value)
+            {
+                try
+                {
+                    value_.emplace(std::forward<V>(value) ...);
+                    if constexpr (std::is_void_v<value_type_t<S>>)
+                        innerOperation_.emplace(function_().connect(downstream_receiver{this}));
+                    else
+                        innerOperation_.emplace(function_(*value_).connect(downstream_receiver{this}));
+                }
+                catch (...)
+                {
+                    return receiver_.set_error(std::current_exception());
+                }
+                innerOperation_->start();
+            }
+
+            S                                                                   sender_;
+            F                                                                   function_;
+            R                                                                   receiver_;
+            std::optional<connect_result_t<S, upstream_receiver>>               operation_;
+            std::optional<detail::storable_t<value_type_t<S>>>                  value_;
+            std::optional<connect_result_t<inner_sender_type, downstream_receiver>> innerOperation_;
+        };
+
+        template <typename R>
+        operation<R> connect(R receiver) &&{return {std::move(sender_), std::move(function_), std::move(receiver)};}
+
+        template <typename R>
+        operation<R> connect(R receiver) const &{return {sender_, function_, std::move(receiver)};}
+
+        S   sender_;
+        F   function_;
+    };
+
+
+    template <sender S, typename F>
+    auto let_value
+    (
+        S && sender,
+        F function
+    )
+    {
+        return let_value_sender<std::remove_cvref_t<S>, F>{std::forward<S>(sender), std::move(function)};
+    }
+
+
+    template <typename F>
+    auto let_value
+    (
+        F function
+    )
+    {
+        return detail::closure{[function = std::move(function)](auto && sender) mutable
+                {
+                    return let_value(std::forward<decltype(sender)>(sender), std::move(function));
+                }};
+    }
+
+
+    //=========================================================================
+    // sync_wait: start the sender and block the calling thread until it completes.
+    // returns the value (std::monostate for void senders), nullopt if stopped and
+    // rethrows an error.  must not be called from a worker whose group it waits on
+    // unless other workers service that group.
+    //=========================================================================
+    namespace detail
+    {
+
+        // the waiter destroys the state as soon as it sees done_ so the completing thread
+        // signals under the lock and touches nothing once it has released it
+        template <typename V>
+        struct sync_wait_state
+        {
+            std::optional<storable_t<V>>    result_;
+            std::exception_ptr              exception_;
+            std::mutex                      mutex_;
+            std::condition_variable         conditionVariable_;
+            bool                            done_{false};
+        };
+
+        template <typename V>
+        struct sync_wait_receiver
+        {
+            template <typename ... A>
+            void set_value(A && ... value){state_->result_.emplace(std::forward<A>(value) ...); complete();}
+            void set_error(std::exception_ptr exception){state_->exception_ = exception; complete();}
+            void set_stopped(){complete();}
+            void complete(){std::lock_guard lockGuard(state_->mutex_); state_->done_ = true; state_->conditionVariable_.notify_one();}
+
+            sync_wait_state<V> * state_;
+        };
+
+    } // namespace detail
+
+
+    template <sender S>
+    auto sync_wait
+    (
+        S && sender
+    ) -> std::optional<detail::storable_t<value_type_t<S>>>
+    {
+        detail::sync_wait_state<value_type_t<S>> state;
+        auto operation = std::forward<S>(sender).connect(detail::sync_wait_receiver<value_type_t<S>>{&state});
+        operation.start();
+        {
+            std::unique_lock uniqueLock(state.mutex_);
+            state.conditionVariable_.wait(uniqueLock, [&](){return state.done_;});
+        }
+        if (state.exception_)
+            std::rethrow_exception(state.exception_);
+        return std::move(state.result_);
+    }
+
+} // namespace maniscalco::system::execution
@@ -0,0 +1,378 @@
+#pragma once
+
+#include <library/system/work_contract/work_contract_group.h>
+#include <library/system/work_contract/work_contract.h>
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace maniscalco::system::execution
+{
+
+    // a small subset of the P2300 sender/receiver model over work contracts.
+    //
+    //  receiver:   set_value(value) (or set_value() for void senders), set_error(std::exception_ptr), set_stopped()
+    //  sender:     value_type (a single value or void), connect(receiver) -> operation state
+    //  operation:  start().  operation states may be moved until they are started but not after.
+    //
+    // senders which complete on a work_contract_group also provide get_context() so that
+    // algorithms such as bulk can spread work over the same group.
+
+    template <typename S>
+    concept sender = requires
+    {
+        typename std::remove_cvref_t<S>::value_type;
+    };
+
+    template <typename S, typename R>
+    using connect_result_t = decltype(std::declval<S>().connect(std::declval<R>()));
+
+    template <typename S>
+    using value_type_t = typename std::remove_cvref_t<S>::value_type;
+
+
+    // something to execute on a worker.  embedded in operation states so that scheduling
+    // never allocates.
+    struct runnable
+    {
+        void        (*run_)(runnable *);
+        runnable *  next_{nullptr};
+    };
+
+
+    template <work_contract_mode T>
+    class work_contract_scheduler;
+
+
+    // owns the contracts through which senders complete on a work_contract_group.  each
+    // slot is a contract which executes one runnable per invocation.  slots are taken from
+    // a lock free free list when an operation starts and returned when it executes, so
+    // operations execute concurrently on as many workers as there are slots.  when every
+    // slot is busy, runnables are pushed onto an intrusive overflow list which is drained
+    // by one additional contract.
+    //
+    // destruction waits for the surrender of the context's contracts to execute and helps
+    // execute the group's contracts while it does.  a context must not be destroyed from
+    // within one of its own runnables.
+    template <work_contract_mode T>
+    class execution_context
+    {
+    public:
+
+        using work_contract_group_type = work_contract_group<T>;
+
+        execution_context
+        (
+            work_contract_group_type &,
+            std::size_t                 // number of slots
+        );
+
+        ~execution_context();
+
+        execution_context(execution_context const &) = delete;
+        execution_context & operator = (execution_context const &) = delete;
+
+        work_contract_scheduler<T> get_scheduler();
+
+        std::size_t get_concurrency() const;
+
+        // execute the runnable on a worker.  never fails.
+        void submit
+        (
+            runnable *
+        );
+
+        // execute the runnable on a worker only if a slot is free
+        bool try_submit
+        (
+            runnable *
+        );
+
+    private:
+
+        static auto constexpr empty = std::uint32_t(0);
+
+        void execute_slot
+        (
+            std::size_t
+        );
+
+        void execute_overflow();
+
+        std::size_t acquire_slot();
+
+        void release_slot
+        (
+            std::size_t
+        );
+
+        struct slot
+        {
+            work_contract<T>            contract_;
+            runnable *                  runnable_{nullptr};
+            std::atomic<std::uint32_t>  nextFree_{empty};      // index + 1
+        };
+
+        work_contract_group_type &              workContractGroup_;
+
+        std::unique_ptr<slot[]>                 slots_;
+
+        std::size_t                             slotCount_;
+
+        work_contract<T>                        overflowContract_;
+
+        alignas(64) std::atomic<std::uint64_t>  freeList_{0};           // aba tag << 32 | (index + 1)
+
+        alignas(64) std::atomic<runnable *>     overflow_{nullptr};
+
+        std::atomic<std::size_t>                surrenderedCount_{0};
+
+    }; // class execution_context
+
+
+    // the schedule sender completes with set_value() on one of the group's workers
+    template <work_contract_mode T>
+    class work_contract_scheduler
+    {
+    public:
+
+        template <typename R>
+        class operation :
+            public runnable
+        {
+        public:
+
+            operation
+            (
+                execution_context<T> * executionContext,
+                R receiver
+            ):
+                runnable{.run_ = [](runnable * self){static_cast<operation *>(self)->receiver_.set_value();}},
+                executionContext_(executionContext),
+                receiver_(std::move(receiver))
+            {
+            }
+
+            void start() noexcept{executionContext_->submit(this);}
+
+        private:
+
+            execution_context<T> *  executionContext_;
+            R                       receiver_;
+        };
+
+        class schedule_sender
+        {
+        public:
+
+            using value_type = void;
+
+            template <typename R>
+            operation<R> connect(R receiver) const{return {executionContext_, std::move(receiver)};}
+
+            execution_context<T> * get_context() const{return executionContext_;}
+
+            execution_context<T> *  executionContext_;
+        };
+
+        schedule_sender schedule() const{return {executionContext_};}
+
+        bool operator == (work_contract_scheduler const &) const = default;
+
+    private:
+
+        friend class execution_context<T>;
+
+        work_contract_scheduler
+        (
+            execution_context<T> * executionContext
+        ):
+            executionContext_(executionContext)
+        {
+        }
+
+        execution_context<T> *  executionContext_;
+
+    }; // class work_contract_scheduler
+
+} // namespace maniscalco::system::execution
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::execution::execution_context<T>::execution_context
+(
+    work_contract_group_type & workContractGroup,
+    std::size_t slotCount
+):
+    workContractGroup_(workContractGroup),
+    slots_(std::make_unique<slot[]>(slotCount)),
+    slotCount_(slotCount),
+    overflowContract_(workContractGroup.create_contract([this](){execute_overflow();},
+            [this](){surrenderedCount_.fetch_add(1, std::memory_order_release);}))
+{
+    if (!overflowContract_.is_valid())
+        throw std::runtime_error("execution_context: work_contract_group has no free contracts");
+    for (std::size_t i = 0; i < slotCount_; ++i)
+    {
+        slots_[i].contract_ = workContractGroup.create_contract([this, i](){execute_slot(i);},
+                [this](){surrenderedCount_.fetch_add(1, std::memory_order_release);});
+        if (!slots_[i].contract_.is_valid())
+            throw std::runtime_error("execution_context: work_contract_group has no free contracts");
+        release_slot(i);
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::execution::execution_context<T>::~execution_context
+(
+)
+{
+    // a slot or the overflow contract might be executing.  once its surrender has executed
+    // it can not be.  a contract of a stopped group is not surrendered.
+    std::size_t surrenderCount = overflowContract_.surrender();
+    for (std::size_t i = 0; i < slotCount_; ++i)
+        surrenderCount += slots_[i].contract_.surrender();
+    while (surrenderedCount_.load(std::memory_order_acquire) < surrenderCount)
+    {
+        workContractGroup_.try_execute_next_contract();
+        std::this_thread::yield();
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::execution::execution_context<T>::get_scheduler
+(
+) -> work_contract_scheduler<T>
+{
+    return {this};
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::size_t maniscalco::system::execution::execution_context<T>::get_concurrency
+(
+) const
+{
+    return slotCount_;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::size_t maniscalco::system::execution::execution_context<T>::acquire_slot
+(
+)
+{
+    auto head = freeList_.load(std::memory_order_acquire);
+    while (true)
+    {
+        auto index = static_cast<std::uint32_t>(head);
+        if (index == empty)
+            return slotCount_;
+        auto next = slots_[index - 1].nextFree_.load(std::memory_order_relaxed);
+        if (freeList_.compare_exchange_weak(head, (((head >> 32) + 1) << 32) | next, std::memory_order_acquire))
+            return (index - 1);
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::execution::execution_context<T>::release_slot
+(
+    std::size_t index
+)
+{
+    auto head = freeList_.load(std::memory_order_relaxed);
+    do
+    {
+        slots_[index].nextFree_.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+    } while (!freeList_.compare_exchange_weak(head, (((head >> 32) + 1) << 32) | (index + 1), std::memory_order_release));
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline bool maniscalco::system::execution::execution_context<T>::try_submit
+(
+    runnable * task
+)
+{
+    auto index = acquire_slot();
+    if (index == slotCount_)
+        return false;
+    slots_[index].runnable_ = task;
+    slots_[index].contract_.invoke();
+    return true;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::execution::execution_context<T>::submit
+(
+    runnable * task
+)
+{
+    if (try_submit(task))
+        return;
+    task->next_ = overflow_.load(std::memory_order_relaxed);
+    while (!overflow_.compare_exchange_weak(task->next_, task, std::memory_order_release, std::memory_order_relaxed))
+        ;
+    overflowContract_.invoke();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::execution::execution_context<T>::execute_slot
+(
+    std::size_t index
+)
+{
+    // the slot is free again before the runnable executes (and perhaps destroys its operation).
+    // a slot is invoked at most once per acquisition so the invocation cannot be coalesced.
+    auto task = std::exchange(slots_[index].runnable_, nullptr);
+    release_slot(index);
+    if (task != nullptr)
+        task->run_(task);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::execution::execution_context<T>::execute_overflow
+(
+)
+{
+    // take everything and execute in submission order
+    runnable * ordered = nullptr;
+    for (auto task = overflow_.exchange(nullptr, std::memory_order_acquire); task != nullptr; )
+    {
+        auto next = task->next_;
+        task->next_ = ordered;
+        ordered = task;
+        task = next;
+    }
+    while (ordered != nullptr)
+    {
+        auto task = std::exchange(ordered, ordered->next_);
+        task->run_(task);
+    }
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./logging/async_logger.h"
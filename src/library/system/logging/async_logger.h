@@ -0,0 +1,671 @@
+#pragma once
+
+#include <library/system/work_contract/work_contract_group.h>
+#include <library/system/work_contract/work_contract.h>
+#include <include/file_descriptor.h>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <climits>
+#include <sys/uio.h>
+
+
+namespace maniscalco::system
+{
+
+    namespace detail
+    {
+
+        // format string as a template argument so that each call site has its own
+        // formatting function (its id in the record) and the string is checked at compile time
+        template <std::size_t N>
+        struct log_format_string
+        {
+            constexpr log_format_string(char const (& value)[N]){std::copy_n(value, N, value_);}
+
+            char value_[N];
+        };
+
+
+        // strings are copied into the record and formatted as string_view.  anything else
+        // is copied as is and so must be trivially copyable.
+        template <typename A>
+        using log_argument_t = std::conditional_t<std::is_convertible_v<std::decay_t<A> const &, std::string_view>,
+                std::string_view, std::decay_t<A>>;
+
+
+        template <typename V>
+        inline std::size_t get_encoded_size
+        (
+            V const & value
+        )
+        {
+            if constexpr (std::is_same_v<V, std::string_view>)
+                return (sizeof(std::uint32_t) + value.size());
+            else
+                return sizeof(V);
+        }
+
+
+        template <typename V>
+        inline std::byte * encode_log_argument
+        (
+            std::byte * destination,
+            V const & value
+        )
+        {
+            static_assert(std::is_trivially_copyable_v<V>, "async_logger: arguments must be strings or trivially copyable");
+            if constexpr (std::is_same_v<V, std::string_view>)
+            {
+                auto size = static_cast<std::uint32_t>(value.size());
+                std::memcpy(destination, &size, sizeof(size));
+                std::memcpy(destination + sizeof(size), value.data(), size);
+                return (destination + sizeof(size) + size);
+            }
+            else
+            {
+                std::memcpy(destination, &value, sizeof(V));
+                return (destination + sizeof(V));
+            }
+        }
+
+
+        template <typename V>
+        inline V decode_log_argument
+        (
+            std::byte const * & source
+        )
+        {
+            if constexpr (std::is_same_v<V, std::string_view>)
+            {
+                std::uint32_t size;
+                std::memcpy(&size, source, sizeof(size));
+                std::string_view value(reinterpret_cast<char const *>(source + sizeof(size)), size);
+                source += (sizeof(size) + size);
+                return value;
+            }
+            else
+            {
+                V value;
+                std::memcpy(&value, source, sizeof(V));
+                source += sizeof(V);
+                return value;
+            }
+        }
+
+        // distinguishes a logger from an earlier one which occupied the same address
+        inline std::atomic<std::uint64_t> nextLoggerGeneration{1};
+
+    } // namespace detail
+
+
+    // asynchronous logger.  a log call does no formatting and no i/o: it copies the raw
+    // arguments, along with the id of its format string and a timestamp, into a binary record
+    // in the calling thread's own ring.  a single work contract drains every ring, formats the
+    // records with fmt and writes them to the file descriptor with batched writev calls.
+    //
+    //      async_logger logger(workContractGroup, file_descriptor(::dup(STDOUT_FILENO)));
+    //      logger.log<"order {} filled at {}">(orderId, price);
+    //
+    // a full ring drops the record and counts it rather than blocking the caller.  the count
+    // of dropped records is written to the log once the ring drains.  arguments must be strings
+    // (copied into the record) or trivially copyable.
+    //
+    // the logger must be destroyed while the group still has workers.  destruction writes
+    // whatever remains in the rings and frees them: threads which logged do not keep them alive.
+    template <work_contract_mode T = work_contract_mode::waitable>
+    class async_logger
+    {
+    public:
+
+        using work_contract_group_type = work_contract_group<T>;
+
+        static auto constexpr default_ring_capacity = (1 << 16);    // bytes per thread
+
+        async_logger
+        (
+            work_contract_group_type &,
+            file_descriptor,
+            std::size_t = default_ring_capacity     // rounded up to a power of two
+        );
+
+        ~async_logger();
+
+        async_logger(async_logger const &) = delete;
+        async_logger & operator = (async_logger const &) = delete;
+
+        template <detail::log_format_string F, typename ... A>
+        void log
+        (
+            A && ...
+        );
+
+        // wait until everything logged before the call has been written
+        void flush();
+
+        std::uint64_t get_dropped_count() const;
+
+        std::uint64_t get_write_error_count() const;
+
+    private:
+
+        using format_function = void(*)(fmt::memory_buffer &, std::byte const *);
+
+        struct record_header
+        {
+            std::uint32_t   size_;          // zero marks the unused end of the ring
+            std::uint32_t   reserved_;
+            format_function format_;
+            std::int64_t    timestamp_;     // system clock nanoseconds
+        };
+
+        // single producer (the owning thread), single consumer (the contract) ring of records
+        struct ring
+        {
+            ring
+            (
+                std::size_t capacity,
+                std::size_t index
+            ):
+                buffer_(std::make_unique<std::uint64_t[]>(capacity / sizeof(std::uint64_t))),
+                mask_(capacity - 1),
+                index_(index)
+            {
+            }
+
+            std::byte * reserve
+            (
+                std::size_t
+            );
+
+            bool commit();
+
+            std::byte * get_data(){return reinterpret_cast<std::byte *>(buffer_.get());}
+
+            std::unique_ptr<std::uint64_t[]>        buffer_;
+            std::uint64_t                           mask_;
+            std::size_t                             index_;
+            ring *                                  next_{nullptr};
+            std::atomic<bool>                       attached_{true};
+            alignas(64) std::atomic<std::uint64_t>  writePosition_{0};
+            std::uint64_t                           reservedPosition_{0};       // producer only
+            std::uint64_t                           cachedReadPosition_{0};     // producer only
+            std::atomic<std::uint64_t>              droppedCount_{0};           // written by producer only
+            alignas(64) std::atomic<std::uint64_t>  readPosition_{0};
+            std::uint64_t                           reportedDroppedCount_{0};   // consumer only
+        };
+
+        // rings live as long as the logger.  threads do not keep them alive.  rings of exited
+        // threads are adopted by new threads.
+        struct state :
+            std::enable_shared_from_this<state>
+        {
+            state
+            (
+                std::size_t ringCapacity
+            ):
+                ringCapacity_(ringCapacity),
+                generation_(detail::nextLoggerGeneration.fetch_add(1, std::memory_order_relaxed))
+            {
+            }
+
+            ring * attach();
+
+            std::size_t                 ringCapacity_;
+            std::uint64_t               generation_;
+            std::mutex                  mutex_;             // attach only
+            std::deque<ring>            rings_;
+            std::atomic<ring *>         head_{nullptr};     // every ring, newest first
+        };
+
+        // the calling thread's ring for each logger it has used.  entries of destroyed loggers
+        // are dropped when the thread next attaches to a logger and are skipped when the
+        // thread detaches from its rings at exit.
+        struct thread_ring_registry
+        {
+            struct entry
+            {
+                std::weak_ptr<state>    state_;
+                std::uint64_t           generation_;
+                ring *                  ring_;
+            };
+
+            ~thread_ring_registry()
+            {
+                for (auto & entry : entries_)
+                {
+                    // held while detaching so that the logger can not be destroyed meanwhile
+                    if (auto state = entry.state_.lock(); state != nullptr)
+                        entry.ring_->attached_.store(false, std::memory_order_release);
+                }
+            }
+
+            std::vector<entry>  entries_;
+            state *             lastState_{nullptr};
+            std::uint64_t       lastGeneration_{0};
+            ring *              lastRing_{nullptr};
+        };
+
+        static ring & get_thread_ring
+        (
+            state &
+        );
+
+        template <detail::log_format_string F, typename ... V>
+        static void format_record
+        (
+            fmt::memory_buffer &,
+            std::byte const *
+        );
+
+        template <detail::log_format_string F, typename ... V>
+        void write_record
+        (
+            V const & ...
+        );
+
+        fmt::memory_buffer & get_output_buffer();
+
+        void format_prefix
+        (
+            fmt::memory_buffer &,
+            record_header const &,
+            std::size_t
+        );
+
+        bool drain();
+
+        void write_output();
+
+        static auto constexpr output_buffer_size = (1 << 16);
+
+        std::shared_ptr<state>              state_;
+
+        file_descriptor                     fileDescriptor_;
+
+        // consumer only
+        std::vector<fmt::memory_buffer>     outputBuffers_;
+
+        std::size_t                         outputBufferCount_{0};
+
+        std::vector<iovec>                  iovecs_;
+
+        std::vector<std::pair<ring *, std::uint64_t>> drained_;
+
+        std::int64_t                        prefixSecond_{-1};
+
+        fmt::memory_buffer                  prefixText_;
+
+        std::atomic<std::uint64_t>          writeErrorCount_{0};
+
+        std::atomic<bool>                   surrendered_{false};
+
+        work_contract<T>                    contract_;
+
+    }; // class async_logger
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::async_logger<T>::async_logger
+(
+    work_contract_group_type & workContractGroup,
+    file_descriptor fileDescriptor,
+    std::size_t ringCapacity
+):
+    state_(std::make_shared<state>(std::bit_ceil(std::max<std::size_t>(ringCapacity, 256)))),
+    fileDescriptor_(std::move(fileDescriptor)),
+    contract_(workContractGroup.create_contract([this](){if (drain()) contract_.invoke();},
+            [this](){surrendered_.store(true, std::memory_order_release);}))
+{
+    if (!contract_.is_valid())
+        throw std::runtime_error("async_logger: work_contract_group has no free contracts");
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::async_logger<T>::~async_logger
+(
+)
+{
+    // once the surrender has executed the contract can not be executing so the remaining
+    // records are written from here
+    contract_.surrender();
+    while (!surrendered_.load(std::memory_order_acquire))
+        std::this_thread::yield();
+    drain();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::async_logger<T>::state::attach
+(
+) -> ring *
+{
+    std::lock_guard lockGuard(mutex_);
+    for (auto & ring : rings_)
+    {
+        // adopt the ring of a thread which has exited
+        if (auto expected = false; ring.attached_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return &ring;
+    }
+    auto & ring = rings_.emplace_back(ringCapacity_, rings_.size());
+    ring.next_ = head_.load(std::memory_order_relaxed);
+    head_.store(&ring, std::memory_order_release);
+    return &ring;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::async_logger<T>::get_thread_ring
+(
+    state & loggerState
+) -> ring &
+{
+    thread_local thread_ring_registry registry;
+    if ((registry.lastState_ == &loggerState) && (registry.lastGeneration_ == loggerState.generation_))
+        return *registry.lastRing_;
+    auto iter = std::find_if(registry.entries_.begin(), registry.entries_.end(), 
+            [&](auto const & entry){return (entry.generation_ == loggerState.generation_);});
+    if (iter == registry.entries_.end())
+    {
+        // first use of this logger by this thread.  forget the loggers which have been destroyed.
+        std::erase_if(registry.entries_, [](auto const & entry){return entry.state_.expired();});
+        registry.entries_.push_back({loggerState.weak_from_this(), loggerState.generation_, loggerState.attach()});
+        iter = registry.entries_.end() - 1;
+    }
+    registry.lastState_ = &loggerState;
+    registry.lastGeneration_ = loggerState.generation_;
+    registry.lastRing_ = iter->ring_;
+    return *iter->ring_;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::byte * maniscalco::system::async_logger<T>::ring::reserve
+(
+    std::size_t size
+)
+{
+    // records are contiguous.  one which does not fit before the end of the buffer
+    // starts at the beginning and the end is marked unused.
+    auto capacity = (mask_ + 1);
+    auto writePosition = writePosition_.load(std::memory_order_relaxed);
+    auto contiguous = (capacity - (writePosition & mask_));
+    auto required = (size <= contiguous) ? size : (size + contiguous);
+    if ((writePosition + required - cachedReadPosition_) > capacity)
+    {
+        cachedReadPosition_ = readPosition_.load(std::memory_order_acquire);
+        if ((writePosition + required - cachedReadPosition_) > capacity)
+        {
+            droppedCount_.store(droppedCount_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+    if (size > contiguous)
+    {
+        reinterpret_cast<record_header *>(get_data() + (writePosition & mask_))->size_ = 0;
+        writePosition += contiguous;
+    }
+    reservedPosition_ = (writePosition + size);
+    return (get_data() + (writePosition & mask_));
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline bool maniscalco::system::async_logger<T>::ring::commit
+(
+)
+{
+    // true if the consumer had already drained the ring and so must be invoked.  otherwise
+    // the consumer sees the new record when it rechecks the ring after draining it.
+    auto writePosition = writePosition_.load(std::memory_order_relaxed);
+    writePosition_.store(reservedPosition_, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return (readPosition_.load(std::memory_order_relaxed) == writePosition);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <maniscalco::system::detail::log_format_string F, typename ... A>
+inline void maniscalco::system::async_logger<T>::log
+(
+    A && ... args
+)
+{
+    write_record<F>(detail::log_argument_t<A>(args) ...);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <maniscalco::system::detail::log_format_string F, typename ... V>
+inline void maniscalco::system::async_logger<T>::write_record
+(
+    V const & ... values
+)
+{
+    auto size = (sizeof(record_header) + (detail::get_encoded_size(values) + ... + 0));
+    size = ((size + alignof(record_header) - 1) & ~(alignof(record_header) - 1));
+    auto & ring = get_thread_ring(*state_);
+    auto destination = ring.reserve(size);
+    if (destination == nullptr)
+        return; // ring full.  dropped.
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    new (destination) record_header{static_cast<std::uint32_t>(size), 0, &format_record<F, V ...>, timestamp};
+    auto cursor = (destination + sizeof(record_header));
+    ((cursor = detail::encode_log_argument(cursor, values)), ...);
+    if (ring.commit())
+        contract_.invoke();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <maniscalco::system::detail::log_format_string F, typename ... V>
+inline void maniscalco::system::async_logger<T>::format_record
+(
+    fmt::memory_buffer & buffer,
+    std::byte const * source
+)
+{
+    // braced initialization decodes the arguments in order
+    std::tuple<V ...> values{detail::decode_log_argument<V>(source) ...};
+    std::apply([&](auto const & ... value){fmt::format_to(std::back_inserter(buffer), F.value_, value ...);}, values);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::async_logger<T>::get_output_buffer
+(
+) -> fmt::memory_buffer &
+{
+    if ((outputBufferCount_ == 0) || (outputBuffers_[outputBufferCount_ - 1].size() >= output_buffer_size))
+    {
+        if (outputBufferCount_ == outputBuffers_.size())
+            outputBuffers_.emplace_back();
+        outputBuffers_[outputBufferCount_++].clear();
+    }
+    return outputBuffers_[outputBufferCount_ - 1];
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::async_logger<T>::format_prefix
+(
+    fmt::memory_buffer & buffer,
+    record_header const & header,
+    std::size_t ringIndex
+)
+{
+    // the date and time is formatted once per second
+    auto second = (header.timestamp_ / 1'000'000'000);
+    if (second != prefixSecond_)
+    {
+        prefixSecond_ = second;
+        prefixText_.clear();
+        fmt::format_to(std::back_inserter(prefixText_), "{:%F %T}", fmt::gmtime(static_cast<std::time_t>(second)));
+    }
+    buffer.append(prefixText_.data(), prefixText_.data() + prefixText_.size());
+    fmt::format_to(std::back_inserter(buffer), ".{:09} [{}] ", (header.timestamp_ % 1'000'000'000), ringIndex);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline bool maniscalco::system::async_logger<T>::drain
+(
+)
+{
+    // format everything in every ring, write it and only then release the space so that
+    // flush() can wait on the read positions.  returns true if more records have arrived.
+    outputBufferCount_ = 0;
+    drained_.clear();
+    for (auto ring = state_->head_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next_)
+    {
+        auto readPosition = ring->readPosition_.load(std::memory_order_relaxed);
+        auto writePosition = ring->writePosition_.load(std::memory_order_acquire);
+        if (auto droppedCount = ring->droppedCount_.load(std::memory_order_relaxed); droppedCount != ring->reportedDroppedCount_)
+        {
+            fmt::format_to(std::back_inserter(get_output_buffer()), "async_logger: {} records dropped by [{}]\n",
+                    (droppedCount - ring->reportedDroppedCount_), ring->index_);
+            ring->reportedDroppedCount_ = droppedCount;
+        }
+        if (readPosition == writePosition)
+            continue;
+        while (readPosition != writePosition)
+        {
+            auto record = (ring->get_data() + (readPosition & ring->mask_));
+            auto const & header = *reinterpret_cast<record_header const *>(record);
+            if (header.size_ == 0)
+            {
+                readPosition += ((ring->mask_ + 1) - (readPosition & ring->mask_));
+                continue;
+            }
+            auto & buffer = get_output_buffer();
+            format_prefix(buffer, header, ring->index_);
+            header.format_(buffer, record + sizeof(record_header));
+            buffer.push_back('\n');
+            readPosition += header.size_;
+        }
+        drained_.emplace_back(ring, readPosition);
+    }
+    write_output();
+    for (auto [ring, readPosition] : drained_)
+        ring->readPosition_.store(readPosition, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (auto ring = state_->head_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next_)
+        if (ring->writePosition_.load(std::memory_order_relaxed) != ring->readPosition_.load(std::memory_order_relaxed))
+            return true;
+    return false;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::async_logger<T>::write_output
+(
+)
+{
+    iovecs_.clear();
+    for (std::size_t i = 0; i < outputBufferCount_; ++i)
+        if (outputBuffers_[i].size() > 0)
+            iovecs_.push_back({outputBuffers_[i].data(), outputBuffers_[i].size()});
+    auto current = iovecs_.data();
+    auto end = (current + iovecs_.size());
+    while (current != end)
+    {
+        auto written = ::writev(fileDescriptor_.get(), current, std::min<std::size_t>(end - current, IOV_MAX));
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            // the batch is lost
+            writeErrorCount_.store(writeErrorCount_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        // partial write: skip what was written and continue with the rest
+        for (auto remaining = static_cast<std::size_t>(written); remaining > 0; )
+        {
+            if (remaining < current->iov_len)
+            {
+                current->iov_base = static_cast<std::byte *>(current->iov_base) + remaining;
+                current->iov_len -= remaining;
+                break;
+            }
+            remaining -= current++->iov_len;
+        }
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::async_logger<T>::flush
+(
+)
+{
+    std::vector<std::pair<ring *, std::uint64_t>> targets;
+    for (auto ring = state_->head_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next_)
+        targets.emplace_back(ring, ring->writePosition_.load(std::memory_order_acquire));
+    contract_.invoke();
+    for (auto [ring, writePosition] : targets)
+        while (ring->readPosition_.load(std::memory_order_acquire) < writePosition)
+            std::this_thread::yield();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::uint64_t maniscalco::system::async_logger<T>::get_dropped_count
+(
+) const
+{
+    std::uint64_t droppedCount = 0;
+    for (auto ring = state_->head_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next_)
+        droppedCount += ring->droppedCount_.load(std::memory_order_relaxed);
+    return droppedCount;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::uint64_t maniscalco::system::async_logger<T>::get_write_error_count
+(
+) const
+{
+    return writeErrorCount_.load(std::memory_order_relaxed);
+}
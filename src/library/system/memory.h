@@ -0,0 +1,9 @@
+#pragma once
+
+#include "./memory/arena.h"
+#include "./memory/buffer_pool.h"
+#include "./memory/mapped_array.h"
+#include "./memory/mapped_file.h"
+#include "./memory/numa.h"
+#include "./memory/page_mapping.h"
+#include "./memory/shared_buffer_pool.h"
@@ -0,0 +1,103 @@
+#include "./arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+
+//=============================================================================
+maniscalco::system::arena::arena
+(
+    std::size_t capacity
+):
+    initialCapacity_(capacity)
+{
+    // pages are mapped here but not touched until first allocation so that
+    // an arena created on a pinned thread is backed by that thread's numa node.
+    if (capacity > 0)
+        blocks_.emplace_back(capacity);
+}
+
+
+//=============================================================================
+void maniscalco::system::arena::reset
+(
+)
+{
+    highWaterMark_ = std::max(highWaterMark_, used_);
+    currentBlock_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::arena::get_capacity
+(
+) const
+{
+    std::size_t capacity = 0;
+    for (auto const & block : blocks_)
+        capacity += block.size();
+    return capacity;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::arena::get_high_water_mark
+(
+) const
+{
+    return std::max(highWaterMark_, used_);
+}
+
+
+//=============================================================================
+void * maniscalco::system::arena::do_allocate
+(
+    std::size_t size,
+    std::size_t alignment
+)
+{
+    while (currentBlock_ < blocks_.size())
+    {
+        auto & block = blocks_[currentBlock_];
+        auto base = reinterpret_cast<std::uintptr_t>(block.data());
+        auto address = ((base + offset_ + alignment - 1) & ~(alignment - 1));
+        if ((address + size) <= (base + block.size()))
+        {
+            offset_ = ((address + size) - base);
+            used_ += size;
+            return reinterpret_cast<void *>(address);
+        }
+        // retained blocks are reused in order after a reset
+        ++currentBlock_;
+        offset_ = 0;
+    }
+
+    auto blockSize = std::max({initialCapacity_, (blocks_.empty() ? 0 : blocks_.back().size() * 2), size + alignment});
+    blocks_.emplace_back(blockSize);
+    currentBlock_ = (blocks_.size() - 1);
+    offset_ = 0;
+    return do_allocate(size, alignment);
+}
+
+
+//=============================================================================
+void maniscalco::system::arena::do_deallocate
+(
+    void *,
+    std::size_t,
+    std::size_t
+)
+{
+}
+
+
+//=============================================================================
+bool maniscalco::system::arena::do_is_equal
+(
+    std::pmr::memory_resource const & other
+) const noexcept
+{
+    return (this == &other);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "./page_mapping.h"
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // single threaded bump allocator.  deallocation is a no-op and all memory is
+    // reclaimed at once by reset().  when a block is exhausted another (larger) block 
+    // is mapped and retained across resets so that, once warmed up, allocation never 
+    // reaches the global allocator or the kernel.
+    class arena :
+        public std::pmr::memory_resource
+    {
+    public:
+
+        arena
+        (
+            std::size_t
+        );
+
+        arena(arena &&) = default;
+        arena & operator = (arena &&) = default;
+
+        void reset();
+
+        std::size_t get_capacity() const;
+
+        std::size_t get_high_water_mark() const;
+
+    private:
+
+        void * do_allocate
+        (
+            std::size_t,
+            std::size_t
+        ) override;
+
+        void do_deallocate
+        (
+            void *,
+            std::size_t,
+            std::size_t
+        ) override;
+
+        bool do_is_equal
+        (
+            std::pmr::memory_resource const &
+        ) const noexcept override;
+
+        std::vector<page_mapping>   blocks_;
+        std::size_t                 initialCapacity_{0};
+        std::size_t                 currentBlock_{0};
+        std::size_t                 offset_{0};
+        std::size_t                 used_{0};           // bytes allocated since the last reset
+        std::size_t                 highWaterMark_{0};
+    };
+
+} // namespace maniscalco::system
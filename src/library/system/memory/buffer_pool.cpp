@@ -0,0 +1,132 @@
+#include "./buffer_pool.h"
+
+#include <algorithm>
+
+
+namespace
+{
+
+    std::atomic<std::uint64_t> nextThreadSerial{1};
+
+    // identifies the calling thread.  unlike std::thread::id it is never reused once the
+    // thread exits, so a new thread can not pass for the owner of an orphaned pool.
+    std::uint64_t get_thread_serial
+    (
+    )
+    {
+        thread_local std::uint64_t threadSerial{0};
+        if (threadSerial == 0)
+            threadSerial = nextThreadSerial.fetch_add(1, std::memory_order_relaxed);
+        return threadSerial;
+    }
+
+} // namespace
+
+
+//=============================================================================
+maniscalco::system::buffer_pool::buffer_pool
+(
+    std::size_t bufferSize,
+    std::size_t count
+):
+    bufferSize_(bufferSize),
+    stride_(sizeof(header) + (((bufferSize + alignment - 1) / alignment) * alignment)),
+    ownerThread_(get_thread_serial())
+{
+    if ((bufferSize_ > 0) && (count > 0))
+        add_slab(count);
+}
+
+
+//=============================================================================
+void maniscalco::system::buffer_pool::add_slab
+(
+    std::size_t count
+)
+{
+    auto & slab = slabs_.emplace_back(count * stride_);
+    count = (slab.size() / stride_);
+    auto base = static_cast<std::byte *>(slab.data());
+    for (auto i = count; i-- > 0; )
+        freeList_ = new (base + (i * stride_)) header{this, freeList_};
+    capacity_ += count;
+}
+
+
+//=============================================================================
+void maniscalco::system::buffer_pool::set_owner
+(
+)
+{
+    ownerThread_ = get_thread_serial();
+}
+
+
+//=============================================================================
+bool maniscalco::system::buffer_pool::is_owner
+(
+) const
+{
+    return (ownerThread_ == get_thread_serial());
+}
+
+
+//=============================================================================
+void * maniscalco::system::buffer_pool::allocate
+(
+)
+{
+    if (bufferSize_ == 0)
+        return nullptr;
+    if (freeList_ == nullptr)
+    {
+        freeList_ = remoteFreeList_.exchange(nullptr, std::memory_order_acquire);
+        if (freeList_ == nullptr)
+            add_slab(std::max<std::size_t>(capacity_, 1));
+    }
+    auto buffer = freeList_;
+    freeList_ = buffer->next_;
+    return (buffer + 1);
+}
+
+
+//=============================================================================
+void maniscalco::system::buffer_pool::release
+(
+    void * address
+)
+{
+    if (address == nullptr)
+        return;
+    auto buffer = static_cast<header *>(address) - 1;
+    auto owner = buffer->owner_;
+    if (get_thread_serial() == owner->ownerThread_)
+    {
+        buffer->next_ = owner->freeList_;
+        owner->freeList_ = buffer;
+    }
+    else
+    {
+        buffer->next_ = owner->remoteFreeList_.load(std::memory_order_relaxed);
+        while (!owner->remoteFreeList_.compare_exchange_weak(buffer->next_, buffer, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::buffer_pool::get_buffer_size
+(
+) const
+{
+    return bufferSize_;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::buffer_pool::get_capacity
+(
+) const
+{
+    return capacity_;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "./page_mapping.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // pool of fixed size, cache aligned buffers owned by a single thread.
+    // allocate() must be called by the owning thread.  release() may be called 
+    // from any thread: buffers released by the owner go straight back onto its 
+    // free list while buffers released elsewhere are pushed onto a lock free 
+    // list which the owner reclaims, in one exchange, when its free list runs dry.
+    // buffers must be released before their pool is destroyed.
+    class buffer_pool
+    {
+    public:
+
+        static auto constexpr alignment = 64;
+
+        buffer_pool
+        (
+            std::size_t,            // buffer size
+            std::size_t             // number of buffers to preallocate
+        );
+
+        buffer_pool(buffer_pool const &) = delete;
+        buffer_pool & operator = (buffer_pool const &) = delete;
+
+        void * allocate();
+
+        // make the calling thread the owner.  for a pool handed over to another thread (a
+        // restarted worker); the previous owner must no longer use the pool.
+        void set_owner();
+
+        bool is_owner() const;
+
+        static void release
+        (
+            void *
+        );
+
+        std::size_t get_buffer_size() const;
+
+        std::size_t get_capacity() const;
+
+    private:
+
+        struct alignas(alignment) header
+        {
+            buffer_pool *   owner_;
+            header *        next_;
+        };
+
+        void add_slab
+        (
+            std::size_t
+        );
+
+        std::size_t                 bufferSize_;
+        std::size_t                 stride_;
+        std::uint64_t               ownerThread_;       // see get_thread_serial
+        header *                    freeList_{nullptr};
+        std::vector<page_mapping>   slabs_;
+        std::size_t                 capacity_{0};
+
+        alignas(64) std::atomic<header *>   remoteFreeList_{nullptr};
+    };
+
+} // namespace maniscalco::system
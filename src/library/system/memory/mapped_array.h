@@ -0,0 +1,300 @@
+#pragma once
+
+#include "./page_mapping.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // fixed size array of default constructed T which lives in its own page mapping.
+    // numa bindings are applied before the elements are constructed so that
+    // first touch does not determine placement.  the page type is a preference,
+    // see page_mapping.
+    template <typename T>
+    class mapped_array
+    {
+    public:
+
+        using value_type = T;
+        using iterator = T *;
+        using const_iterator = T const *;
+
+        struct numa_binding
+        {
+            std::size_t     begin_;     // first element
+            std::size_t     end_;       // one past last element
+            numa_node_id    numaNodeId_;
+        };
+
+        mapped_array() = default;
+
+        mapped_array
+        (
+            std::size_t,
+            std::vector<numa_binding> const & = {},
+            page_type = page_type::normal
+        );
+
+        mapped_array(mapped_array &&);
+        mapped_array & operator = (mapped_array &&);
+
+        mapped_array(mapped_array const &) = delete;
+        mapped_array & operator = (mapped_array const &) = delete;
+
+        ~mapped_array();
+
+        T & operator[](std::size_t);
+        T const & operator[](std::size_t) const;
+
+        T * data();
+        T const * data() const;
+
+        std::size_t size() const;
+
+        page_type get_page_type() const;
+
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        T & front();
+        T & back();
+
+        // number of pages spanning [begin, end) and how many of them reside on the numa node
+        std::pair<std::size_t, std::size_t> get_numa_residency
+        (
+            std::size_t,
+            std::size_t,
+            numa_node_id
+        ) const;
+
+    private:
+
+        void destroy();
+
+        page_mapping    mapping_;
+        T *             data_{nullptr};
+        std::size_t     size_{0};
+    };
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <typename T>
+inline maniscalco::system::mapped_array<T>::mapped_array
+(
+    std::size_t size,
+    std::vector<numa_binding> const & numaBindings,
+    page_type pageType
+):
+    mapping_(size * sizeof(T), pageType),
+    data_(static_cast<T *>(mapping_.data())),
+    size_(size)
+{
+    for (auto const & numaBinding : numaBindings)
+        mapping_.bind_to_numa_node(numaBinding.begin_ * sizeof(T), 
+                (numaBinding.end_ - numaBinding.begin_) * sizeof(T), numaBinding.numaNodeId_);
+    std::uninitialized_default_construct_n(data_, size_);
+}
+
+
+//=============================================================================
+template <typename T>
+inline maniscalco::system::mapped_array<T>::mapped_array
+(
+    mapped_array && other
+):
+    mapping_(std::move(other.mapping_)),
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0))
+{
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto maniscalco::system::mapped_array<T>::operator =
+(
+    mapped_array && other
+) -> mapped_array &
+{
+    if (this != &other)
+    {
+        destroy();
+        mapping_ = std::move(other.mapping_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+
+//=============================================================================
+template <typename T>
+inline maniscalco::system::mapped_array<T>::~mapped_array
+(
+)
+{
+    destroy();
+}
+
+
+//=============================================================================
+template <typename T>
+inline void maniscalco::system::mapped_array<T>::destroy
+(
+)
+{
+    if (data_ != nullptr)
+        std::destroy_n(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+
+//=============================================================================
+template <typename T>
+inline T & maniscalco::system::mapped_array<T>::operator[]
+(
+    std::size_t index
+)
+{
+    return data_[index];
+}
+
+
+//=============================================================================
+template <typename T>
+inline T const & maniscalco::system::mapped_array<T>::operator[]
+(
+    std::size_t index
+) const
+{
+    return data_[index];
+}
+
+
+//=============================================================================
+template <typename T>
+inline T * maniscalco::system::mapped_array<T>::data
+(
+)
+{
+    return data_;
+}
+
+
+//=============================================================================
+template <typename T>
+inline T const * maniscalco::system::mapped_array<T>::data
+(
+) const
+{
+    return data_;
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t maniscalco::system::mapped_array<T>::size
+(
+) const
+{
+    return size_;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto maniscalco::system::mapped_array<T>::get_page_type
+(
+) const -> page_type
+{
+    return mapping_.get_page_type();
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto maniscalco::system::mapped_array<T>::begin
+(
+) -> iterator
+{
+    return data_;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto maniscalco::system::mapped_array<T>::end
+(
+) -> iterator
+{
+    return data_ + size_;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto maniscalco::system::mapped_array<T>::begin
+(
+) const -> const_iterator
+{
+    return data_;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto maniscalco::system::mapped_array<T>::end
+(
+) const -> const_iterator
+{
+    return data_ + size_;
+}
+
+
+//=============================================================================
+template <typename T>
+inline T & maniscalco::system::mapped_array<T>::front
+(
+)
+{
+    return data_[0];
+}
+
+
+//=============================================================================
+template <typename T>
+inline T & maniscalco::system::mapped_array<T>::back
+(
+)
+{
+    return data_[size_ - 1];
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto maniscalco::system::mapped_array<T>::get_numa_residency
+(
+    std::size_t begin,
+    std::size_t end,
+    numa_node_id numaNodeId
+) const -> std::pair<std::size_t, std::size_t>
+{
+    if (begin >= end)
+        return {0, 0};
+    auto pageSize = mapping_.get_page_size();
+    auto first = (begin * sizeof(T)) / pageSize;
+    auto last = ((end * sizeof(T)) + pageSize - 1) / pageSize;
+    return {last - first, mapping_.count_pages_on_numa_node(begin * sizeof(T), (end - begin) * sizeof(T), numaNodeId)};
+}
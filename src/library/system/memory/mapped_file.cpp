@@ -0,0 +1,360 @@
+#include "./mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+
+namespace
+{
+
+    auto constexpr hugetlbfs_magic = 0x958458f6;   // HUGETLBFS_MAGIC (linux/magic.h)
+
+    //=========================================================================
+    std::size_t round_up
+    (
+        std::size_t value,
+        std::size_t alignment
+    )
+    {
+        return (((value + alignment - 1) / alignment) * alignment);
+    }
+
+
+    //=========================================================================
+    bool is_writable
+    (
+        maniscalco::system::io_mode ioMode
+    )
+    {
+        return ((static_cast<std::uint32_t>(ioMode) & static_cast<std::uint32_t>(maniscalco::system::io_mode::write)) != 0);
+    }
+
+} // namespace
+
+
+//=============================================================================
+maniscalco::system::mapped_file::mapped_file
+(
+    std::filesystem::path const & path,
+    configuration const & config
+):
+    fileDescriptor_(::open(path.c_str(), is_writable(config.ioMode_) ? (O_RDWR | O_CREAT) : O_RDONLY, 0644))
+{
+    if (!fileDescriptor_.is_valid())
+        throw std::runtime_error("mapped_file: failed to open " + path.string());
+    map(config);
+}
+
+
+//=============================================================================
+maniscalco::system::mapped_file::mapped_file
+(
+    file_descriptor fileDescriptor,
+    configuration const & config
+):
+    fileDescriptor_(std::move(fileDescriptor))
+{
+    if (!fileDescriptor_.is_valid())
+        throw std::runtime_error("mapped_file: invalid file descriptor");
+    map(config);
+}
+
+
+//=============================================================================
+maniscalco::system::mapped_file::mapped_file
+(
+    mapped_file && other
+):
+    fileDescriptor_(std::move(other.fileDescriptor_)),
+    address_(std::exchange(other.address_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    capacity_(std::exchange(other.capacity_, 0)),
+    growthSize_(other.growthSize_),
+    pageSize_(other.pageSize_),
+    ioMode_(std::exchange(other.ioMode_, io_mode::none)),
+    pageType_(other.pageType_),
+    populate_(other.populate_)
+{
+}
+
+
+//=============================================================================
+auto maniscalco::system::mapped_file::operator =
+(
+    mapped_file && other
+) -> mapped_file &
+{
+    if (this != &other)
+    {
+        release();
+        fileDescriptor_ = std::move(other.fileDescriptor_);
+        address_ = std::exchange(other.address_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+        growthSize_ = other.growthSize_;
+        pageSize_ = other.pageSize_;
+        ioMode_ = std::exchange(other.ioMode_, io_mode::none);
+        pageType_ = other.pageType_;
+        populate_ = other.populate_;
+    }
+    return *this;
+}
+
+
+//=============================================================================
+maniscalco::system::mapped_file::~mapped_file
+(
+)
+{
+    release();
+}
+
+
+//=============================================================================
+void maniscalco::system::mapped_file::map
+(
+    configuration const & config
+)
+{
+    auto fileDescriptor = fileDescriptor_.get();
+    pageSize_ = ::sysconf(_SC_PAGESIZE);
+    ioMode_ = config.ioMode_;
+    populate_ = config.populate_;
+    if (struct statfs fileSystem; (::fstatfs(fileDescriptor, &fileSystem) == 0) && (fileSystem.f_type == hugetlbfs_magic))
+    {
+        // hugetlbfs files are sized and mapped in whole huge pages of the mount's page size
+        pageType_ = page_type::huge;
+        pageSize_ = fileSystem.f_bsize;
+    }
+    growthSize_ = round_up(std::max<std::size_t>(config.growthSize_, 1), pageSize_);
+
+    struct stat fileStatus;
+    if (::fstat(fileDescriptor, &fileStatus) != 0)
+        throw std::runtime_error("mapped_file: failed to stat file");
+    size_ = fileStatus.st_size;
+    if (is_writable(ioMode_))
+    {
+        if (config.truncate_)
+            size_ = 0;
+        if (!grow(size_))
+            throw std::runtime_error("mapped_file: failed to map file");
+    }
+    else if (size_ > 0)
+    {
+        capacity_ = size_;
+        auto address = ::mmap(nullptr, capacity_, PROT_READ, MAP_SHARED | (populate_ ? MAP_POPULATE : 0), fileDescriptor, 0);
+        if (address == MAP_FAILED)
+            throw std::runtime_error("mapped_file: failed to map file");
+        address_ = static_cast<std::byte *>(address);
+    }
+
+    #ifdef MADV_HUGEPAGE
+    if ((config.pageType_ != page_type::normal) && (pageType_ == page_type::normal) && (address_ != nullptr) &&
+            (::madvise(address_, capacity_, MADV_HUGEPAGE) == 0))
+        pageType_ = page_type::transparent_huge;
+    #endif
+    if (config.accessPattern_ != access_pattern::normal)
+        advise(config.accessPattern_);
+}
+
+
+//=============================================================================
+bool maniscalco::system::mapped_file::grow
+(
+    std::size_t required
+)
+{
+    // extend the file to a whole number of growth chunks and map (or remap) all of it
+    auto capacity = round_up(std::max<std::size_t>(required, 1), growthSize_);
+    if (capacity <= capacity_)
+        return true;
+    if (::ftruncate(fileDescriptor_.get(), capacity) != 0)
+        return false;
+    auto address = (address_ == nullptr) ?
+            ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | (populate_ ? MAP_POPULATE : 0), fileDescriptor_.get(), 0) :
+            ::mremap(address_, capacity_, capacity, MREMAP_MAYMOVE);
+    if (address == MAP_FAILED)
+    {
+        ::ftruncate(fileDescriptor_.get(), std::max(capacity_, size_));
+        return false;
+    }
+    #ifdef MADV_POPULATE_WRITE
+    // mremap does not honour MAP_POPULATE so fault in the new chunk explicitly
+    if (populate_ && (address_ != nullptr))
+        ::madvise(static_cast<std::byte *>(address) + capacity_, capacity - capacity_, MADV_POPULATE_WRITE);
+    #endif
+    #ifdef MADV_HUGEPAGE
+    if ((pageType_ == page_type::transparent_huge) && (address_ != nullptr))
+        ::madvise(address, capacity, MADV_HUGEPAGE);
+    #endif
+    address_ = static_cast<std::byte *>(address);
+    capacity_ = capacity;
+    return true;
+}
+
+
+//=============================================================================
+void maniscalco::system::mapped_file::release
+(
+)
+{
+    if (auto address = std::exchange(address_, nullptr); address != nullptr)
+        ::munmap(address, capacity_);
+    // trim the unused part of the last growth chunk.  hugetlbfs rejects sizes which are not
+    // whole huge pages so the trim keeps the last partial page there.  a trim which fails
+    // leaves the file at its capacity.
+    auto size = (pageType_ == page_type::huge) ? round_up(size_, pageSize_) : size_;
+    if (is_writable(ioMode_) && fileDescriptor_.is_valid() && (capacity_ != size))
+        ::ftruncate(fileDescriptor_.get(), size);
+    capacity_ = size_ = 0;
+    ioMode_ = io_mode::none;
+    fileDescriptor_.close();
+}
+
+
+//=============================================================================
+bool maniscalco::system::mapped_file::is_valid
+(
+) const
+{
+    return fileDescriptor_.is_valid();
+}
+
+
+//=============================================================================
+std::byte * maniscalco::system::mapped_file::data
+(
+) const
+{
+    return address_;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::mapped_file::size
+(
+) const
+{
+    return size_;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::mapped_file::get_capacity
+(
+) const
+{
+    return capacity_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::mapped_file::get_span
+(
+) const -> std::span<std::byte const>
+{
+    return {address_, size_};
+}
+
+
+//=============================================================================
+bool maniscalco::system::mapped_file::append
+(
+    void const * source,
+    std::size_t size
+)
+{
+    auto offset = size_;
+    if (!resize(offset + size))
+        return false;
+    std::memcpy(address_ + offset, source, size);
+    return true;
+}
+
+
+//=============================================================================
+bool maniscalco::system::mapped_file::resize
+(
+    std::size_t size
+)
+{
+    if ((!is_writable(ioMode_)) || ((size > capacity_) && (!grow(size))))
+        return false;
+    size_ = size;
+    return true;
+}
+
+
+//=============================================================================
+bool maniscalco::system::mapped_file::advise
+(
+    access_pattern accessPattern,
+    std::size_t offset,
+    std::size_t length
+)
+{
+    static std::size_t const pageSize = ::sysconf(_SC_PAGESIZE);
+    if ((address_ == nullptr) || (offset >= capacity_))
+        return false;
+    // madvise needs a page aligned start
+    auto begin = ((offset / pageSize) * pageSize);
+    auto end = std::min(capacity_, offset + std::min(length, capacity_ - offset));
+    int advice = MADV_NORMAL;
+    switch (accessPattern)
+    {
+        case access_pattern::normal: advice = MADV_NORMAL; break;
+        case access_pattern::sequential: advice = MADV_SEQUENTIAL; break;
+        case access_pattern::random: advice = MADV_RANDOM; break;
+        case access_pattern::will_need: advice = MADV_WILLNEED; break;
+        case access_pattern::dont_need: advice = MADV_DONTNEED; break;
+    }
+    return (::madvise(address_ + begin, end - begin, advice) == 0);
+}
+
+
+//=============================================================================
+bool maniscalco::system::mapped_file::sync
+(
+    synchronization_mode synchronizationMode
+)
+{
+    if ((address_ == nullptr) || (!is_writable(ioMode_)))
+        return false;
+    return (::msync(address_, capacity_, (synchronizationMode == synchronization_mode::blocking) ? MS_SYNC : MS_ASYNC) == 0);
+}
+
+
+//=============================================================================
+auto maniscalco::system::mapped_file::get_io_mode
+(
+) const -> io_mode
+{
+    return ioMode_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::mapped_file::get_page_type
+(
+) const -> page_type
+{
+    return pageType_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::mapped_file::get_file_descriptor
+(
+) const -> file_descriptor const &
+{
+    return fileDescriptor_;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "./page_mapping.h"
+
+#include <include/file_descriptor.h>
+#include <include/io_mode.h>
+#include <include/synchronization_mode.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+
+namespace maniscalco::system
+{
+
+    // a file mapped into memory (shared, so writes go to the file).  io_mode::read maps the
+    // file read only.  a write mapping can be appended to: the file is extended and the mapping
+    // grown in chunks of growthSize_ so that appending is a copy into mapped memory with an
+    // occasional ftruncate and mremap.  on destruction a write mapping truncates the file to
+    // the bytes actually written (rounded up to a whole huge page on hugetlbfs, which can only
+    // size files in whole pages).
+    //
+    // growing a mapping may move it.  pointers into a write mapping are invalidated by
+    // append() and resize().
+    class mapped_file
+    {
+    public:
+
+        enum class access_pattern : std::uint32_t
+        {
+            normal      = 0,
+            sequential  = 1,    // MADV_SEQUENTIAL: aggressive read ahead, pages freed soon after use
+            random      = 2,    // MADV_RANDOM: no read ahead
+            will_need   = 3,    // MADV_WILLNEED: start reading now
+            dont_need   = 4     // MADV_DONTNEED: drop the pages (they are re-read if touched)
+        };
+
+        struct configuration
+        {
+            io_mode         ioMode_{io_mode::read};
+            access_pattern  accessPattern_{access_pattern::normal};
+            bool            populate_{false};               // fault in every page up front (MAP_POPULATE)
+            page_type       pageType_{page_type::normal};   // see get_page_type()
+            std::size_t     growthSize_{64ull << 20};       // write mappings only
+            bool            truncate_{false};               // write mappings only.  discard existing contents.
+        };
+
+        mapped_file() = default;
+
+        // opens (creating if io_mode includes write) the file.  throws std::runtime_error on failure.
+        mapped_file
+        (
+            std::filesystem::path const &,
+            configuration const &
+        );
+
+        // maps an already open file.  the descriptor must have been opened for reading, and also
+        // for writing if io_mode includes write.
+        mapped_file
+        (
+            file_descriptor,
+            configuration const &
+        );
+
+        mapped_file
+        (
+            mapped_file &&
+        );
+
+        mapped_file & operator =
+        (
+            mapped_file &&
+        );
+
+        ~mapped_file();
+
+        bool is_valid() const;
+
+        std::byte * data() const;
+
+        // bytes of file content (for a write mapping, the bytes written so far)
+        std::size_t size() const;
+
+        // bytes currently mapped (for a write mapping, room to grow before the next remap)
+        std::size_t get_capacity() const;
+
+        std::span<std::byte const> get_span() const;
+
+        // copy to the end of a write mapping, growing it as required.  false if the mapping
+        // is read only or could not be grown.
+        bool append
+        (
+            void const *,
+            std::size_t
+        );
+
+        // set the size of a write mapping, growing it as required
+        bool resize
+        (
+            std::size_t
+        );
+
+        // apply an access pattern hint to [offset, offset + length)
+        bool advise
+        (
+            access_pattern,
+            std::size_t = 0,
+            std::size_t = ~std::size_t(0)
+        );
+
+        // flush written pages to the file (msync).  blocking waits for the write back.
+        bool sync
+        (
+            synchronization_mode = synchronization_mode::blocking
+        );
+
+        io_mode get_io_mode() const;
+
+        // huge for files on hugetlbfs (which are always mapped with huge pages).  transparent_huge
+        // when requested and the kernel accepted MADV_HUGEPAGE for the mapping (which needs file
+        // thp support, tmpfs with huge=advise for instance).  normal otherwise.
+        page_type get_page_type() const;
+
+        file_descriptor const & get_file_descriptor() const;
+
+    private:
+
+        mapped_file(mapped_file const &) = delete;
+        mapped_file & operator = (mapped_file const &) = delete;
+
+        void map
+        (
+            configuration const &
+        );
+
+        bool grow
+        (
+            std::size_t
+        );
+
+        void release();
+
+        file_descriptor fileDescriptor_;
+        std::byte *     address_{nullptr};
+        std::size_t     size_{0};
+        std::size_t     capacity_{0};
+        std::size_t     growthSize_{0};
+        std::size_t     pageSize_{0};
+        io_mode         ioMode_{io_mode::none};
+        page_type       pageType_{page_type::normal};
+        bool            populate_{false};
+    };
+
+} // namespace maniscalco::system
@@ -0,0 +1,84 @@
+#include "./numa.h"
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <vector>
+
+
+namespace
+{
+
+    thread_local std::optional<maniscalco::system::numa_node_id> threadNumaNodeId;
+
+} // namespace
+
+
+//=============================================================================
+bool maniscalco::system::bind_to_numa_node
+(
+    void * address,
+    std::size_t size,
+    numa_node_id numaNodeId
+)
+{
+    #ifdef __linux__
+    static auto constexpr bits_per_word = (sizeof(unsigned long) * 8);
+    std::vector<unsigned long> nodeMask((numaNodeId / bits_per_word) + 1);
+    nodeMask[numaNodeId / bits_per_word] = (1ul << (numaNodeId % bits_per_word));
+    // maxnode is one greater than the number of bits in the mask (kernel quirk)
+    return (::syscall(SYS_mbind, address, size, MPOL_PREFERRED, nodeMask.data(), 
+            (nodeMask.size() * bits_per_word) + 1, MPOL_MF_MOVE) == 0);
+    #else
+    return false;
+    #endif
+}
+
+
+//=============================================================================
+auto maniscalco::system::get_numa_node_id
+(
+    void const * address
+) -> std::optional<numa_node_id>
+{
+    #ifdef __linux__
+    // move_pages with no target nodes reports where each page resides without faulting it in
+    void * page = const_cast<void *>(address);
+    std::int32_t status = -1;
+    if ((::syscall(SYS_move_pages, 0, 1, &page, nullptr, &status, 0) == 0) && (status >= 0))
+        return numa_node_id(status);
+    #endif
+    return std::nullopt;
+}
+
+
+//=============================================================================
+auto maniscalco::system::get_thread_numa_node_id
+(
+) -> numa_node_id
+{
+    if (!threadNumaNodeId.has_value())
+        return refresh_thread_numa_node_id();
+    return *threadNumaNodeId;
+}
+
+
+//=============================================================================
+auto maniscalco::system::refresh_thread_numa_node_id
+(
+) -> numa_node_id
+{
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    #ifdef __linux__
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+        node = 0;
+    #endif
+    threadNumaNodeId = node;
+    return node;
+}
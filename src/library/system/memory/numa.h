@@ -0,0 +1,34 @@
+#pragma once
+
+#include <library/system/topology/cpu_topology.h>
+
+#include <cstddef>
+#include <optional>
+
+
+namespace maniscalco::system
+{
+
+    // set the preferred numa node for the pages in [address, address + size).
+    // address and size must be page aligned.  pages already touched are migrated.
+    bool bind_to_numa_node
+    (
+        void *,
+        std::size_t,
+        numa_node_id
+    );
+
+    // numa node on which the page containing the address currently resides.
+    // returns nullopt if the page has not been touched or numa is not available.
+    std::optional<numa_node_id> get_numa_node_id
+    (
+        void const *
+    );
+
+    // numa node of the calling thread's cpu.  cached per thread.
+    numa_node_id get_thread_numa_node_id();
+
+    // re-read the numa node of the calling thread's cpu (after migrating the thread).
+    numa_node_id refresh_thread_numa_node_id();
+
+} // namespace maniscalco::system
@@ -0,0 +1,212 @@
+#include "./page_mapping.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+namespace
+{
+
+    auto constexpr huge_page_size = (2ull << 20);
+
+    //=========================================================================
+    std::size_t round_up
+    (
+        std::size_t value,
+        std::size_t alignment
+    )
+    {
+        return (((value + alignment - 1) / alignment) * alignment);
+    }
+
+} // namespace
+
+
+//=============================================================================
+maniscalco::system::page_mapping::page_mapping
+(
+    std::size_t size,
+    page_type pageType
+):
+    pageSize_(::sysconf(_SC_PAGESIZE))
+{
+    if (size == 0)
+        return;
+
+    #ifdef MAP_HUGETLB
+    if (pageType == page_type::huge)
+    {
+        // explicit 2MB pages.  fails if the hugetlb pool is too small.
+        auto hugeSize = round_up(size, huge_page_size);
+        auto address = ::mmap(nullptr, hugeSize, PROT_READ | PROT_WRITE, 
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+        if (address != MAP_FAILED)
+        {
+            address_ = address;
+            size_ = hugeSize;
+            pageSize_ = huge_page_size;
+            pageType_ = page_type::huge;
+            return;
+        }
+        pageType = page_type::transparent_huge;
+    }
+    #endif
+
+    #ifdef MADV_HUGEPAGE
+    if (pageType == page_type::transparent_huge)
+    {
+        // over allocate so that the region can be trimmed to 2MB alignment then advise thp
+        auto hugeSize = round_up(size, huge_page_size);
+        auto address = ::mmap(nullptr, hugeSize + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED)
+            throw std::bad_alloc();
+        auto begin = reinterpret_cast<std::uintptr_t>(address);
+        auto alignedBegin = round_up(begin, huge_page_size);
+        if (alignedBegin != begin)
+            ::munmap(address, alignedBegin - begin);
+        if (auto tail = (huge_page_size - (alignedBegin - begin)); tail > 0)
+            ::munmap(reinterpret_cast<void *>(alignedBegin + hugeSize), tail);
+        address_ = reinterpret_cast<void *>(alignedBegin);
+        size_ = hugeSize;
+        if (::madvise(address_, size_, MADV_HUGEPAGE) == 0)
+        {
+            pageSize_ = huge_page_size;
+            pageType_ = page_type::transparent_huge;
+        }
+        return;
+    }
+    #endif
+
+    size_ = round_up(size, pageSize_);
+    address_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address_ == MAP_FAILED)
+    {
+        address_ = nullptr;
+        size_ = 0;
+        throw std::bad_alloc();
+    }
+}
+
+
+//=============================================================================
+maniscalco::system::page_mapping::page_mapping
+(
+    page_mapping && other
+):
+    address_(std::exchange(other.address_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    pageSize_(other.pageSize_),
+    pageType_(other.pageType_)
+{
+}
+
+
+//=============================================================================
+auto maniscalco::system::page_mapping::operator =
+(
+    page_mapping && other
+) -> page_mapping &
+{
+    if (this != &other)
+    {
+        release();
+        address_ = std::exchange(other.address_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        pageSize_ = other.pageSize_;
+        pageType_ = other.pageType_;
+    }
+    return *this;
+}
+
+
+//=============================================================================
+maniscalco::system::page_mapping::~page_mapping
+(
+)
+{
+    release();
+}
+
+
+//=============================================================================
+void maniscalco::system::page_mapping::release
+(
+)
+{
+    if (auto address = std::exchange(address_, nullptr); address != nullptr)
+        ::munmap(address, std::exchange(size_, 0));
+}
+
+
+//=============================================================================
+void * maniscalco::system::page_mapping::data
+(
+) const
+{
+    return address_;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::page_mapping::size
+(
+) const
+{
+    return size_;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::page_mapping::get_page_size
+(
+) const
+{
+    return pageSize_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::page_mapping::get_page_type
+(
+) const -> page_type
+{
+    return pageType_;
+}
+
+
+//=============================================================================
+bool maniscalco::system::page_mapping::bind_to_numa_node
+(
+    std::size_t offset,
+    std::size_t length,
+    numa_node_id numaNodeId
+)
+{
+    auto begin = ((offset + pageSize_ - 1) / pageSize_) * pageSize_;
+    auto end = (std::min(offset + length, size_) / pageSize_) * pageSize_;
+    if (begin >= end)
+        return false;
+    return system::bind_to_numa_node(static_cast<std::byte *>(address_) + begin, end - begin, numaNodeId);
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::page_mapping::count_pages_on_numa_node
+(
+    std::size_t offset,
+    std::size_t length,
+    numa_node_id numaNodeId
+) const
+{
+    std::size_t count = 0;
+    auto end = std::min(offset + length, size_);
+    for (auto page = (offset / pageSize_) * pageSize_; page < end; page += pageSize_)
+        if (system::get_numa_node_id(static_cast<std::byte const *>(address_) + page) == numaNodeId)
+            ++count;
+    return count;
+}
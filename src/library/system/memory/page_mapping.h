@@ -0,0 +1,87 @@
+#pragma once
+
+#include "./numa.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace maniscalco::system
+{
+
+    enum class page_type : std::uint32_t
+    {
+        normal              = 0,
+        transparent_huge    = 1,    // madvise(MADV_HUGEPAGE) on a 2MB aligned region
+        huge                = 2     // explicit 2MB pages from the hugetlb pool (MAP_HUGETLB)
+    };
+
+
+    // anonymous, private, page aligned memory obtained directly from mmap.
+    // pages are not touched by the mapping so numa policy can be applied
+    // before first use.  when huge pages are requested the mapping falls back 
+    // from explicit huge pages to transparent huge pages to normal pages
+    // and get_page_type() reports which one was obtained.
+    class page_mapping
+    {
+    public:
+
+        page_mapping() = default;
+
+        page_mapping
+        (
+            std::size_t,
+            page_type = page_type::normal
+        );
+
+        page_mapping
+        (
+            page_mapping &&
+        );
+
+        page_mapping & operator =
+        (
+            page_mapping &&
+        );
+
+        ~page_mapping();
+
+        void * data() const;
+
+        std::size_t size() const;
+
+        std::size_t get_page_size() const;
+
+        page_type get_page_type() const;
+
+        // apply numa preference to every page wholly contained in [offset, offset + length).
+        // pages that straddle the range boundaries are left unchanged.
+        bool bind_to_numa_node
+        (
+            std::size_t,
+            std::size_t,
+            numa_node_id
+        );
+
+        // number of pages within [offset, offset + length) which reside on the numa node
+        std::size_t count_pages_on_numa_node
+        (
+            std::size_t,
+            std::size_t,
+            numa_node_id
+        ) const;
+
+    private:
+
+        page_mapping(page_mapping const &) = delete;
+        page_mapping & operator = (page_mapping const &) = delete;
+
+        void release();
+
+        void *          address_{nullptr};
+        std::size_t     size_{0};
+        std::size_t     pageSize_{0};
+        page_type       pageType_{page_type::normal};
+    };
+
+} // namespace maniscalco::system
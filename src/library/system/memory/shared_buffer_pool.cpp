@@ -0,0 +1,337 @@
+#include "./shared_buffer_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <vector>
+
+
+namespace
+{
+
+    // buffers released for another thread are handed back in batches of this many
+    static auto constexpr batch_size = 32;
+
+    // number of other threads a thread batches buffers for at once
+    static auto constexpr batch_slots = 4;
+
+    // distinguishes a pool from an earlier one which occupied the same address
+    std::atomic<std::uint64_t> nextGeneration{1};
+
+} // namespace
+
+
+//=============================================================================
+struct maniscalco::system::shared_buffer_pool::thread_cache
+{
+    struct batch
+    {
+        thread_cache *  owner_{nullptr};
+        header *        head_{nullptr};
+        header *        tail_{nullptr};
+        std::size_t     count_{0};
+    };
+
+    thread_cache(state * owner):state_(owner){}
+
+    void give_back
+    (
+        header *
+    );
+
+    void flush
+    (
+        batch &
+    );
+
+    void flush_all();
+
+    state *                             state_;
+
+    header *                            freeList_{nullptr};     // attached thread only
+
+    std::array<batch, batch_slots>      batches_;               // attached thread only
+
+    std::size_t                         nextBatch_{0};
+
+    std::atomic<bool>                   attached_{true};
+
+    alignas(64) std::atomic<header *>   remoteFreeList_{nullptr};
+};
+
+
+//=============================================================================
+struct maniscalco::system::shared_buffer_pool::state :
+    std::enable_shared_from_this<state>
+{
+    state
+    (
+        configuration const & config
+    ):
+        bufferSize_(config.bufferSize_),
+        stride_(sizeof(header) + (((config.bufferSize_ + alignment - 1) / alignment) * alignment)),
+        buffersPerSlab_(std::max<std::size_t>(config.buffersPerSlab_, 1)),
+        pageType_(config.pageType_),
+        generation_(nextGeneration.fetch_add(1, std::memory_order_relaxed))
+    {
+    }
+
+    thread_cache * attach();
+
+    void add_slab
+    (
+        thread_cache &
+    );
+
+    std::size_t                 bufferSize_;
+    std::size_t                 stride_;
+    std::size_t                 buffersPerSlab_;
+    page_type                   pageType_;
+    std::uint64_t               generation_;
+    std::mutex                  mutex_;                 // slabs and caches (warm up only)
+    std::vector<page_mapping>   slabs_;
+    std::deque<thread_cache>    caches_;
+    std::atomic<std::size_t>    capacity_{0};
+};
+
+
+namespace
+{
+
+    // the calling thread's cache for each pool it has used.  the registry does not keep a
+    // pool's state alive.  entries of destroyed pools are dropped when the thread next attaches
+    // to a pool and are skipped when the thread detaches from its caches at exit.
+    template <typename S, typename C>
+    struct thread_cache_registry
+    {
+        struct entry
+        {
+            std::weak_ptr<S>    state_;
+            std::uint64_t       generation_;
+            C *                 cache_;
+        };
+
+        ~thread_cache_registry()
+        {
+            for (auto & entry : entries_)
+            {
+                // held while detaching so that the pool can not be destroyed meanwhile
+                if (auto state = entry.state_.lock(); state != nullptr)
+                {
+                    entry.cache_->flush_all();
+                    entry.cache_->attached_.store(false, std::memory_order_release);
+                }
+            }
+        }
+
+        std::vector<entry>  entries_;
+        S *                 lastState_{nullptr};
+        std::uint64_t       lastGeneration_{0};
+        C *                 lastCache_{nullptr};
+    };
+
+} // namespace
+
+
+//=============================================================================
+auto maniscalco::system::shared_buffer_pool::state::attach
+(
+) -> thread_cache *
+{
+    std::lock_guard lockGuard(mutex_);
+    for (auto & cache : caches_)
+    {
+        // adopt the cache of a thread which has exited, free list and all
+        if (auto expected = false; cache.attached_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return &cache;
+    }
+    return &caches_.emplace_back(this);
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_buffer_pool::state::add_slab
+(
+    thread_cache & cache
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    auto & slab = slabs_.emplace_back(buffersPerSlab_ * stride_, pageType_);
+    auto count = (slab.size() / stride_);
+    auto base = static_cast<std::byte *>(slab.data());
+    for (auto i = count; i-- > 0; )
+        cache.freeList_ = new (base + (i * stride_)) header{{0}, 0, static_cast<std::uint32_t>(bufferSize_), &cache, cache.freeList_};
+    capacity_ += count;
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_buffer_pool::thread_cache::give_back
+(
+    header * buffer
+)
+{
+    auto owner = buffer->owner_;
+    auto target = std::find_if(batches_.begin(), batches_.end(), [owner](auto const & batch){return (batch.owner_ == owner);});
+    if (target == batches_.end())
+    {
+        target = batches_.begin() + (nextBatch_++ % batch_slots);
+        flush(*target);
+        target->owner_ = owner;
+    }
+    buffer->next_ = target->head_;
+    if (target->head_ == nullptr)
+        target->tail_ = buffer;
+    target->head_ = buffer;
+    if (++target->count_ == batch_size)
+        flush(*target);
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_buffer_pool::thread_cache::flush
+(
+    batch & target
+)
+{
+    if (target.count_ == 0)
+        return;
+    auto & remoteFreeList = target.owner_->remoteFreeList_;
+    target.tail_->next_ = remoteFreeList.load(std::memory_order_relaxed);
+    while (!remoteFreeList.compare_exchange_weak(target.tail_->next_, target.head_, std::memory_order_release, std::memory_order_relaxed))
+        ;
+    target.head_ = target.tail_ = nullptr;
+    target.count_ = 0;
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_buffer_pool::thread_cache::flush_all
+(
+)
+{
+    for (auto & batch : batches_)
+        flush(batch);
+}
+
+
+//=============================================================================
+namespace
+{
+
+    template <typename S, typename C>
+    C & get_thread_cache
+    (
+        S & poolState
+    )
+    {
+        thread_local thread_cache_registry<S, C> registry;
+        if ((registry.lastState_ == &poolState) && (registry.lastGeneration_ == poolState.generation_))
+            return *registry.lastCache_;
+        auto iter = std::find_if(registry.entries_.begin(), registry.entries_.end(), 
+                [&](auto const & entry){return (entry.generation_ == poolState.generation_);});
+        if (iter == registry.entries_.end())
+        {
+            // first use of this pool by this thread.  forget the pools which have been destroyed.
+            std::erase_if(registry.entries_, [](auto const & entry){return entry.state_.expired();});
+            registry.entries_.push_back({poolState.weak_from_this(), poolState.generation_, poolState.attach()});
+            iter = registry.entries_.end() - 1;
+        }
+        registry.lastState_ = &poolState;
+        registry.lastGeneration_ = poolState.generation_;
+        registry.lastCache_ = iter->cache_;
+        return *iter->cache_;
+    }
+
+} // namespace
+
+
+//=============================================================================
+maniscalco::system::shared_buffer_pool::shared_buffer_pool
+(
+    configuration const & config
+):
+    state_(std::make_shared<state>(config))
+{
+}
+
+
+//=============================================================================
+maniscalco::system::shared_buffer_pool::~shared_buffer_pool
+(
+)
+{
+}
+
+
+//=============================================================================
+auto maniscalco::system::shared_buffer_pool::allocate
+(
+) -> shared_buffer
+{
+    auto & cache = get_thread_cache<state, thread_cache>(*state_);
+    if (cache.freeList_ == nullptr)
+    {
+        cache.freeList_ = cache.remoteFreeList_.exchange(nullptr, std::memory_order_acquire);
+        if (cache.freeList_ == nullptr)
+            state_->add_slab(cache);
+    }
+    auto buffer = cache.freeList_;
+    cache.freeList_ = buffer->next_;
+    buffer->referenceCount_.store(1, std::memory_order_relaxed);
+    buffer->size_ = 0;
+    return shared_buffer(buffer);
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_buffer_pool::release
+(
+    header * buffer
+)
+{
+    // a sole reference needs no atomic decrement: no other handle exists to race with
+    if ((buffer->referenceCount_.load(std::memory_order_acquire) != 1) &&
+            (buffer->referenceCount_.fetch_sub(1, std::memory_order_acq_rel) != 1))
+        return;
+    auto owner = buffer->owner_;
+    auto & cache = get_thread_cache<state, thread_cache>(*owner->state_);
+    if (&cache == owner)
+    {
+        buffer->next_ = cache.freeList_;
+        cache.freeList_ = buffer;
+    }
+    else
+    {
+        cache.give_back(buffer);
+    }
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_buffer_pool::flush
+(
+)
+{
+    get_thread_cache<state, thread_cache>(*state_).flush_all();
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::shared_buffer_pool::get_buffer_size
+(
+) const
+{
+    return state_->bufferSize_;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::shared_buffer_pool::get_capacity
+(
+) const
+{
+    return state_->capacity_.load(std::memory_order_relaxed);
+}
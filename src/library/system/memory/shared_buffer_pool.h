@@ -0,0 +1,143 @@
+#pragma once
+
+#include "./page_mapping.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+
+
+namespace maniscalco::system
+{
+
+    class shared_buffer;
+
+
+    // pool of fixed size, cache aligned, reference counted buffers for passing data
+    // between threads without copying it.  any thread may allocate.  each thread has its
+    // own cache of free buffers (carved from slabs which that cache owns) so allocation
+    // and release by the owning thread are plain pointer operations.  a buffer released
+    // by another thread is collected into a per thread batch for its owner and the whole
+    // batch is handed back with a single compare and swap.  the owner reclaims everything
+    // handed back with one exchange once its own free list runs dry.
+    //
+    // after warm up (once every thread has its cache and the slabs cover the peak number
+    // of buffers in flight) neither allocation nor release touch the heap or take a lock.
+    //
+    // caches of threads which exit are adopted by new threads.  threads do not keep a pool
+    // alive: its slabs are freed when it is destroyed.  buffers must be released before
+    // their pool is destroyed.
+    class shared_buffer_pool
+    {
+    public:
+
+        static auto constexpr alignment = 64;
+
+        struct configuration
+        {
+            std::size_t bufferSize_;
+            std::size_t buffersPerSlab_{256};
+            page_type   pageType_{page_type::normal};
+        };
+
+        shared_buffer_pool
+        (
+            configuration const &
+        );
+
+        ~shared_buffer_pool();
+
+        shared_buffer_pool(shared_buffer_pool const &) = delete;
+        shared_buffer_pool & operator = (shared_buffer_pool const &) = delete;
+
+        shared_buffer allocate();
+
+        // hand back the calling thread's partial batches of buffers owned by other threads
+        void flush();
+
+        std::size_t get_buffer_size() const;
+
+        // number of buffers in all slabs
+        std::size_t get_capacity() const;
+
+    private:
+
+        friend class shared_buffer;
+
+        struct state;
+
+        struct thread_cache;
+
+        struct alignas(alignment) header
+        {
+            std::atomic<std::uint32_t>  referenceCount_;
+            std::uint32_t               size_;
+            std::uint32_t               capacity_;
+            thread_cache *              owner_;
+            header *                    next_;
+        };
+
+        static void release
+        (
+            header *
+        );
+
+        std::shared_ptr<state>  state_;
+
+    }; // class shared_buffer_pool
+
+
+    // a reference to a pooled buffer.  moving a handle is free.  copying a handle shares
+    // the buffer (an atomic increment) and the buffer returns to its pool when the last
+    // handle is destroyed.  a handle which is the only reference releases the buffer
+    // without an atomic read-modify-write.
+    class shared_buffer
+    {
+    public:
+
+        shared_buffer() = default;
+
+        shared_buffer(shared_buffer const & other):header_(other.header_){if (header_ != nullptr) header_->referenceCount_.fetch_add(1, std::memory_order_relaxed);}
+
+        shared_buffer(shared_buffer && other) noexcept:header_(std::exchange(other.header_, nullptr)){}
+
+        shared_buffer & operator = (shared_buffer const & other){if (this != &other) shared_buffer(other).swap(*this); return *this;}
+
+        shared_buffer & operator = (shared_buffer && other) noexcept{shared_buffer(std::move(other)).swap(*this); return *this;}
+
+        ~shared_buffer(){reset();}
+
+        void reset(){if (header_ != nullptr) shared_buffer_pool::release(std::exchange(header_, nullptr));}
+
+        void swap(shared_buffer & other) noexcept{std::swap(header_, other.header_);}
+
+        std::byte * data() const{return reinterpret_cast<std::byte *>(header_ + 1);}
+
+        // bytes in use, as set by resize().  shared by every handle to the buffer.
+        std::size_t size() const{return header_->size_;}
+
+        // size must not exceed capacity()
+        void resize(std::size_t size){header_->size_ = static_cast<std::uint32_t>(size);}
+
+        std::size_t capacity() const{return header_->capacity_;}
+
+        std::span<std::byte> get_span() const{return {data(), size()};}
+
+        std::uint32_t use_count() const{return (header_ == nullptr) ? 0 : header_->referenceCount_.load(std::memory_order_relaxed);}
+
+        explicit operator bool() const{return (header_ != nullptr);}
+
+    private:
+
+        friend class shared_buffer_pool;
+
+        explicit shared_buffer(shared_buffer_pool::header * header):header_(header){}
+
+        shared_buffer_pool::header *    header_{nullptr};
+
+    }; // class shared_buffer
+
+} // namespace maniscalco::system
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./parallel/parallel_executor.h"
@@ -0,0 +1,470 @@
+#pragma once
+
+#include <library/system/work_contract/work_contract_group.h>
+#include <library/system/work_contract/work_contract.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // data parallel algorithms executed by a fixed set of contracts in an existing
+    // work_contract_group (whose workers are typically a thread_pool).  each call invokes
+    // every contract once and the calling thread participates as well.  participants claim
+    // contiguous chunks of the index range from a shared cursor with guided (decreasing)
+    // chunk sizes: large chunks first for locality and low contention, smaller ones at the
+    // end to balance the load.  no contracts are created or surrendered per call.
+    //
+    // calls are serialized.  an algorithm must not be called from within the body of
+    // another algorithm of the same executor.  exceptions thrown by a body cancel the
+    // remaining chunks and the first is rethrown to the caller.
+    //
+    // destruction waits for the surrender of the executor's contracts to execute and helps
+    // execute the group's contracts meanwhile, so it completes even once the group's workers
+    // have stopped.
+    template <work_contract_mode T>
+    class parallel_executor
+    {
+    public:
+
+        using work_contract_group_type = work_contract_group<T>;
+
+        parallel_executor
+        (
+            work_contract_group_type &,
+            std::size_t                 // number of contracts (typically the number of workers servicing the group)
+        );
+
+        ~parallel_executor();
+
+        parallel_executor(parallel_executor const &) = delete;
+        parallel_executor & operator = (parallel_executor const &) = delete;
+
+        // maximum number of threads participating in a call (contracts plus the caller)
+        std::size_t get_concurrency() const;
+
+        // function(i) for each i in [begin, end)
+        template <typename F>
+        void parallel_for
+        (
+            std::size_t,
+            std::size_t,
+            F &&,
+            std::size_t = 1                 // minimum chunk size
+        );
+
+        // function(begin, end) for disjoint sub ranges covering [begin, end)
+        template <typename F>
+        void parallel_for_range
+        (
+            std::size_t,
+            std::size_t,
+            F &&,
+            std::size_t = 1
+        );
+
+        // combine(..., map(i)) over [begin, end).  combine must be associative and commutative.
+        template <typename V, typename M, typename C>
+        V parallel_reduce
+        (
+            std::size_t,
+            std::size_t,
+            V,                              // identity
+            M &&,                           // map
+            C &&,                           // combine
+            std::size_t = 1
+        );
+
+        // *(output + n) = function(*(first + n))
+        template <std::random_access_iterator I, std::random_access_iterator O, typename F>
+        O parallel_transform
+        (
+            I,
+            I,
+            O,
+            F &&,
+            std::size_t = 1
+        );
+
+        // stable merge sort.  runs are sorted in parallel then merged level by level
+        // with each merge split across participants by merge path partitioning.
+        template <std::random_access_iterator I, typename C = std::less<>>
+        void parallel_sort
+        (
+            I,
+            I,
+            C = C{}
+        );
+
+    private:
+
+        struct job
+        {
+            void        (*run_)(void *, std::size_t, std::size_t, std::size_t);     // (body, slot, begin, end)
+            void *      body_;
+            std::size_t end_;
+            std::size_t minChunk_;
+        };
+
+        template <typename F>
+        void execute
+        (
+            std::size_t,
+            std::size_t,
+            std::size_t,
+            F &&                            // function(slot, begin, end)
+        );
+
+        void participate
+        (
+            std::size_t
+        );
+
+        bool claim
+        (
+            job const &,
+            std::size_t &,
+            std::size_t &
+        );
+
+        work_contract_group_type &              workContractGroup_;
+
+        std::vector<work_contract<T>>           contracts_;
+
+        std::mutex                              mutex_;
+
+        std::exception_ptr                      exception_;
+
+        std::atomic<bool>                       failed_{false};
+
+        std::atomic<job *>                      job_{nullptr};
+
+        alignas(64) std::atomic<std::size_t>    next_{0};
+
+        alignas(64) std::atomic<std::size_t>    activeParticipants_{0};
+
+        std::atomic<std::size_t>                surrenderedCount_{0};
+
+    }; // class parallel_executor
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::parallel_executor<T>::parallel_executor
+(
+    work_contract_group_type & workContractGroup,
+    std::size_t contractCount
+):
+    workContractGroup_(workContractGroup)
+{
+    for (std::size_t slot = 0; slot < contractCount; ++slot)
+    {
+        contracts_.push_back(workContractGroup_.create_contract([this, slot](){participate(slot);},
+                [this](){surrenderedCount_.fetch_add(1, std::memory_order_release);}));
+        if (!contracts_.back().is_valid())
+            throw std::runtime_error("parallel_executor: work_contract_group has no free contracts");
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::parallel_executor<T>::~parallel_executor
+(
+)
+{
+    // a contract invoked by the last call might not have started yet.  once its surrender
+    // has executed it can not be executing.  a contract of a stopped group is not surrendered.
+    std::size_t surrenderCount = 0;
+    for (auto & contract : contracts_)
+        surrenderCount += contract.surrender();
+    while (surrenderedCount_.load(std::memory_order_acquire) < surrenderCount)
+    {
+        workContractGroup_.try_execute_next_contract();
+        std::this_thread::yield();
+    }
+    while (activeParticipants_.load() > 0)
+        std::this_thread::yield();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::size_t maniscalco::system::parallel_executor<T>::get_concurrency
+(
+) const
+{
+    return (contracts_.size() + 1);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline bool maniscalco::system::parallel_executor<T>::claim
+(
+    job const & currentJob,
+    std::size_t & begin,
+    std::size_t & end
+)
+{
+    // guided self scheduling: each claim takes a share of what remains
+    auto participants = get_concurrency();
+    begin = next_.load(std::memory_order_relaxed);
+    while (begin < currentJob.end_)
+    {
+        auto chunk = std::max(currentJob.minChunk_, (currentJob.end_ - begin) / (participants * 2));
+        end = std::min(begin + chunk, currentJob.end_);
+        if (next_.compare_exchange_weak(begin, end, std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::parallel_executor<T>::participate
+(
+    std::size_t slot
+)
+{
+    ++activeParticipants_;
+    // a contract which runs late (after its job completed) finds no job, or the next job
+    if (auto currentJob = job_.load(); currentJob != nullptr)
+    {
+        std::size_t begin;
+        std::size_t end;
+        while ((!failed_.load(std::memory_order_relaxed)) && (claim(*currentJob, begin, end)))
+        {
+            try
+            {
+                currentJob->run_(currentJob->body_, slot, begin, end);
+            }
+            catch (...)
+            {
+                // the caller reads exception_ only after every participant has left
+                if (!failed_.exchange(true))
+                    exception_ = std::current_exception();
+            }
+        }
+    }
+    --activeParticipants_;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <typename F>
+inline void maniscalco::system::parallel_executor<T>::execute
+(
+    std::size_t begin,
+    std::size_t end,
+    std::size_t minChunk,
+    F && function
+)
+{
+    if (begin >= end)
+        return;
+
+    static auto constexpr run = [](void * body, std::size_t slot, std::size_t begin, std::size_t end)
+            {
+                (*static_cast<std::remove_reference_t<F> *>(body))(slot, begin, end);
+            };
+
+    std::lock_guard lockGuard(mutex_);
+    job currentJob{.run_ = run, .body_ = &function, .end_ = end, .minChunk_ = std::max<std::size_t>(minChunk, 1)};
+    exception_ = nullptr;
+    failed_ = false;
+    next_ = begin;
+    job_ = &currentJob;
+
+    // only invoke as many contracts as there are chunks to go around
+    auto contractCount = std::min(contracts_.size(), ((end - begin) + currentJob.minChunk_ - 1) / currentJob.minChunk_ - 1);
+    for (std::size_t i = 0; i < contractCount; ++i)
+        contracts_[i].invoke();
+    participate(contracts_.size());
+
+    // retire the job and wait for any participant still holding it
+    job_ = nullptr;
+    while (activeParticipants_.load() > 0)
+        std::this_thread::yield();
+    if (exception_)
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <typename F>
+inline void maniscalco::system::parallel_executor<T>::parallel_for_range
+(
+    std::size_t begin,
+    std::size_t end,
+    F && function,
+    std::size_t minChunk
+)
+{
+    execute(begin, end, minChunk, [&](std::size_t, std::size_t begin, std::size_t end){function(begin, end);});
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <typename F>
+inline void maniscalco::system::parallel_executor<T>::parallel_for
+(
+    std::size_t begin,
+    std::size_t end,
+    F && function,
+    std::size_t minChunk
+)
+{
+    execute(begin, end, minChunk, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (auto i = begin; i < end; ++i)
+                    function(i);
+            });
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <typename V, typename M, typename C>
+inline V maniscalco::system::parallel_executor<T>::parallel_reduce
+(
+    std::size_t begin,
+    std::size_t end,
+    V identity,
+    M && map,
+    C && combine,
+    std::size_t minChunk
+)
+{
+    // one partial result per participant, each on its own cache line
+    struct alignas(64) partial
+    {
+        V value_;
+    };
+    std::vector<partial> partials(get_concurrency(), partial{identity});
+    execute(begin, end, minChunk, [&](std::size_t slot, std::size_t begin, std::size_t end)
+            {
+                auto value = partials[slot].value_;
+                for (auto i = begin; i < end; ++i)
+                    value = combine(value, map(i));
+                partials[slot].value_ = value;
+            });
+    auto result = identity;
+    for (auto const & partial : partials)
+        result = combine(result, partial.value_);
+    return result;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <std::random_access_iterator I, std::random_access_iterator O, typename F>
+inline O maniscalco::system::parallel_executor<T>::parallel_transform
+(
+    I first,
+    I last,
+    O output,
+    F && function,
+    std::size_t minChunk
+)
+{
+    std::size_t size = std::distance(first, last);
+    execute(0, size, minChunk, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                std::transform(first + begin, first + end, output + begin, function);
+            });
+    return (output + size);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <std::random_access_iterator I, typename C>
+inline void maniscalco::system::parallel_executor<T>::parallel_sort
+(
+    I first,
+    I last,
+    C compare
+)
+{
+    using value_type = typename std::iterator_traits<I>::value_type;
+    static auto constexpr min_run_size = 4096;
+
+    std::size_t size = std::distance(first, last);
+    std::size_t runCount = std::min(std::bit_ceil(get_concurrency()), std::bit_floor(std::max<std::size_t>(size / min_run_size, 1)));
+    if (runCount <= 1)
+        return std::stable_sort(first, last, compare);
+    auto runSize = (size + runCount - 1) / runCount;
+
+    std::vector<value_type> source(std::make_move_iterator(first), std::make_move_iterator(last));
+    std::vector<value_type> destination(size);
+    parallel_for(0, runCount, [&](std::size_t run)
+            {
+                std::stable_sort(source.begin() + std::min(run * runSize, size), source.begin() + std::min((run + 1) * runSize, size), compare);
+            });
+
+    // merge pairs of runs.  each merge is cut into pieces at evenly spaced output positions
+    // and the position in each input is found by binary search (merge path) so that every
+    // level, including the last single merge, is spread across all participants.
+    for (auto width = runSize; width < size; width *= 2)
+    {
+        auto pairSize = (width * 2);
+        auto pairCount = (size + pairSize - 1) / pairSize;
+        auto piecesPerPair = std::max<std::size_t>(1, (get_concurrency() * 2) / pairCount);
+        parallel_for(0, pairCount * piecesPerPair, [&](std::size_t piece)
+                {
+                    auto pairBegin = (piece / piecesPerPair) * pairSize;
+                    auto a = source.begin() + pairBegin;
+                    auto sizeA = std::min(width, size - pairBegin);
+                    auto b = a + sizeA;
+                    auto sizeB = std::min(pairSize, size - pairBegin) - sizeA;
+                    auto co_rank = [&](std::size_t k)
+                            {
+                                // number of elements taken from a among the first k of the stable merge
+                                auto low = (k > sizeB) ? (k - sizeB) : 0;
+                                auto high = std::min(k, sizeA);
+                                while (low < high)
+                                {
+                                    auto i = (low + high) / 2;
+                                    if (!compare(b[k - i - 1], a[i]))
+                                        low = i + 1;
+                                    else
+                                        high = i;
+                                }
+                                return low;
+                            };
+                    auto part = (piece % piecesPerPair);
+                    auto k0 = ((sizeA + sizeB) * part) / piecesPerPair;
+                    auto k1 = ((sizeA + sizeB) * (part + 1)) / piecesPerPair;
+                    auto i0 = co_rank(k0);
+                    auto i1 = co_rank(k1);
+                    std::merge(std::make_move_iterator(a + i0), std::make_move_iterator(a + i1),
+                            std::make_move_iterator(b + (k0 - i0)), std::make_move_iterator(b + (k1 - i1)),
+                            destination.begin() + pairBegin + k0, compare);
+                });
+        std::swap(source, destination);
+    }
+
+    parallel_for_range(0, size, [&](std::size_t begin, std::size_t end)
+            {
+                std::move(source.begin() + begin, source.begin() + end, first + begin);
+            }, min_run_size);
+}
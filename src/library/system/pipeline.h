@@ -0,0 +1,4 @@
+#pragma once
+
+#include "./pipeline/bounded_ring.h"
+#include "./pipeline/pipeline.h"
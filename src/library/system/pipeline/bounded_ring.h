@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+
+namespace maniscalco::system
+{
+
+    // bounded ring buffer (Vyukov's cell sequence design).  each side is either single
+    // threaded, in which case claiming a position is a plain store, or shared, in which case
+    // it is claimed with a compare and swap.  so the same type serves as an spsc, mpsc, spmc
+    // or mpmc ring.  pop() also reports the position of the element which is unique and
+    // increasing in push order, so consumers can restore ordering downstream.
+    template <typename T>
+    class bounded_ring
+    {
+    public:
+
+        struct configuration
+        {
+            std::size_t capacity_;              // rounded up to a power of two
+            bool        singleProducer_{false};
+            bool        singleConsumer_{false};
+        };
+
+        bounded_ring
+        (
+            configuration const &
+        );
+
+        ~bounded_ring();
+
+        bounded_ring(bounded_ring const &) = delete;
+        bounded_ring & operator = (bounded_ring const &) = delete;
+
+        // false if full
+        template <typename ... A>
+        bool try_emplace
+        (
+            A && ...
+        );
+
+        bool try_push(T && value){return try_emplace(std::move(value));}
+
+        // nullopt if empty
+        std::optional<T> try_pop
+        (
+            std::uint64_t * = nullptr      // position of the popped element
+        );
+
+        // approximate while other threads push or pop
+        std::size_t size() const;
+
+        bool empty() const{return (size() == 0);}
+
+        bool full() const{return (size() >= get_capacity());}
+
+        std::size_t get_capacity() const{return (mask_ + 1);}
+
+        // the position that the next pop will claim
+        std::uint64_t get_read_position() const{return readPosition_.load(std::memory_order_acquire);}
+
+    private:
+
+        struct cell
+        {
+            std::atomic<std::uint64_t>              sequence_;
+            alignas(T) std::byte                    storage_[sizeof(T)];
+        };
+
+        std::uint64_t                               mask_;
+
+        std::unique_ptr<cell[]>                     cells_;
+
+        bool                                        singleProducer_;
+
+        bool                                        singleConsumer_;
+
+        alignas(64) std::atomic<std::uint64_t>      writePosition_{0};
+
+        alignas(64) std::atomic<std::uint64_t>      readPosition_{0};
+
+    }; // class bounded_ring
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <typename T>
+inline maniscalco::system::bounded_ring<T>::bounded_ring
+(
+    configuration const & config
+):
+    mask_(std::bit_ceil(std::max<std::size_t>(config.capacity_, 2)) - 1),
+    cells_(std::make_unique<cell[]>(mask_ + 1)),
+    singleProducer_(config.singleProducer_),
+    singleConsumer_(config.singleConsumer_)
+{
+    for (std::uint64_t i = 0; i <= mask_; ++i)
+        cells_[i].sequence_.store(i, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+template <typename T>
+inline maniscalco::system::bounded_ring<T>::~bounded_ring
+(
+)
+{
+    while (try_pop())
+        ;
+}
+
+
+//=============================================================================
+template <typename T>
+template <typename ... A>
+inline bool maniscalco::system::bounded_ring<T>::try_emplace
+(
+    A && ... args
+)
+{
+    auto position = writePosition_.load(std::memory_order_relaxed);
+    cell * target;
+    while (true)
+    {
+        target = &cells_[position & mask_];
+        auto sequence = target->sequence_.load(std::memory_order_acquire);
+        auto difference = static_cast<std::int64_t>(sequence - position);
+        if (difference < 0)
+            return false; // full
+        if (difference == 0)
+        {
+            if (singleProducer_)
+            {
+                writePosition_.store(position + 1, std::memory_order_relaxed);
+                break;
+            }
+            if (writePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else
+        {
+            position = writePosition_.load(std::memory_order_relaxed);
+        }
+    }
+    new (target->storage_) T(std::forward<A>(args) ...);
+    target->sequence_.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto maniscalco::system::bounded_ring<T>::try_pop
+(
+    std::uint64_t * positionOut
+) -> std::optional<T>
+{
+    auto position = readPosition_.load(std::memory_order_relaxed);
+    cell * source;
+    while (true)
+    {
+        source = &cells_[position & mask_];
+        auto sequence = source->sequence_.load(std::memory_order_acquire);
+        auto difference = static_cast<std::int64_t>(sequence - (position + 1));
+        if (difference < 0)
+            return std::nullopt; // empty
+        if (difference == 0)
+        {
+            if (singleConsumer_)
+            {
+                readPosition_.store(position + 1, std::memory_order_relaxed);
+                break;
+            }
+            if (readPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else
+        {
+            position = readPosition_.load(std::memory_order_relaxed);
+        }
+    }
+    auto element = std::launder(reinterpret_cast<T *>(source->storage_));
+    std::optional<T> result(std::move(*element));
+    std::destroy_at(element);
+    source->sequence_.store(position + mask_ + 1, std::memory_order_release);
+    if (positionOut != nullptr)
+        *positionOut = position;
+    return result;
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t maniscalco::system::bounded_ring<T>::size
+(
+) const
+{
+    auto readPosition = readPosition_.load(std::memory_order_acquire);
+    auto writePosition = writePosition_.load(std::memory_order_acquire);
+    return (writePosition > readPosition) ? (writePosition - readPosition) : 0;
+}
@@ -0,0 +1,582 @@
+#pragma once
+
+#include "./bounded_ring.h"
+#include <library/system/work_contract/work_contract_group.h>
+#include <library/system/work_contract/work_contract.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    struct pipeline_stage_configuration
+    {
+        std::size_t parallelism_{1};    // number of contracts executing the stage
+        std::size_t capacity_{1024};    // of the ring in front of the stage
+        std::size_t batchSize_{64};     // items handled per contract execution
+        bool        ordered_{false};    // preserve input order in the output when parallelism_ > 1
+    };
+
+
+    struct pipeline_stage_statistics
+    {
+        std::string name_;
+        std::size_t processed_;         // items taken from the input ring
+        std::size_t queued_;            // occupancy of the input ring
+        std::size_t capacity_;
+        std::size_t blocked_;           // times the stage stopped because the next ring was full
+    };
+
+
+    namespace detail
+    {
+
+        template <work_contract_mode T>
+        class pipeline_stage_base
+        {
+        public:
+
+            pipeline_stage_base
+            (
+                std::string name,
+                pipeline_stage_configuration const & config
+            ):
+                name_(std::move(name)),
+                parallelism_(std::max<std::size_t>(config.parallelism_, 1)),
+                batchSize_(std::max<std::size_t>(config.batchSize_, 1)),
+                contracts_(parallelism_)
+            {
+            }
+
+            virtual ~pipeline_stage_base() = default;
+
+            // invoke every contract of the stage.  used when the next ring has room again.
+            void resume()
+            {
+                for (auto & contract : contracts_)
+                    contract.invoke();
+            }
+
+            virtual pipeline_stage_statistics get_statistics() const = 0;
+
+            virtual bool is_idle() const = 0;
+
+        protected:
+
+            std::string                     name_;
+
+            std::size_t                     parallelism_;
+
+            std::size_t                     batchSize_;
+
+            std::vector<work_contract<T>>   contracts_;
+        };
+
+
+        // the input side of a stage: its ring and how producers notify it
+        template <work_contract_mode T, typename I>
+        class pipeline_stage_input :
+            public pipeline_stage_base<T>
+        {
+        public:
+
+            pipeline_stage_input
+            (
+                std::string name,
+                pipeline_stage_configuration const & config,
+                bool singleProducer,
+                pipeline_stage_base<T> * upstream
+            ):
+                pipeline_stage_base<T>(std::move(name), config),
+                input_({.capacity_ = config.capacity_, .singleProducer_ = singleProducer, .singleConsumer_ = (this->parallelism_ == 1)}),
+                upstream_(upstream)
+            {
+            }
+
+            // push from a producer.  false if the ring is full.
+            template <typename V>
+            bool try_push
+            (
+                V && value,
+                std::size_t hint
+            )
+            {
+                if (!input_.try_emplace(std::forward<V>(value)))
+                    return false;
+                this->contracts_[hint % this->parallelism_].invoke();
+                return true;
+            }
+
+            // a producer found the ring full.  announce it and check again so that a consumer
+            // which has just made room cannot miss the announcement.
+            void set_producer_blocked()
+            {
+                producerBlocked_.store(true, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+
+        protected:
+
+            // called after popping.  resumes a producer which stopped on a full ring.
+            void wake_upstream()
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if ((producerBlocked_.load(std::memory_order_relaxed)) && (producerBlocked_.exchange(false)) && (upstream_ != nullptr))
+                    upstream_->resume();
+            }
+
+            bounded_ring<I>                 input_;
+
+            pipeline_stage_base<T> *        upstream_;
+
+            std::atomic<bool>               producerBlocked_{false};
+        };
+
+
+        template <work_contract_mode T, typename I, typename O, typename F>
+        class pipeline_stage :
+            public pipeline_stage_input<T, I>
+        {
+        public:
+
+            static auto constexpr is_sink = std::is_void_v<O>;
+
+            using downstream_type = pipeline_stage_input<T, std::conditional_t<is_sink, I, O>>;
+
+            pipeline_stage
+            (
+                work_contract_group<T> & workContractGroup,
+                std::string name,
+                F function,
+                pipeline_stage_configuration const & config,
+                bool singleProducer,
+                pipeline_stage_base<T> * upstream
+            ):
+                pipeline_stage_input<T, I>(std::move(name), config, singleProducer, upstream),
+                function_(std::move(function)),
+                workers_(this->parallelism_)
+            {
+                if constexpr (!is_sink)
+                {
+                    if ((config.ordered_) && (this->parallelism_ > 1))
+                    {
+                        auto windowSize = this->input_.get_capacity();
+                        reorderMask_ = (windowSize - 1);
+                        reorder_ = std::make_unique<reorder_slot[]>(windowSize);
+                    }
+                }
+                for (std::size_t i = 0; i < this->parallelism_; ++i)
+                {
+                    this->contracts_[i] = workContractGroup.create_contract([this, i](){execute(i);});
+                    if (!this->contracts_[i].is_valid())
+                        throw std::runtime_error("pipeline: work_contract_group has no free contracts");
+                }
+            }
+
+            void set_downstream(downstream_type * downstream){downstream_ = downstream;}
+
+            pipeline_stage_statistics get_statistics() const override
+            {
+                pipeline_stage_statistics statistics{this->name_, 0, this->input_.size(), this->input_.get_capacity(), 0};
+                for (auto const & worker : workers_)
+                {
+                    statistics.processed_ += worker.processed_.load(std::memory_order_relaxed);
+                    statistics.blocked_ += worker.blocked_.load(std::memory_order_relaxed);
+                }
+                statistics.blocked_ += drainBlocked_.load(std::memory_order_relaxed);
+                return statistics;
+            }
+
+            bool is_idle() const override
+            {
+                if (!this->input_.empty())
+                    return false;
+                if constexpr (!is_sink)
+                {
+                    for (auto const & worker : workers_)
+                        if (worker.hasPending_.load(std::memory_order_acquire))
+                            return false;
+                    if ((reorder_) && (reorder_[nextToPublish_.load() & reorderMask_].ready_.load() != 0))
+                        return false;
+                }
+                return (busy_.load(std::memory_order_acquire) == 0);
+            }
+
+        private:
+
+            using output_type = std::conditional_t<is_sink, char, O>;
+
+            struct alignas(64) worker
+            {
+                std::optional<output_type>  pending_;       // output which did not fit downstream
+                std::atomic<bool>           hasPending_{false};
+                std::atomic<std::size_t>    processed_{0};
+                std::atomic<std::size_t>    blocked_{0};
+                std::size_t                 pushCount_{0};
+            };
+
+            struct reorder_slot
+            {
+                std::atomic<std::uint64_t>  ready_{0};      // position + 1 when value_ holds that output
+                std::optional<output_type>  value_;
+            };
+
+            // single writer counters
+            static void add(std::atomic<std::size_t> & counter, std::size_t value)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+
+            // push value downstream or leave it in place and mark this stage as blocked.
+            bool push_downstream
+            (
+                std::optional<output_type> & value,
+                std::size_t & pushCount,
+                std::atomic<std::size_t> & blocked,
+                bool singleWriter = true
+            )
+            {
+                for (auto announced = false; ; announced = true)
+                {
+                    if (downstream_->try_push(std::move(*value), pushCount++))
+                    {
+                        value.reset();
+                        return true;
+                    }
+                    if (announced)
+                    {
+                        if (singleWriter)
+                            add(blocked, 1);
+                        else
+                            blocked.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    downstream_->set_producer_blocked();
+                }
+            }
+
+            // publish completed outputs in input order.  false if blocked downstream.
+            bool drain()
+            {
+                while (true)
+                {
+                    if (draining_.exchange(true))
+                        return true; // the current drainer checks again before it stops
+                    auto published = false;
+                    auto blocked = false;
+                    while (true)
+                    {
+                        auto next = nextToPublish_.load(std::memory_order_relaxed);
+                        auto & slot = reorder_[next & reorderMask_];
+                        if (slot.ready_.load(std::memory_order_acquire) != (next + 1))
+                            break;
+                        if (!push_downstream(slot.value_, drainPushCount_, drainBlocked_, false))
+                        {
+                            blocked = true;
+                            break;
+                        }
+                        slot.ready_.store(0, std::memory_order_relaxed);
+                        nextToPublish_.store(next + 1, std::memory_order_seq_cst);
+                        published = true;
+                    }
+                    draining_.store(false, std::memory_order_seq_cst);
+                    if ((published) && (windowBlocked_.load()) && (windowBlocked_.exchange(false)))
+                        this->resume();
+                    if (blocked)
+                        return false;
+                    auto next = nextToPublish_.load();
+                    if (reorder_[next & reorderMask_].ready_.load() != (next + 1))
+                        return true;
+                }
+            }
+
+            // an ordered stage takes an item only while it is within the reorder window of the
+            // oldest unpublished item.  taken counts items popped plus pops in progress.
+            bool try_reserve()
+            {
+                auto taken = taken_.load();
+                do
+                {
+                    if (taken >= (nextToPublish_.load() + reorderMask_ + 1))
+                        return false;
+                } while (!taken_.compare_exchange_weak(taken, taken + 1));
+                return true;
+            }
+
+            void execute
+            (
+                std::size_t index
+            )
+            {
+                auto & current = workers_[index];
+                ++busy_;
+                auto stalled = false;
+                if constexpr (!is_sink)
+                {
+                    if (reorder_)
+                        stalled = !drain();
+                    else if (current.pending_)
+                        stalled = !push_downstream(current.pending_, current.pushCount_, current.blocked_);
+                    current.hasPending_.store(current.pending_.has_value(), std::memory_order_release);
+                }
+
+                std::size_t processed = 0;
+                while ((!stalled) && (processed < this->batchSize_))
+                {
+                    if constexpr (!is_sink)
+                    {
+                        if ((reorder_) && (!try_reserve()))
+                        {
+                            // wait for the oldest item.  the drainer resumes this stage.
+                            windowBlocked_.store(true);
+                            if (!try_reserve())
+                            {
+                                stalled = true;
+                                break;
+                            }
+                            windowBlocked_.store(false);
+                        }
+                    }
+                    std::uint64_t position;
+                    auto input = this->input_.try_pop(&position);
+                    if (!input)
+                    {
+                        if constexpr (!is_sink)
+                            if (reorder_)
+                                --taken_;
+                        break;
+                    }
+                    ++processed;
+                    if constexpr (is_sink)
+                    {
+                        function_(std::move(*input));
+                    }
+                    else if (reorder_)
+                    {
+                        auto & slot = reorder_[position & reorderMask_];
+                        slot.value_.emplace(function_(std::move(*input)));
+                        slot.ready_.store(position + 1, std::memory_order_seq_cst);
+                        stalled = !drain();
+                    }
+                    else
+                    {
+                        current.pending_.emplace(function_(std::move(*input)));
+                        stalled = !push_downstream(current.pending_, current.pushCount_, current.blocked_);
+                        current.hasPending_.store(current.pending_.has_value(), std::memory_order_release);
+                    }
+                }
+                if (processed > 0)
+                {
+                    add(current.processed_, processed);
+                    this->wake_upstream();
+                }
+                // more to do: execute again.  a stalled stage is not re-invoked until there is
+                // room downstream (or, for an ordered stage, until the oldest item completes).
+                if ((!stalled) && (!this->input_.empty()))
+                    this->contracts_[index].invoke();
+                --busy_;
+            }
+
+            F                                   function_;
+
+            std::vector<worker>                 workers_;
+
+            downstream_type *                   downstream_{nullptr};
+
+            std::atomic<std::size_t>            busy_{0};
+
+            // ordered stages with parallelism_ > 1
+            std::unique_ptr<reorder_slot[]>     reorder_;
+
+            std::uint64_t                       reorderMask_{0};
+
+            std::size_t                         drainPushCount_{0};
+
+            std::atomic<std::size_t>            drainBlocked_{0};
+
+            alignas(64) std::atomic<std::uint64_t>  nextToPublish_{0};
+
+            std::atomic<std::uint64_t>          taken_{0};
+
+            std::atomic<bool>                   draining_{false};
+
+            std::atomic<bool>                   windowBlocked_{false};
+        };
+
+    } // namespace detail
+
+
+    // a linear pipeline of stages.  each stage is driven by one or more work contracts of a
+    // group and is fed by a bounded ring: single producer and/or single consumer when the
+    // stages on either side have a parallelism of one, shared otherwise.  the last stage is a
+    // sink (its function returns void).
+    //
+    //      auto pipeline = make_pipeline<raw_message>(workContractGroup)
+    //              .add_stage("parse", [](raw_message && m){return parse(m);}, {.parallelism_ = 4, .ordered_ = true})
+    //              .add_stage("enrich", [](parsed_message && m){return enrich(m);})
+    //              .add_stage("publish", [](enriched_message && m){publish(m);})
+    //              .build();
+    //      while (!pipeline.try_push(next())) ...
+    //
+    // backpressure: a stage which cannot push its output because the next ring is full stops
+    // and is not invoked again until the next stage has made room, so a slow stage stalls the
+    // stages before it and finally try_push().
+    //
+    // the pipeline must be idle (or the group's workers stopped) when it is destroyed.
+    template <work_contract_mode T, typename I>
+    class pipeline
+    {
+    public:
+
+        pipeline(pipeline &&) = default;
+
+        // false if the first stage's ring is full
+        template <typename V>
+        bool try_push
+        (
+            V && value
+        )
+        {
+            return head_->try_push(std::forward<V>(value), pushCount_.fetch_add(1, std::memory_order_relaxed));
+        }
+
+        std::vector<pipeline_stage_statistics> get_statistics() const
+        {
+            std::vector<pipeline_stage_statistics> statistics;
+            for (auto const & stage : stages_)
+                statistics.push_back(stage->get_statistics());
+            return statistics;
+        }
+
+        // true when every ring is empty and no stage is executing or holding output
+        bool is_idle() const
+        {
+            for (auto const & stage : stages_)
+                if (!stage->is_idle())
+                    return false;
+            return true;
+        }
+
+    private:
+
+        template <work_contract_mode, typename, typename>
+        friend class pipeline_builder;
+
+        pipeline
+        (
+            std::vector<std::unique_ptr<detail::pipeline_stage_base<T>>> stages,
+            detail::pipeline_stage_input<T, I> * head
+        ):
+            stages_(std::move(stages)),
+            head_(head)
+        {
+        }
+
+        std::vector<std::unique_ptr<detail::pipeline_stage_base<T>>>    stages_;
+
+        detail::pipeline_stage_input<T, I> *                            head_;
+
+        std::atomic<std::size_t>                                        pushCount_{0};
+    };
+
+
+    template <work_contract_mode T, typename I, typename O>
+    class pipeline_builder
+    {
+    public:
+
+        using work_contract_group_type = work_contract_group<T>;
+
+        pipeline_builder
+        (
+            work_contract_group_type & workContractGroup
+        ):
+            workContractGroup_(&workContractGroup)
+        {
+        }
+
+        // function(O &&) -> next output type, or void for the final stage
+        template <typename F>
+        auto add_stage
+        (
+            std::string name,
+            F function,
+            pipeline_stage_configuration const & config = {}
+        ) &&
+        {
+            static_assert(!std::is_void_v<O>, "pipeline: no stages may follow a sink");
+            using output_type = std::invoke_result_t<F &, O &&>;
+            using stage_type = detail::pipeline_stage<T, O, output_type, F>;
+
+            auto upstream = stages_.empty() ? nullptr : stages_.back().get();
+            auto stage = std::make_unique<stage_type>(*workContractGroup_, std::move(name), std::move(function), config,
+                    (upstreamParallelism_ == 1), upstream);
+            auto newStage = stage.get();
+            if (stages_.empty())
+            {
+                if constexpr (std::is_same_v<O, I>)
+                    head_ = newStage;
+            }
+            else
+            {
+                connect_(newStage);
+            }
+            stages_.push_back(std::move(stage));
+
+            pipeline_builder<T, I, output_type> next(*workContractGroup_);
+            next.stages_ = std::move(stages_);
+            next.head_ = head_;
+            next.upstreamParallelism_ = std::max<std::size_t>(config.parallelism_, 1);
+            if constexpr (!std::is_void_v<output_type>)
+                next.connect_ = [newStage](auto * downstream){newStage->set_downstream(downstream);};
+            return next;
+        }
+
+        pipeline<T, I> build() &&
+        {
+            static_assert(std::is_void_v<O>, "pipeline: the final stage must be a sink (returning void)");
+            return {std::move(stages_), head_};
+        }
+
+    private:
+
+        template <work_contract_mode, typename, typename>
+        friend class pipeline_builder;
+
+        using downstream_type = detail::pipeline_stage_input<T, std::conditional_t<std::is_void_v<O>, I, O>>;
+
+        work_contract_group_type *                                      workContractGroup_;
+
+        std::vector<std::unique_ptr<detail::pipeline_stage_base<T>>>    stages_;
+
+        detail::pipeline_stage_input<T, I> *                            head_{nullptr};
+
+        std::size_t                                                     upstreamParallelism_{0};    // 0: pushed by the application
+
+        std::function<void(downstream_type *)>                          connect_;
+    };
+
+
+    template <typename I, work_contract_mode T>
+    auto make_pipeline
+    (
+        work_contract_group<T> & workContractGroup
+    ) -> pipeline_builder<T, I, I>
+    {
+        return {workContractGroup};
+    }
+
+} // namespace maniscalco::system
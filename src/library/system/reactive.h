@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./reactive/reactive_graph.h"
@@ -0,0 +1,520 @@
+#pragma once
+
+#include <library/system/work_contract/work_contract_group.h>
+#include <library/system/work_contract/work_contract.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // an incremental dataflow graph of derived values.  inputs are set by the application
+    // and every other node is a work contract which recomputes its value from its parents'
+    // values when any of them change.  bursts of changes coalesce: a node which is invoked
+    // again before it executes recomputes once.
+    //
+    // updates are glitch free.  setting an input first marks every node downstream of it as
+    // stale.  each node counts its stale parents and is invoked only once that count reaches
+    // zero, so a node never computes from a mix of updated and not yet updated parents (a
+    // diamond a -> b, a -> c, (b, c) -> d recomputes d once, after both b and c).  nodes which
+    // are not related execute concurrently on the group's workers.
+    //
+    // values are published with a seqlock and read without locks.  values must therefore be
+    // trivially copyable.
+    //
+    //      reactive_graph graph(workContractGroup);
+    //      auto price = graph.add_input(100.0);
+    //      auto quantity = graph.add_input(5);
+    //      auto notional = graph.add_node([](double p, int q){return p * q;}, price, quantity);
+    //      price.set(101.0);
+    //      ... notional.get() ...
+    //
+    // nodes compute their initial value when they are added.  nodes must be added before
+    // inputs are set concurrently with other threads.  any number of threads may set the
+    // same input.  inputs must not be set while the graph is destroyed.  destruction waits
+    // for the surrender of every node's contract and helps execute the group's contracts
+    // while it does.  a graph must not be destroyed from within one of its own nodes.
+    template <work_contract_mode T>
+    class reactive_graph
+    {
+    public:
+
+        using work_contract_group_type = work_contract_group<T>;
+
+        template <typename V>
+        class input;
+
+        template <typename V>
+        class node;
+
+        reactive_graph
+        (
+            work_contract_group_type &
+        );
+
+        ~reactive_graph();
+
+        reactive_graph(reactive_graph const &) = delete;
+        reactive_graph & operator = (reactive_graph const &) = delete;
+
+        template <typename V>
+        input<std::decay_t<V>> add_input
+        (
+            V &&
+        );
+
+        // function(parent values ...) -> value.  parents are inputs or nodes of this graph.
+        template <typename F, typename ... P>
+        auto add_node
+        (
+            F,
+            P const & ...
+        );
+
+        // true when no node has a recomputation outstanding
+        bool is_stable() const;
+
+        // number of node recomputations which threw.  a node which throws keeps its previous value.
+        std::size_t get_failure_count() const;
+
+    private:
+
+        template <typename V>
+        class published_value;
+
+        class vertex;
+
+        template <typename V>
+        class value_vertex;
+
+        template <typename V>
+        class input_vertex;
+
+        template <typename V, typename F, typename ... P>
+        class node_vertex;
+
+        work_contract_group_type &              workContractGroup_;
+
+        std::vector<std::unique_ptr<vertex>>    vertices_;
+
+        std::atomic<std::size_t>                staleCount_{0};
+
+        std::atomic<std::size_t>                failureCount_{0};
+
+        std::atomic<std::size_t>                surrenderedCount_{0};
+
+    }; // class reactive_graph
+
+
+    //=========================================================================
+    // seqlock value.  stored as relaxed atomic words so that a torn read (which the sequence
+    // check discards) is not a data race.  writers take the odd sequence in turn so that
+    // concurrent stores (two threads setting the same input) serialize rather than tear.
+    //=========================================================================
+    template <work_contract_mode T>
+    template <typename V>
+    class reactive_graph<T>::published_value
+    {
+    public:
+
+        static_assert(std::is_trivially_copyable_v<V>, "reactive_graph values must be trivially copyable");
+
+        published_value
+        (
+            V const & value
+        )
+        {
+            store(value);
+        }
+
+        void store
+        (
+            V const & value
+        )
+        {
+            std::uint64_t words[word_count]{};
+            std::memcpy(words, &value, sizeof(V));
+            auto sequence = sequence_.load(std::memory_order_relaxed);
+            while (((sequence & 1) != 0) || (!sequence_.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)))
+                if ((sequence & 1) != 0)
+                    sequence = sequence_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i < word_count; ++i)
+                words_[i].store(words[i], std::memory_order_relaxed);
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+
+        V load() const
+        {
+            std::uint64_t words[word_count];
+            while (true)
+            {
+                auto sequence = sequence_.load(std::memory_order_acquire);
+                if ((sequence & 1) == 0)
+                {
+                    for (std::size_t i = 0; i < word_count; ++i)
+                        words[i] = words_[i].load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (sequence_.load(std::memory_order_relaxed) == sequence)
+                        break;
+                }
+            }
+            V value;
+            std::memcpy(&value, words, sizeof(V));
+            return value;
+        }
+
+        std::uint64_t get_version() const{return (sequence_.load(std::memory_order_acquire) >> 1);}
+
+    private:
+
+        static auto constexpr word_count = ((sizeof(V) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+
+        std::atomic<std::uint64_t>  sequence_{0};
+
+        std::atomic<std::uint64_t>  words_[word_count];
+    };
+
+
+    //=========================================================================
+    // a node in the graph.  state_ packs the number of outstanding reasons to be stale
+    // (low 32 bits: one per stale parent plus one while the node itself owes a recomputation)
+    // with a count of parent releases (high 32 bits) which lets a node detect that a parent
+    // changed again while it was computing.
+    //=========================================================================
+    template <work_contract_mode T>
+    class reactive_graph<T>::vertex
+    {
+    public:
+
+        vertex(reactive_graph & graph):graph_(graph){}
+
+        virtual ~vertex() = default;
+
+        void add_child(vertex * child){children_.push_back(child);}
+
+        bool surrender(){return contract_.surrender();}
+
+        // a parent became stale
+        void mark()
+        {
+            auto state = state_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                // clean -> one stale parent and this node's own recomputation
+                auto desired = ((state & count_mask) == 0) ? (state + 2) : (state + 1);
+                if (state_.compare_exchange_weak(state, desired, std::memory_order_acq_rel, std::memory_order_relaxed))
+                    break;
+            }
+            if ((state & count_mask) == 0)
+            {
+                ++graph_.staleCount_;
+                mark_children();
+            }
+        }
+
+        // a parent has published its new value
+        void release()
+        {
+            auto state = state_.fetch_add(release_increment - 1, std::memory_order_acq_rel) + release_increment - 1;
+            if ((state & count_mask) == 1)
+                contract_.invoke();
+        }
+
+    protected:
+
+        static auto constexpr count_mask = std::uint64_t(0xffffffff);
+        static auto constexpr release_increment = (std::uint64_t(1) << 32);
+
+        void mark_children()
+        {
+            for (auto child : children_)
+                child->mark();
+        }
+
+        void release_children()
+        {
+            for (auto child : children_)
+                child->release();
+        }
+
+        // called by the node's contract
+        template <typename C, typename P>
+        void execute
+        (
+            C && compute,
+            P && publish
+        )
+        {
+            auto state = state_.load(std::memory_order_acquire);
+            if ((state & count_mask) != 1)
+                return; // re-invoked while a parent is stale again.  invoked once more when it is not.
+            std::optional<decltype(compute())> value;
+            try
+            {
+                value.emplace(compute());
+            }
+            catch (...)
+            {
+                ++graph_.failureCount_;
+            }
+            // clean only if no parent was released or marked during the recomputation.
+            // otherwise the node stays stale, its children stay marked and the value, which
+            // might mix old and new parent values, is discarded.  the contract executes
+            // exclusively so publishing after becoming clean races with no other store.
+            if (state_.compare_exchange_strong(state, state - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                if (value.has_value())
+                    publish(*value);
+                --graph_.staleCount_;
+                release_children();
+            }
+        }
+
+        reactive_graph &                graph_;
+
+        std::vector<vertex *>           children_;
+
+        std::atomic<std::uint64_t>      state_{0};
+
+        work_contract<T>                contract_;
+    };
+
+
+    //=========================================================================
+    template <work_contract_mode T>
+    template <typename V>
+    class reactive_graph<T>::value_vertex :
+        public vertex
+    {
+    public:
+
+        value_vertex
+        (
+            reactive_graph & graph,
+            V const & value
+        ):
+            vertex(graph),
+            value_(value)
+        {
+        }
+
+        published_value<V>  value_;
+    };
+
+
+    //=========================================================================
+    template <work_contract_mode T>
+    template <typename V>
+    class reactive_graph<T>::input_vertex :
+        public value_vertex<V>
+    {
+    public:
+
+        using value_vertex<V>::value_vertex;
+
+        void set
+        (
+            V const & value
+        )
+        {
+            this->mark_children();
+            this->value_.store(value);
+            this->release_children();
+        }
+    };
+
+
+    //=========================================================================
+    template <work_contract_mode T>
+    template <typename V, typename F, typename ... P>
+    class reactive_graph<T>::node_vertex :
+        public value_vertex<V>
+    {
+    public:
+
+        node_vertex
+        (
+            reactive_graph & graph,
+            F function,
+            value_vertex<P> * ... parents
+        ):
+            value_vertex<V>(graph, function(parents->value_.load() ...)),
+            function_(std::move(function)),
+            parents_(parents ...)
+        {
+            this->contract_ = graph.workContractGroup_.create_contract([this]()
+                    {
+                        this->execute([this](){return V(std::apply([this](auto * ... parents){return function_(parents->value_.load() ...);}, parents_));},
+                                [this](V const & value){this->value_.store(value);});
+                    },
+                    [&graph](){graph.surrenderedCount_.fetch_add(1, std::memory_order_release);});
+            if (!this->contract_.is_valid())
+                throw std::runtime_error("reactive_graph: work_contract_group has no free contracts");
+        }
+
+    private:
+
+        F                                   function_;
+
+        std::tuple<value_vertex<P> * ...>   parents_;
+    };
+
+
+    //=========================================================================
+    // handles
+    //=========================================================================
+    template <work_contract_mode T>
+    template <typename V>
+    class reactive_graph<T>::input
+    {
+    public:
+
+        using value_type = V;
+
+        void set(V const & value){vertex_->set(value);}
+
+        V get() const{return vertex_->value_.load();}
+
+        // incremented each time a new value is published
+        std::uint64_t get_version() const{return vertex_->value_.get_version();}
+
+    private:
+
+        friend class reactive_graph;
+
+        input(input_vertex<V> * vertex):vertex_(vertex){}
+
+        value_vertex<V> * get_vertex() const{return vertex_;}
+
+        input_vertex<V> *   vertex_;
+    };
+
+
+    template <work_contract_mode T>
+    template <typename V>
+    class reactive_graph<T>::node
+    {
+    public:
+
+        using value_type = V;
+
+        // the most recently published value.  lock free.
+        V get() const{return vertex_->value_.load();}
+
+        // incremented each time a new value is published
+        std::uint64_t get_version() const{return vertex_->value_.get_version();}
+
+    private:
+
+        friend class reactive_graph;
+
+        node(value_vertex<V> * vertex):vertex_(vertex){}
+
+        value_vertex<V> * get_vertex() const{return vertex_;}
+
+        value_vertex<V> *   vertex_;
+    };
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::reactive_graph<T>::reactive_graph
+(
+    work_contract_group_type & workContractGroup
+):
+    workContractGroup_(workContractGroup)
+{
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::reactive_graph<T>::~reactive_graph
+(
+)
+{
+    // parents first.  once a node's surrender has executed its contract can not execute
+    // again, so no contract is left to invoke or read a node which is being surrendered or
+    // destroyed.  a contract of a stopped group is not surrendered.
+    std::size_t surrenderCount = 0;
+    for (auto & vertex : vertices_)
+    {
+        surrenderCount += vertex->surrender();
+        while (surrenderedCount_.load(std::memory_order_acquire) < surrenderCount)
+        {
+            workContractGroup_.try_execute_next_contract();
+            std::this_thread::yield();
+        }
+    }
+    // children first
+    while (!vertices_.empty())
+        vertices_.pop_back();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <typename V>
+inline auto maniscalco::system::reactive_graph<T>::add_input
+(
+    V && value
+) -> input<std::decay_t<V>>
+{
+    auto vertex = std::make_unique<input_vertex<std::decay_t<V>>>(*this, std::forward<V>(value));
+    auto result = vertex.get();
+    vertices_.push_back(std::move(vertex));
+    return {result};
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+template <typename F, typename ... P>
+inline auto maniscalco::system::reactive_graph<T>::add_node
+(
+    F function,
+    P const & ... parents
+)
+{
+    using value_type = std::decay_t<std::invoke_result_t<F &, typename P::value_type ...>>;
+    auto vertex = std::make_unique<node_vertex<value_type, F, typename P::value_type ...>>(*this, std::move(function), parents.get_vertex() ...);
+    auto result = vertex.get();
+    (parents.get_vertex()->add_child(result), ...);
+    vertices_.push_back(std::move(vertex));
+    return node<value_type>(result);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline bool maniscalco::system::reactive_graph<T>::is_stable
+(
+) const
+{
+    return (staleCount_.load(std::memory_order_acquire) == 0);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::size_t maniscalco::system::reactive_graph<T>::get_failure_count
+(
+) const
+{
+    return failureCount_.load(std::memory_order_relaxed);
+}
@@ -1,5 +1,10 @@
 #include "./system.h"
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 
 //==============================================================================
 auto maniscalco::system::get_cpu_affinity
@@ -19,6 +24,25 @@ auto maniscalco::system::get_cpu_affinity
 }
 
 
+//==============================================================================
+auto maniscalco::system::get_cpu_affinity_set
+(
+) -> cpu_set
+{
+    cpu_set result;
+    #ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+
+    pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    for (int32_t i = 0; i < CPU_SETSIZE; ++i)
+        if (CPU_ISSET(i, &cpuSet))
+            result.insert(cpu_id(i));
+    #endif
+    return result;
+}
+
+
 //==============================================================================
 bool maniscalco::system::set_cpu_affinity
 (
@@ -30,7 +54,31 @@ bool maniscalco::system::set_cpu_affinity
     cpu_set_t cpuSet;
     CPU_ZERO(&cpuSet);
     CPU_SET(cpuId, &cpuSet);
-    return (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0);
+    auto success = (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0);
+    refresh_thread_numa_node_id();
+    return success;
+    #endif
+
+    return false;
+}
+
+
+//==============================================================================
+bool maniscalco::system::set_cpu_affinity
+(
+    // set affinity for the thread to every cpu in the set
+    cpu_set const & cpus
+)
+{
+    #ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto cpuId : cpus)
+        if (cpuId < CPU_SETSIZE)
+            CPU_SET(cpuId, &cpuSet);
+    auto success = ((CPU_COUNT(&cpuSet) > 0) && (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0));
+    refresh_thread_numa_node_id();
+    return success;
     #endif
 
     return false;
@@ -1,8 +1,21 @@
 #pragma once
 
 #include "./cpu_id.h"
+#include "./cpu_set.h"
+#include "./memory/mapped_array.h"
+#include "./memory/numa.h"
+#include "./topology/cpu_topology.h"
+#include "./topology/placement.h"
 #include "./threading/thread_pool.h"
+#include "./threading/work_stealing_executor.h"
+#include "./reactive/reactive_graph.h"
+#include "./actor/actor.h"
+#include "./pipeline/pipeline.h"
 #include "./work_contract/work_contract_group.h"
+#include "./work_contract/work_contract_executor.h"
+#include "./work_contract/nested_work_contract_group.h"
+#include "./work_contract/pollable_work_contract_group.h"
+#include "./work_contract/shared_work_contract_group.h"
 
 
 namespace maniscalco::system
@@ -10,9 +23,16 @@ namespace maniscalco::system
 
     cpu_id get_cpu_affinity();
 
+    cpu_set get_cpu_affinity_set();
+
     bool set_cpu_affinity
     (
         cpu_id 
     );
 
+    bool set_cpu_affinity
+    (
+        cpu_set const &
+    );
+
 } // namespace maniscalco::system
\ No newline at end of file
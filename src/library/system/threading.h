@@ -1,4 +1,9 @@
 #pragma once
 
 #include "./threading/thread_pool.h"
+#include "./threading/worker_context.h"
+#include "./threading/qsbr.h"
+#include "./threading/pause_backoff.h"
+#include "./threading/realtime_profile.h"
 
+#include "./threading/work_stealing_executor.h"
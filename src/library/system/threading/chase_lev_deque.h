@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // single owner, multiple thief work stealing deque (Chase and Lev, with the C11 memory
+    // orderings of Le, Pop, Cohen and Zappa Nardelli).  the owner pushes and pops at the bottom,
+    // thieves steal from the top.  the ring grows when full.  replaced rings are retained until
+    // the deque is destroyed because a thief may still be reading from one.
+    template <typename T>
+    requires (std::is_pointer_v<T>)
+    class chase_lev_deque
+    {
+    public:
+
+        chase_lev_deque
+        (
+            std::size_t = 256       // initial capacity, rounded up to a power of two
+        );
+
+        chase_lev_deque(chase_lev_deque const &) = delete;
+        chase_lev_deque & operator = (chase_lev_deque const &) = delete;
+
+        // owner only
+        void push
+        (
+            T
+        );
+
+        // owner only.  nullptr if empty.
+        T pop();
+
+        // any thread.  nullptr if empty or if the steal lost a race.
+        T steal();
+
+        bool empty() const;
+
+    private:
+
+        struct ring
+        {
+            ring
+            (
+                std::size_t capacity
+            ):
+                mask_(capacity - 1),
+                values_(std::make_unique<std::atomic<T>[]>(capacity))
+            {
+            }
+
+            std::size_t get_capacity() const{return (mask_ + 1);}
+            T get(std::int64_t index) const{return values_[index & mask_].load(std::memory_order_relaxed);}
+            void put(std::int64_t index, T value){values_[index & mask_].store(value, std::memory_order_relaxed);}
+
+            std::size_t                         mask_;
+            std::unique_ptr<std::atomic<T>[]>   values_;
+        };
+
+        ring * grow
+        (
+            ring *,
+            std::int64_t,
+            std::int64_t
+        );
+
+        alignas(64) std::atomic<std::int64_t>   top_{0};
+
+        alignas(64) std::atomic<std::int64_t>   bottom_{0};
+
+        std::atomic<ring *>                     ring_;
+
+        std::vector<std::unique_ptr<ring>>      rings_;     // current and retired, owner only
+    };
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <typename T>
+requires (std::is_pointer_v<T>)
+inline maniscalco::system::chase_lev_deque<T>::chase_lev_deque
+(
+    std::size_t capacity
+)
+{
+    rings_.push_back(std::make_unique<ring>(std::bit_ceil(std::max<std::size_t>(capacity, 2))));
+    ring_ = rings_.back().get();
+}
+
+
+//=============================================================================
+template <typename T>
+requires (std::is_pointer_v<T>)
+inline auto maniscalco::system::chase_lev_deque<T>::grow
+(
+    ring * current,
+    std::int64_t top,
+    std::int64_t bottom
+) -> ring *
+{
+    rings_.push_back(std::make_unique<ring>(current->get_capacity() * 2));
+    auto next = rings_.back().get();
+    for (auto i = top; i < bottom; ++i)
+        next->put(i, current->get(i));
+    ring_.store(next, std::memory_order_release);
+    return next;
+}
+
+
+//=============================================================================
+template <typename T>
+requires (std::is_pointer_v<T>)
+inline void maniscalco::system::chase_lev_deque<T>::push
+(
+    T value
+)
+{
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_acquire);
+    auto current = ring_.load(std::memory_order_relaxed);
+    if ((bottom - top) > static_cast<std::int64_t>(current->get_capacity() - 1))
+        current = grow(current, top, bottom);
+    current->put(bottom, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+template <typename T>
+requires (std::is_pointer_v<T>)
+inline T maniscalco::system::chase_lev_deque<T>::pop
+(
+)
+{
+    auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    auto current = ring_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+    if (top > bottom)
+    {
+        // empty
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    auto value = current->get(bottom);
+    if (top == bottom)
+    {
+        // last element: race the thieves for it
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            value = nullptr;
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return value;
+}
+
+
+//=============================================================================
+template <typename T>
+requires (std::is_pointer_v<T>)
+inline T maniscalco::system::chase_lev_deque<T>::steal
+(
+)
+{
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom)
+        return nullptr;
+    auto value = ring_.load(std::memory_order_acquire)->get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return value;
+}
+
+
+//=============================================================================
+template <typename T>
+requires (std::is_pointer_v<T>)
+inline bool maniscalco::system::chase_lev_deque<T>::empty
+(
+) const
+{
+    return (top_.load(std::memory_order_relaxed) >= bottom_.load(std::memory_order_relaxed));
+}
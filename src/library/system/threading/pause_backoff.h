@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+
+namespace maniscalco::system
+{
+
+    // spin wait backoff for threads which poll rather than sleep.  each call executes twice
+    // as many pause instructions as the last (up to max_pauses) which keeps a polling thread
+    // off the memory bus and yields pipeline resources to a hyperthread sibling.  reset()
+    // once there is work again.
+    class pause_backoff
+    {
+    public:
+
+        static auto constexpr max_pauses = 64;
+
+        // returns the number of pauses executed
+        std::uint32_t operator()()
+        {
+            auto pauses = pauses_;
+            for (auto i = 0u; i < pauses; ++i)
+                pause();
+            pauses_ = std::min<std::uint32_t>(pauses << 1, max_pauses);
+            return pauses;
+        }
+
+        void reset(){pauses_ = 1;}
+
+        static void pause()
+        {
+            #if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+            #elif defined(__aarch64__)
+            asm volatile("yield");
+            #endif
+        }
+
+    private:
+
+        std::uint32_t   pauses_{1};
+    };
+
+} // namespace maniscalco::system
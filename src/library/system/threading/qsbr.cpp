@@ -0,0 +1,162 @@
+#include "./qsbr.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+    struct retired
+    {
+        std::uint64_t           epoch_;     // reclaimable once every participant has reached this epoch
+        std::function<void()>   deleter_;
+    };
+
+    std::mutex                                                  registryMutex;
+    std::vector<maniscalco::system::qsbr::participant *>        participants;
+    std::deque<retired>                                         pending;
+    thread_local maniscalco::system::qsbr::participant *        currentParticipant{nullptr};
+
+} // namespace
+
+
+//=============================================================================
+maniscalco::system::qsbr::participant::participant
+(
+)
+{
+    std::lock_guard lockGuard(registryMutex);
+    epoch_.store(qsbr::epoch_.load());
+    participants.push_back(this);
+    if (currentParticipant == nullptr)
+        currentParticipant = this;
+}
+
+
+//=============================================================================
+maniscalco::system::qsbr::participant::~participant
+(
+)
+{
+    std::lock_guard lockGuard(registryMutex);
+    participants.erase(std::find(participants.begin(), participants.end(), this));
+    if (currentParticipant == this)
+        currentParticipant = nullptr;
+}
+
+
+//=============================================================================
+void maniscalco::system::qsbr::participant::go_offline
+(
+)
+{
+    epoch_.store(qsbr::epoch_.load(std::memory_order_relaxed) | offline_flag, std::memory_order_release);
+    if (qsbr::pendingCount_.load(std::memory_order_relaxed) != 0)
+        qsbr::reclaim();
+}
+
+
+//=============================================================================
+void maniscalco::system::qsbr::participant::go_online
+(
+)
+{
+    // a reclaimer which saw this participant offline must have retired everything it is about to
+    // free before this store.  the fence keeps the loads of shared pointers which follow from
+    // being satisfied before the store is visible.
+    epoch_.store(qsbr::epoch_.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+
+//=============================================================================
+auto maniscalco::system::qsbr::get_participant
+(
+) -> participant *
+{
+    return currentParticipant;
+}
+
+
+//=============================================================================
+void maniscalco::system::qsbr::retire
+(
+    std::function<void()> deleter
+)
+{
+    {
+        std::lock_guard lockGuard(registryMutex);
+        // the retired object was unpublished before this increment so participants which
+        // observe the new epoch at a quiescent state can no longer hold it
+        pending.push_back({epoch_.fetch_add(1) + 1, std::move(deleter)});
+        pendingCount_.store(pending.size(), std::memory_order_relaxed);
+    }
+    reclaim();
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::qsbr::reclaim
+(
+)
+{
+    std::vector<std::function<void()>> reclaimable;
+    {
+        std::lock_guard lockGuard(registryMutex);
+        auto minimumEpoch = std::numeric_limits<std::uint64_t>::max();
+        for (auto const * participant : participants)
+            if (auto epoch = participant->epoch_.load(std::memory_order_acquire); (epoch & participant::offline_flag) == 0)
+                minimumEpoch = std::min(minimumEpoch, epoch);
+        while ((!pending.empty()) && (pending.front().epoch_ <= minimumEpoch))
+        {
+            reclaimable.push_back(std::move(pending.front().deleter_));
+            pending.pop_front();
+        }
+        pendingCount_.store(pending.size(), std::memory_order_relaxed);
+    }
+    // outside of the lock so that deleters may retire
+    for (auto & deleter : reclaimable)
+        deleter();
+    return reclaimable.size();
+}
+
+
+//=============================================================================
+void maniscalco::system::qsbr::synchronize
+(
+)
+{
+    auto epoch = (epoch_.fetch_add(1) + 1);
+    if (currentParticipant != nullptr)
+        currentParticipant->quiescent_state();
+    while (true)
+    {
+        {
+            std::lock_guard lockGuard(registryMutex);
+            if (std::all_of(participants.begin(), participants.end(), [epoch](auto const * participant)
+                    {
+                        auto participantEpoch = participant->epoch_.load(std::memory_order_acquire);
+                        return (((participantEpoch & participant::offline_flag) != 0) || (participantEpoch >= epoch));
+                    }))
+                break;
+        }
+        std::this_thread::yield();
+    }
+    reclaim();
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::qsbr::get_pending_count
+(
+)
+{
+    std::lock_guard lockGuard(registryMutex);
+    return pending.size();
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+
+namespace maniscalco::system
+{
+
+    // quiescent state based reclamation.  data shared by contracts (configuration, routing
+    // tables, symbol maps) is read through plain pointer loads with no reference counting.
+    // a writer publishes a new version and retires the old one, which is destroyed once every
+    // participant has passed through a quiescent state, a point at which it holds no pointers
+    // to shared data.
+    //
+    // every thread_pool worker is a participant.  each return from execute_next_contract is a
+    // quiescent state and a parked worker is offline (quiescent for as long as it waits).  so
+    // pointers obtained within a contract must not be kept beyond that execution.  other threads
+    // which read shared data must own a participant and call quiescent_state() themselves.
+    //
+    // a worker which does not return from a contract delays reclamation for every retirement.
+    // reclamation is driven by the participants: the deleters of retired objects run on
+    // whichever thread completes their grace period, either by passing a quiescent state or by
+    // going offline (so, usually, on a worker).  retire() and synchronize() also reclaim.
+    class qsbr
+    {
+    public:
+
+        // a reading thread's state.  registered for its lifetime.
+        class participant
+        {
+        public:
+
+            participant();
+
+            ~participant();
+
+            participant(participant const &) = delete;
+            participant & operator = (participant const &) = delete;
+
+            // the thread (which is online) holds no pointers to shared data
+            void quiescent_state();
+
+            // the thread will read no shared data until it is online again
+            void go_offline();
+
+            void go_online();
+
+        private:
+
+            friend class qsbr;
+
+            static auto constexpr offline_flag = (1ull << 63);
+
+            alignas(64) std::atomic<std::uint64_t>  epoch_;     // latest epoch observed at a quiescent state
+        };
+
+        // destroy (via the deleter) once every participant has passed a quiescent state
+        static void retire
+        (
+            std::function<void()>
+        );
+
+        template <typename T>
+        static void retire
+        (
+            T const *
+        );
+
+        // run the deleters of retired objects whose grace period has elapsed.  returns how many.
+        static std::size_t reclaim();
+
+        // wait for every participant to pass a quiescent state then reclaim.  a participant
+        // calling this is quiescent for the duration.
+        static void synchronize();
+
+        // retired objects not yet reclaimed
+        static std::size_t get_pending_count();
+
+        // the calling thread's participant or nullptr
+        static participant * get_participant();
+
+    private:
+
+        static inline std::atomic<std::uint64_t> epoch_{1};
+
+        static inline std::atomic<std::size_t> pendingCount_{0};    // retired, not yet reclaimed
+    };
+
+
+    // a pointer to shared, rarely updated data.  get() is a single acquire load.  update()
+    // publishes a new version and retires the old one.  concurrent writers must be serialized
+    // by the caller.
+    //
+    //      rcu_pointer<routing_table> routes(std::make_unique<routing_table>(...));
+    //      // in a contract
+    //      auto table = routes.get();
+    //      // elsewhere
+    //      routes.update(std::make_unique<routing_table>(...));
+    //
+    // the current version is destroyed with the rcu_pointer, which must outlive its readers.
+    template <typename T>
+    class rcu_pointer
+    {
+    public:
+
+        rcu_pointer() = default;
+
+        rcu_pointer(std::unique_ptr<T const> value):pointer_(value.release()){}
+
+        ~rcu_pointer(){delete pointer_.load(std::memory_order_relaxed);}
+
+        rcu_pointer(rcu_pointer const &) = delete;
+        rcu_pointer & operator = (rcu_pointer const &) = delete;
+
+        T const * get() const{return pointer_.load(std::memory_order_acquire);}
+
+        T const * operator -> () const{return get();}
+
+        T const & operator * () const{return *get();}
+
+        void update
+        (
+            std::unique_ptr<T const> value
+        )
+        {
+            if (auto previous = pointer_.exchange(value.release(), std::memory_order_seq_cst); previous != nullptr)
+                qsbr::retire(previous);
+        }
+
+    private:
+
+        std::atomic<T const *>  pointer_{nullptr};
+    };
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <typename T>
+inline void maniscalco::system::qsbr::retire
+(
+    T const * value
+)
+{
+    retire([value](){delete value;});
+}
+
+
+//=============================================================================
+inline void maniscalco::system::qsbr::participant::quiescent_state
+(
+)
+{
+    // only written when a retirement has advanced the epoch.  the acquire pairs with the
+    // retirer's increment, which follows the unpublishing of the retired object, so that having
+    // observed the new epoch this thread can no longer load the retired pointer.
+    if (auto epoch = qsbr::epoch_.load(std::memory_order_acquire); epoch != epoch_.load(std::memory_order_relaxed))
+    {
+        epoch_.store(epoch, std::memory_order_release);
+        // this might have been the last participant holding back a retirement
+        if (qsbr::pendingCount_.load(std::memory_order_relaxed) != 0)
+            qsbr::reclaim();
+    }
+}
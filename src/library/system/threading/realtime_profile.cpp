@@ -0,0 +1,120 @@
+#include "./realtime_profile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    // room left on the stack beyond the prefaulted region
+    static auto constexpr stack_prefault_margin = (64 << 10);
+
+
+    //=========================================================================
+    [[gnu::noinline]] void prefault_stack
+    (
+        std::size_t size
+    )
+    {
+        static std::size_t const pageSize = ::sysconf(_SC_PAGESIZE);
+        // from the top down, the order in which the stack would grow
+        auto stack = static_cast<char volatile *>(::alloca(size));
+        for (auto offset = size; offset > 0; offset -= std::min(offset, pageSize))
+            stack[offset - 1] = 0;
+    }
+
+
+    //=========================================================================
+    std::size_t get_available_stack_size
+    (
+        // bytes between the caller's frame and the end of the thread's stack
+    )
+    {
+        pthread_attr_t attributes;
+        if (::pthread_getattr_np(::pthread_self(), &attributes) != 0)
+            return 0;
+        void * stackAddress = nullptr;
+        std::size_t stackSize = 0;
+        ::pthread_attr_getstack(&attributes, &stackAddress, &stackSize);
+        ::pthread_attr_destroy(&attributes);
+        char marker;
+        auto used = static_cast<std::size_t>(static_cast<char *>(stackAddress) + stackSize - &marker);
+        return (used < stackSize) ? (stackSize - used) : 0;
+    }
+
+} // namespace
+
+
+//=============================================================================
+bool maniscalco::system::realtime_profile::is_empty
+(
+) const
+{
+    return ((schedulingPolicy_ == scheduling_policy::normal) && (timerSlack_.count() == 0) && (stackPrefaultSize_ == 0) && (!lockMemory_));
+}
+
+
+//=============================================================================
+auto maniscalco::system::realtime_profile::apply
+(
+) const -> std::vector<failure>
+{
+    std::vector<failure> failures;
+
+    if (lockMemory_)
+        if (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+            failures.push_back({setting::memory_lock, errno});
+
+    if (schedulingPolicy_ != scheduling_policy::normal)
+    {
+        sched_param schedulingParameters{};
+        schedulingParameters.sched_priority = priority_;
+        // returns the error rather than setting errno
+        if (auto result = ::pthread_setschedparam(::pthread_self(), (schedulingPolicy_ == scheduling_policy::fifo) ? SCHED_FIFO : SCHED_RR, 
+                &schedulingParameters); result != 0)
+            failures.push_back({setting::scheduling_policy, result});
+    }
+
+    if (timerSlack_.count() > 0)
+        if (::prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(timerSlack_.count()), 0, 0, 0) != 0)
+            failures.push_back({setting::timer_slack, errno});
+
+    if (stackPrefaultSize_ > 0)
+    {
+        // after mlockall so that the touched pages stay resident
+        auto available = get_available_stack_size();
+        auto size = std::min(stackPrefaultSize_, (available > stack_prefault_margin) ? (available - stack_prefault_margin) : 0);
+        if (size > 0)
+            prefault_stack(size);
+        if (size < stackPrefaultSize_)
+            failures.push_back({setting::stack_prefault, ENOMEM});
+    }
+    return failures;
+}
+
+
+//=============================================================================
+char const * maniscalco::system::realtime_profile::get_name
+(
+    setting value
+)
+{
+    switch (value)
+    {
+        case setting::cpu_affinity: return "cpu_affinity";
+        case setting::scheduling_policy: return "scheduling_policy";
+        case setting::timer_slack: return "timer_slack";
+        case setting::stack_prefault: return "stack_prefault";
+        case setting::memory_lock: return "memory_lock";
+    }
+    return "unknown";
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // scheduling and memory settings for latency critical threads, applied by the thread
+    // itself (thread_pool applies a worker's profile on the worker before initializeHandler_).
+    // the fifo and round_robin policies need CAP_SYS_NICE (or an RLIMIT_RTPRIO allowance) and
+    // locking memory needs CAP_IPC_LOCK (or a sufficient RLIMIT_MEMLOCK).  settings which can
+    // not be applied are reported rather than treated as errors.  a fifo or round_robin thread
+    // which busy polls (worker_context::configuration::busyPoll_) never gives up its cpu and
+    // should have an isolated cpu to itself.
+    struct realtime_profile
+    {
+        enum class scheduling_policy : std::uint32_t
+        {
+            normal          = 0,    // SCHED_OTHER, the profile leaves the policy unchanged
+            fifo            = 1,    // SCHED_FIFO
+            round_robin     = 2     // SCHED_RR
+        };
+
+        enum class setting : std::uint32_t
+        {
+            cpu_affinity        = 0,
+            scheduling_policy   = 1,
+            timer_slack         = 2,
+            stack_prefault      = 3,
+            memory_lock         = 4
+        };
+
+        struct failure
+        {
+            setting     setting_;
+            int         errorCode_;     // errno value or zero if unknown
+        };
+
+        scheduling_policy           schedulingPolicy_{scheduling_policy::normal};
+        int                         priority_{0};           // 1 to 99 for fifo and round_robin
+        // the slack the kernel may add to timed sleeps (50us by default).  zero leaves it unchanged.
+        std::chrono::nanoseconds    timerSlack_{0};
+        // bytes of stack to touch up front so that the thread takes no page faults on its stack later
+        std::size_t                 stackPrefaultSize_{0};
+        // mlockall(MCL_CURRENT | MCL_FUTURE).  process wide.
+        bool                        lockMemory_{false};
+
+        bool is_empty() const;
+
+        // apply to the calling thread.  returns the settings which could not be applied.
+        std::vector<failure> apply() const;
+
+        static char const * get_name
+        (
+            setting
+        );
+    };
+
+} // namespace maniscalco::system
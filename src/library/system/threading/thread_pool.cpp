@@ -1,43 +1,174 @@
 #include "./thread_pool.h"
 
 #include <library/system.h>
+#include <library/system/diagnostics/tracer.h>
 #include <range/v3/view/enumerate.hpp>
 
+#include <algorithm>
+#include <utility>
+
 
 //=============================================================================
 maniscalco::system::thread_pool::thread_pool
 (
     configuration const & config
 ):
+    threadConfigurations_(config.threads_),
+    statisticsPage_(config.statisticsPage_),
+    stallWatchdog_(config.stallWatchdog_),
+    workerContexts_(config.threads_.size()),
     threads_(config.threads_.size())
 {
-    for (auto && [index, thread] : ranges::views::enumerate(threads_))
+    auto initialWorkerCount = threads_.size();
+    if ((config.elastic_.has_value()) && (config.elastic_->loadProbe_))
     {
-        thread = std::jthread([config = config.threads_[index]]
-                (
-                    std::stop_token stopToken
-                )
+        initialWorkerCount = std::min(config.elastic_->minWorkers_, threads_.size());
+        controllerThread_ = std::jthread([this, elastic = config.elastic_.value()](std::stop_token stopToken){control(stopToken, elastic);});
+    }
+    std::lock_guard lockGuard(mutex_);
+    for (auto index = 0ull; index < initialWorkerCount; ++index)
+        start_worker(index);
+}
+
+
+//=============================================================================
+void maniscalco::system::thread_pool::start_worker
+(
+    std::size_t index
+)
+{
+    threads_[index] = std::jthread([config = threadConfigurations_[index], statisticsPage = statisticsPage_, stallWatchdog = stallWatchdog_, 
+            &workerContext = workerContexts_[index], index]
+            (
+                std::stop_token stopToken
+            )
+            {
+                try
                 {
-                    try
+                    std::vector<realtime_profile::failure> failures;
+                    if (config.cpuId_.has_value())
                     {
-                        if (config.cpuId_.has_value())
-                            set_cpu_affinity(config.cpuId_.value());
-
-                        if (config.initializeHandler_)
-                            config.initializeHandler_();
-                        config.function_(stopToken);
-                        if (config.terminateHandler_)
-                            config.terminateHandler_();
+                        if (!set_cpu_affinity(config.cpuId_.value()))
+                            failures.push_back({realtime_profile::setting::cpu_affinity, 0});
                     }
-                    catch (...)
+                    else if ((!config.cpuSet_.empty()) && (!set_cpu_affinity(config.cpuSet_)))
                     {
-                        auto currentException = std::current_exception();
-                        if (config.exceptionHandler_)
-                            config.exceptionHandler_(currentException);
-                        else
-                            std::rethrow_exception(currentException);
+                        failures.push_back({realtime_profile::setting::cpu_affinity, 0});
                     }
-                });
+                    if (!config.realtime_.is_empty())
+                        for (auto failure : config.realtime_.apply())
+                            failures.push_back(failure);
+
+                    // created on the (pinned) worker so that its memory is local to the worker.  reused when
+                    // the worker is restarted since buffers allocated from its pool might still be in use.
+                    if (!workerContext)
+                        workerContext = std::make_unique<worker_context>(index, config.cpuId_, config.workerContext_);
+                    else
+                        workerContext->bufferPool_.set_owner();
+                    workerContext->stopToken_ = stopToken;
+                    workerContext->executionDepth_ = 0;
+                    workerContext->qsbrParticipant_.emplace();
+                    worker_context::current_ = workerContext.get();
+                    if (statisticsPage != nullptr)
+                        workerContext->statistics_ = statisticsPage->allocate_worker_statistics(index, config.cpuId_.value_or(~0ull));
+                    if (stallWatchdog != nullptr)
+                        workerContext->executionSlot_ = stallWatchdog->register_worker(index, config.cpuId_.value_or(~0ull));
+
+                    if ((!failures.empty()) && (config.setupFailureHandler_))
+                        config.setupFailureHandler_(failures);
+                    if (config.initializeHandler_)
+                        config.initializeHandler_();
+                    tracer::trace(tracer::event::thread_start, 0, index);
+                    config.function_(stopToken);
+                    tracer::trace(tracer::event::thread_stop, 0, index);
+                    if (config.terminateHandler_)
+                        config.terminateHandler_();
+                }
+                catch (...)
+                {
+                    auto currentException = std::current_exception();
+                    if (config.exceptionHandler_)
+                        config.exceptionHandler_(currentException);
+                    else
+                        std::rethrow_exception(currentException);
+                }
+                if (workerContext)
+                {
+                    // the context outlives the thread.  it must not hold back reclamation.
+                    workerContext->qsbrParticipant_.reset();
+                    if (stallWatchdog != nullptr)
+                        stallWatchdog->unregister_worker(std::exchange(workerContext->executionSlot_, nullptr));
+                }
+            });
+    ++workerCount_;
+}
+
+
+//=============================================================================
+void maniscalco::system::thread_pool::retire_worker
+(
+    std::size_t index
+)
+{
+    threads_[index].request_stop();
+    threads_[index].join();
+    --workerCount_;
+}
+
+
+//=============================================================================
+void maniscalco::system::thread_pool::control
+(
+    // add or retire workers as the load persists above or below the thresholds
+    std::stop_token const & stopToken,
+    elastic_configuration const & elastic
+)
+{
+    static auto constexpr never = std::chrono::steady_clock::time_point::max();
+    auto aboveSince = never;
+    auto belowSince = never;
+    std::unique_lock uniqueLock(mutex_);
+    while (true)
+    {
+        conditionVariable_.wait_for(uniqueLock, stopToken, elastic.sampleInterval_, [](){return false;});
+        if (stopToken.stop_requested())
+            break;
+        uniqueLock.unlock();
+        auto load = elastic.loadProbe_();
+        uniqueLock.lock();
+
+        auto now = std::chrono::steady_clock::now();
+        auto workerCount = workerCount_.load();
+        if (load > elastic.scaleUpLoad_)
+        {
+            belowSince = never;
+            if (aboveSince == never)
+                aboveSince = now;
+            if (((now - aboveSince) >= elastic.scaleUpDelay_) && (workerCount < threads_.size()))
+            {
+                start_worker(workerCount);
+                aboveSince = never;
+            }
+        }
+        else if (load <= elastic.scaleDownLoad_)
+        {
+            aboveSince = never;
+            if (belowSince == never)
+                belowSince = now;
+            if (((now - belowSince) >= elastic.scaleDownDelay_) && (workerCount > elastic.minWorkers_))
+            {
+                // joined without the lock.  only this thread adds or retires workers.
+                uniqueLock.unlock();
+                retire_worker(workerCount - 1);
+                uniqueLock.lock();
+                belowSince = never;
+            }
+        }
+        else
+        {
+            aboveSince = never;
+            belowSince = never;
+        }
     }
 }
 
@@ -69,6 +200,13 @@ void maniscalco::system::thread_pool::stop
     synchronization_mode stopMode
 )
 {       
+    // no workers are added or retired once the controller has stopped
+    if (controllerThread_.joinable())
+    {
+        controllerThread_.request_stop();
+        controllerThread_.join();
+    }
+
     for (auto & thread : threads_)
         thread.request_stop();
 
@@ -77,3 +215,41 @@ void maniscalco::system::thread_pool::stop
             if (thread.joinable())
                 thread.join();
 }
+
+
+//=============================================================================
+std::size_t maniscalco::system::thread_pool::get_worker_count
+(
+) const
+{
+    return workerCount_.load();
+}
+
+
+//=============================================================================
+auto maniscalco::system::thread_pool::configuration::from_placement
+(
+    cpu_topology const & topology,
+    placement const & placement,
+    thread_configuration const & prototype
+) -> configuration
+{
+    configuration config;
+    for (auto cpuId : select_cpus(topology, placement))
+    {
+        config.threads_.push_back(prototype);
+        config.threads_.back().cpuId_ = cpuId;
+    }
+    return config;
+}
+
+
+//=============================================================================
+auto maniscalco::system::thread_pool::configuration::from_placement
+(
+    placement const & placement,
+    thread_configuration const & prototype
+) -> configuration
+{
+    return from_placement(cpu_topology::discover(), placement, prototype);
+}
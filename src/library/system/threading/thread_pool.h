@@ -1,14 +1,26 @@
 #pragma once
 
 #include <library/system/cpu_id.h>
+#include <library/system/cpu_set.h>
+#include <library/system/diagnostics/stall_watchdog.h>
+#include <library/system/diagnostics/statistics_page.h>
+#include <library/system/topology/cpu_topology.h>
+#include <library/system/topology/placement.h>
+#include "./realtime_profile.h"
+#include "./worker_context.h"
 #include <include/synchronization_mode.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <exception>
+#include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <vector>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 
 
@@ -26,11 +38,62 @@ namespace maniscalco::system
             std::function<void(std::exception_ptr)>         exceptionHandler_; 
             std::function<void(std::stop_token const &)>    function_;
             std::optional<cpu_id>                           cpuId_;
+            // when not empty (and cpuId_ is not set) the worker may run on any of these cpus
+            cpu_set                                         cpuSet_;
+            // applied on the worker before initializeHandler_.  see also workerContext_.busyPoll_
+            realtime_profile                                realtime_;
+            // called on the worker with the settings (including cpu affinity) which could not be applied
+            std::function<void(std::vector<realtime_profile::failure> const &)> setupFailureHandler_;
+            worker_context::configuration                   workerContext_;
+        };
+
+        // an elastic pool runs between minWorkers_ and threads_.size() workers.  a controller
+        // samples the load probe (a measure of unmet demand such as a group's active contract
+        // count, or a recent queueing delay) every sampleInterval_.  a worker is added when the
+        // load has stayed above scaleUpLoad_ for scaleUpDelay_ and the most recently added worker
+        // is retired (stopped and joined) when the load has stayed at or below scaleDownLoad_ for
+        // scaleDownDelay_.  the two thresholds and delays, which restart after every change,
+        // keep the pool from thrashing.
+        //
+        // workers are started in index order and retired in reverse, so worker i always runs
+        // with threads_[i] and its worker_context.  a retired worker's function_ must return
+        // promptly once stop is requested.  workers parked by the library's groups and executors
+        // are woken by the request; other waits must observe the stop token.
+        struct elastic_configuration
+        {
+            std::size_t                     minWorkers_{1};
+            std::function<std::size_t()>    loadProbe_;
+            std::size_t                     scaleUpLoad_{1};
+            std::size_t                     scaleDownLoad_{0};
+            std::chrono::milliseconds       scaleUpDelay_{50};
+            std::chrono::milliseconds       scaleDownDelay_{5000};
+            std::chrono::milliseconds       sampleInterval_{10};
         };
 
         struct configuration
         {
             std::vector<thread_configuration>   threads_;
+            // when set, worker i publishes its counters into worker slot i of the page
+            statistics_page *                   statisticsPage_{nullptr};
+            // when set, each worker publishes the contract it is executing to the watchdog
+            stall_watchdog *                    stallWatchdog_{nullptr};
+            // when set the pool is elastic and threads_ holds the configuration of each potential worker
+            std::optional<elastic_configuration> elastic_;
+
+            // one thread per cpu selected by the placement policy.  each thread
+            // is a copy of the prototype with cpuId_ set to its selected cpu.
+            static configuration from_placement
+            (
+                cpu_topology const &,
+                placement const &,
+                thread_configuration const &
+            );
+
+            static configuration from_placement
+            (
+                placement const &,
+                thread_configuration const &
+            );
         };
 
         thread_pool
@@ -44,9 +107,46 @@ namespace maniscalco::system
 
         void stop(synchronization_mode);
 
+        // workers currently running (always threads_.size() unless elastic)
+        std::size_t get_worker_count() const;
+
     private:
+
+        void start_worker
+        (
+            std::size_t
+        );
+
+        void retire_worker
+        (
+            std::size_t
+        );
+
+        void control
+        (
+            std::stop_token const &,
+            elastic_configuration const &
+        );
+
+        std::vector<thread_configuration>               threadConfigurations_;
+
+        statistics_page *                               statisticsPage_;
+
+        stall_watchdog *                                stallWatchdog_;
+
+        // destroyed after threads_ so that worker contexts outlive their threads
+        std::vector<std::unique_ptr<worker_context>>    workerContexts_;
     
-        std::vector<std::jthread>   threads_;
+        std::vector<std::jthread>                       threads_;
+
+        std::atomic<std::size_t>                        workerCount_{0};
+
+        std::mutex                                      mutex_;
+
+        std::condition_variable_any                     conditionVariable_;
+
+        // destroyed (stopped) before threads_
+        std::jthread                                    controllerThread_;
     };
     
 } // namespace maniscalco::system 
@@ -0,0 +1,231 @@
+#include "./work_stealing_executor.h"
+
+#include <thread>
+
+
+//=============================================================================
+maniscalco::system::work_stealing_executor::work_stealing_executor
+(
+    std::size_t workerCount
+):
+    workers_(workerCount)
+{
+}
+
+
+//=============================================================================
+maniscalco::system::work_stealing_executor::~work_stealing_executor
+(
+)
+{
+    stop();
+}
+
+
+//=============================================================================
+void maniscalco::system::work_stealing_executor::push
+(
+    task * newTask
+)
+{
+    if (auto currentWorker = get_worker(); currentWorker != nullptr)
+    {
+        currentWorker->deque_.push(newTask);
+    }
+    else
+    {
+        std::lock_guard lockGuard(mutex_);
+        injectionQueue_.push_back(newTask);
+        ++injectionQueueSize_;
+    }
+    // the deque's bottom_ is stored relaxed.  order it before the load of sleepers_ so that
+    // either this sees the sleeper or the sleeper's re-check sees the task.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load() > 0)
+        wake();
+}
+
+
+//=============================================================================
+auto maniscalco::system::work_stealing_executor::steal
+(
+    worker * thief
+) -> task *
+{
+    thread_local std::uint64_t threadRandom = 0x9e3779b97f4a7c15ull;
+    auto & random = (thief != nullptr) ? thief->random_ : threadRandom;
+    random ^= (random << 13);
+    random ^= (random >> 7);
+    random ^= (random << 17);
+
+    // visit every other worker once starting at a random victim
+    auto workerCount = workers_.size();
+    for (std::size_t i = 0; i < workerCount; ++i)
+    {
+        auto victim = workers_[(random + i) % workerCount].load(std::memory_order_acquire);
+        if ((victim == nullptr) || (victim == thief))
+            continue;
+        if (auto stolenTask = victim->deque_.steal(); stolenTask != nullptr)
+        {
+            if (thief != nullptr)
+                thief->stolen_.store(thief->stolen_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return stolenTask;
+        }
+    }
+    return nullptr;
+}
+
+
+//=============================================================================
+auto maniscalco::system::work_stealing_executor::find_task
+(
+) -> task *
+{
+    auto currentWorker = get_worker();
+    if (currentWorker != nullptr)
+        if (auto ownTask = currentWorker->deque_.pop(); ownTask != nullptr)
+            return ownTask;
+    if (injectionQueueSize_.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard lockGuard(mutex_);
+        if (!injectionQueue_.empty())
+        {
+            auto injectedTask = injectionQueue_.front();
+            injectionQueue_.pop_front();
+            --injectionQueueSize_;
+            return injectedTask;
+        }
+    }
+    return steal(currentWorker);
+}
+
+
+//=============================================================================
+bool maniscalco::system::work_stealing_executor::try_execute_next_task
+(
+)
+{
+    auto nextTask = find_task();
+    if (nextTask == nullptr)
+        return false;
+    execute(nextTask);
+    return true;
+}
+
+
+//=============================================================================
+void maniscalco::system::work_stealing_executor::execute
+(
+    task * currentTask
+)
+{
+    auto workerContext = worker_context::get_current();
+    if (workerContext != nullptr)
+        workerContext->on_task_begin();
+    currentTask->execute_(currentTask);
+    if (auto currentWorker = get_worker(); currentWorker != nullptr)
+        currentWorker->executed_.store(currentWorker->executed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (workerContext != nullptr)
+        workerContext->on_task_end();
+}
+
+
+//=============================================================================
+bool maniscalco::system::work_stealing_executor::has_tasks
+(
+) const
+{
+    if (injectionQueueSize_.load() > 0)
+        return true;
+    for (auto const & slot : workers_)
+        if (auto currentWorker = slot.load(std::memory_order_acquire); ((currentWorker != nullptr) && (!currentWorker->deque_.empty())))
+            return true;
+    return false;
+}
+
+
+//=============================================================================
+void maniscalco::system::work_stealing_executor::park
+(
+)
+{
+    park([](){return false;});
+}
+
+
+//=============================================================================
+void maniscalco::system::work_stealing_executor::wake
+(
+)
+{
+    ++signal_;
+    signal_.notify_one();
+}
+
+
+//=============================================================================
+void maniscalco::system::work_stealing_executor::stop
+(
+)
+{
+    stopped_ = true;
+    ++signal_;
+    signal_.notify_all();
+}
+
+
+//=============================================================================
+auto maniscalco::system::work_stealing_executor::get_statistics
+(
+) const -> statistics
+{
+    statistics result{.executed_ = 0, .stolen_ = 0};
+    for (auto const & slot : workers_)
+        if (auto currentWorker = slot.load(std::memory_order_acquire); currentWorker != nullptr)
+        {
+            result.executed_ += currentWorker->executed_.load(std::memory_order_relaxed);
+            result.stolen_ += currentWorker->stolen_.load(std::memory_order_relaxed);
+        }
+    return result;
+}
+
+
+//=============================================================================
+maniscalco::system::task_group::task_group
+(
+    work_stealing_executor & workStealingExecutor
+):
+    workStealingExecutor_(workStealingExecutor)
+{
+}
+
+
+//=============================================================================
+maniscalco::system::task_group::~task_group
+(
+)
+{
+    try
+    {
+        wait();
+    }
+    catch (...)
+    {
+        // call wait() explicitly to observe exceptions
+    }
+}
+
+
+//=============================================================================
+void maniscalco::system::task_group::wait
+(
+)
+{
+    // help first: execute other tasks (most likely our own children, from the bottom
+    // of this worker's deque) rather than blocking while the group is incomplete
+    while (pending_.load(std::memory_order_acquire) > 0)
+        if (!workStealingExecutor_.try_execute_next_task())
+            std::this_thread::yield();
+    if (failed_.exchange(false))
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+}
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "./chase_lev_deque.h"
+#include "./worker_context.h"
+#include <library/system/memory/buffer_pool.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    class task_group;
+
+
+    // fork/join execution of short lived tasks for recursive, divide and conquer work.
+    // each thread_pool worker (identified by its worker_context index) owns a chase lev
+    // deque and a task pool.  spawned tasks are pushed onto the spawning worker's deque and
+    // idle workers steal from the top of other workers' deques.  joins are help first: a
+    // thread waiting on a task_group executes tasks (its own, then stolen) until the group
+    // completes, so a contract body can fork and join without blocking its worker.
+    //
+    // tasks spawned by threads which are not workers of the executor go to a shared
+    // injection queue.  a deque belongs to the first worker_context to use its index, so the
+    // workers of a second thread_pool driving the executor take part as other threads do.
+    //
+    // a worker loop which also services a work_contract_group:
+    //
+    //      workContractGroup.set_activation_handler([&](){workStealingExecutor.wake();});
+    //      while (!stopToken.stop_requested())
+    //          if ((!workStealingExecutor.try_execute_next_task()) && (!workContractGroup.try_execute_next_contract()))
+    //              workStealingExecutor.park([&](){return (workContractGroup.get_active_contract_count() > 0);});
+    //
+    // parked thread_pool workers wake when their stop is requested.  other threads do not, call
+    // stop() along with thread_pool::stop().
+    class work_stealing_executor
+    {
+    public:
+
+        // the size of a pooled task.  larger callables are stored on the heap.
+        static auto constexpr task_size = 128;
+
+        work_stealing_executor
+        (
+            std::size_t             // number of workers (worker indices [0, n) take part)
+        );
+
+        ~work_stealing_executor();
+
+        work_stealing_executor(work_stealing_executor const &) = delete;
+        work_stealing_executor & operator = (work_stealing_executor const &) = delete;
+
+        // execute one task from the calling worker's deque or stolen from another.
+        // false if no task was found.
+        bool try_execute_next_task();
+
+        // sleep until a task is spawned, wake() or stop() is called, unless tasks are
+        // available or hasOtherWork() returns true after announcing the intent to sleep.
+        template <typename P>
+        void park
+        (
+            P &&
+        );
+
+        void park();
+
+        void wake();
+
+        void stop();
+
+        struct statistics
+        {
+            std::size_t executed_;
+            std::size_t stolen_;
+        };
+
+        statistics get_statistics() const;
+
+    private:
+
+        friend class task_group;
+
+        struct task
+        {
+            void            (*execute_)(task *);
+            task_group *    taskGroup_;
+            bool            pooled_;
+        };
+
+        template <typename F>
+        struct task_impl :
+            task
+        {
+            F function_;
+        };
+
+        struct alignas(64) worker
+        {
+            worker(worker_context const * context):context_(context), deque_(), taskPool_(task_size, 256){}
+
+            worker_context const *      context_;       // the deque's owner
+            chase_lev_deque<task *>     deque_;
+            buffer_pool                 taskPool_;
+            std::uint64_t               random_{0x9e3779b97f4a7c15ull};
+            std::atomic<std::size_t>    executed_{0};
+            std::atomic<std::size_t>    stolen_{0};
+        };
+
+        worker * get_worker();
+
+        template <typename F>
+        void spawn
+        (
+            task_group *,
+            F &&
+        );
+
+        void push
+        (
+            task *
+        );
+
+        task * find_task();
+
+        task * steal
+        (
+            worker *
+        );
+
+        bool has_tasks() const;
+
+        void execute
+        (
+            task *
+        );
+
+        std::vector<std::atomic<worker *>>      workers_;
+
+        std::vector<std::unique_ptr<worker>>    ownedWorkers_;
+
+        std::mutex                              mutex_;
+
+        std::deque<task *>                      injectionQueue_;
+
+        std::atomic<std::size_t>                injectionQueueSize_{0};
+
+        std::atomic<bool>                       stopped_{false};
+
+        alignas(64) std::atomic<std::uint32_t>  signal_{0};
+
+        alignas(64) std::atomic<std::uint32_t>  sleepers_{0};
+
+    }; // class work_stealing_executor
+
+
+    // a set of tasks which are joined together.  wait() (also called by the destructor)
+    // returns once every task spawned into the group, including tasks spawned by those
+    // tasks, has completed and rethrows the first exception thrown by any of them.
+    class task_group
+    {
+    public:
+
+        task_group
+        (
+            work_stealing_executor &
+        );
+
+        ~task_group();
+
+        task_group(task_group const &) = delete;
+        task_group & operator = (task_group const &) = delete;
+
+        template <typename F>
+        void spawn
+        (
+            F &&
+        );
+
+        void wait();
+
+    private:
+
+        friend class work_stealing_executor;
+
+        work_stealing_executor &        workStealingExecutor_;
+
+        std::atomic<std::size_t>        pending_{0};
+
+        std::atomic<bool>               failed_{false};
+
+        std::exception_ptr              exception_;
+
+    }; // class task_group
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+inline auto maniscalco::system::work_stealing_executor::get_worker
+(
+) -> worker *
+{
+    auto workerContext = worker_context::get_current();
+    if ((workerContext == nullptr) || (workerContext->get_worker_index() >= workers_.size()))
+        return nullptr;
+    auto & slot = workers_[workerContext->get_worker_index()];
+    auto current = slot.load(std::memory_order_acquire);
+    if (current == nullptr)
+    {
+        // created by the worker itself so that it owns the task pool
+        std::lock_guard lockGuard(mutex_);
+        if (current = slot.load(std::memory_order_relaxed); current == nullptr)
+        {
+            current = ownedWorkers_.emplace_back(std::make_unique<worker>(workerContext)).get();
+            slot.store(current, std::memory_order_release);
+        }
+    }
+    // a deque has a single owner.  the worker of another pool with the same index is not it.
+    if (current->context_ != workerContext)
+        return nullptr;
+    // a restarted worker (same context, new thread) takes over its predecessor's task pool
+    if (!current->taskPool_.is_owner())
+        current->taskPool_.set_owner();
+    return current;
+}
+
+
+//=============================================================================
+template <typename F>
+inline void maniscalco::system::work_stealing_executor::spawn
+(
+    task_group * taskGroup,
+    F && function
+)
+{
+    using task_type = task_impl<std::decay_t<F>>;
+    auto execute = [](task * baseTask)
+            {
+                auto currentTask = static_cast<task_type *>(baseTask);
+                auto taskGroup = currentTask->taskGroup_;
+                try
+                {
+                    currentTask->function_();
+                }
+                catch (...)
+                {
+                    if (!taskGroup->failed_.exchange(true))
+                        taskGroup->exception_ = std::current_exception();
+                }
+                auto pooled = currentTask->pooled_;
+                currentTask->~task_type();
+                if (pooled)
+                    buffer_pool::release(currentTask);
+                else
+                    ::operator delete(currentTask, std::align_val_t(alignof(task_type)));
+                // last: the group may be destroyed as soon as pending_ reaches zero
+                taskGroup->pending_.fetch_sub(1, std::memory_order_release);
+            };
+
+    void * storage = nullptr;
+    bool pooled = false;
+    if constexpr ((sizeof(task_type) <= task_size) && (alignof(task_type) <= buffer_pool::alignment))
+    {
+        if (auto currentWorker = get_worker(); currentWorker != nullptr)
+        {
+            storage = currentWorker->taskPool_.allocate();
+            pooled = true;
+        }
+    }
+    if (storage == nullptr)
+        storage = ::operator new(sizeof(task_type), std::align_val_t(alignof(task_type)));
+    auto newTask = new (storage) task_type{{execute, taskGroup, pooled}, std::forward<F>(function)};
+    taskGroup->pending_.fetch_add(1, std::memory_order_relaxed);
+    push(newTask);
+}
+
+
+//=============================================================================
+template <typename P>
+inline void maniscalco::system::work_stealing_executor::park
+(
+    P && hasOtherWork
+)
+{
+    auto signal = signal_.load();
+    ++sleepers_;
+    // re-check after announcing the intent to sleep.  a spawn after this point either is
+    // seen here or sees sleepers_ and changes signal_ before notifying.  pairs with the
+    // fence in push().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if ((!stopped_) && (!has_tasks()) && (!hasOtherWork()))
+    {
+        auto workerContext = worker_context::get_current();
+        // a retiring worker must not sleep here forever
+        std::stop_callback stopCallback((workerContext != nullptr) ? workerContext->get_stop_token() : std::stop_token(), 
+                [this](){++signal_; signal_.notify_all();});
+        if (workerContext != nullptr)
+            workerContext->on_park();
+        signal_.wait(signal);
+        if (workerContext != nullptr)
+            workerContext->on_unpark();
+    }
+    --sleepers_;
+}
+
+
+//=============================================================================
+template <typename F>
+inline void maniscalco::system::task_group::spawn
+(
+    F && function
+)
+{
+    workStealingExecutor_.spawn(this, std::forward<F>(function));
+}
@@ -0,0 +1,81 @@
+#include "./worker_context.h"
+
+
+//=============================================================================
+maniscalco::system::worker_context::worker_context
+(
+    std::size_t workerIndex,
+    std::optional<cpu_id> cpuId,
+    configuration const & config
+):
+    workerIndex_(workerIndex),
+    cpuId_(cpuId),
+    workerGroup_(config.workerGroup_),
+    busyPoll_(config.busyPoll_),
+    arena_(config.arenaCapacity_),
+    bufferPool_(config.messageBufferSize_, config.messageBufferCount_)
+{
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::worker_context::get_worker_index
+(
+) const
+{
+    return workerIndex_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::worker_context::get_cpu_id
+(
+) const -> std::optional<cpu_id>
+{
+    return cpuId_;
+}
+
+
+//=============================================================================
+std::uint32_t maniscalco::system::worker_context::get_worker_group
+(
+) const
+{
+    return workerGroup_;
+}
+
+
+//=============================================================================
+std::stop_token maniscalco::system::worker_context::get_stop_token
+(
+) const
+{
+    return stopToken_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::worker_context::get_arena
+(
+) -> arena &
+{
+    return arena_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::worker_context::get_buffer_pool
+(
+) -> buffer_pool &
+{
+    return bufferPool_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::worker_context::get_statistics
+(
+) -> statistics_page::worker_statistics *
+{
+    return statistics_;
+}
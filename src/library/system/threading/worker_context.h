@@ -0,0 +1,229 @@
+#pragma once
+
+#include <library/system/cpu_id.h>
+#include <library/system/diagnostics/stall_watchdog.h>
+#include <library/system/diagnostics/statistics_page.h>
+#include <library/system/memory/arena.h>
+#include <library/system/memory/buffer_pool.h>
+#include "./qsbr.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stop_token>
+
+
+namespace maniscalco::system
+{
+
+    class thread_pool;
+
+
+    // per worker state for thread_pool threads.  available to work functions
+    // (and contracts executed by them) via worker_context::get_current().  a worker's
+    // context is created once and reused whenever an elastic pool restarts the worker.
+    class worker_context
+    {
+    public:
+
+        static auto constexpr no_worker_group = ~std::uint32_t(0);
+
+        struct configuration
+        {
+            std::size_t     arenaCapacity_{0};          // initial size of the worker's bump arena
+            std::size_t     messageBufferSize_{0};      // zero for no message buffer pool
+            std::size_t     messageBufferCount_{0};     // buffers preallocated for the pool
+            std::uint32_t   workerGroup_{no_worker_group};  // see contract_affinity
+            // with no work, poll with pause backoff (see execute_next_contract) rather than park
+            bool            busyPoll_{false};
+        };
+
+        worker_context
+        (
+            std::size_t,
+            std::optional<cpu_id>,
+            configuration const &
+        );
+
+        worker_context(worker_context const &) = delete;
+        worker_context & operator = (worker_context const &) = delete;
+
+        // the calling thread's worker context or nullptr if not a thread_pool thread
+        static worker_context * get_current();
+
+        std::size_t get_worker_index() const;
+
+        std::optional<cpu_id> get_cpu_id() const;
+
+        std::uint32_t get_worker_group() const;
+
+        // requested when the pool stops or retires the worker.  waits which would otherwise
+        // be unbounded (execute_next_contract(), executor parks) end when it is requested.
+        std::stop_token get_stop_token() const;
+
+        bool is_busy_polling() const;
+
+        // scratch memory valid until the end of the current contract execution
+        // (reset each time execute_next_contract returns)
+        arena & get_arena();
+
+        buffer_pool & get_buffer_pool();
+
+        // the worker's slot in the thread_pool's statistics page or nullptr
+        statistics_page::worker_statistics * get_statistics();
+
+        // called by work_contract_group before executing a contract.  invokeTimestamp is
+        // the steady clock time (nanoseconds) at which the contract became ready or zero if unknown.
+        void on_execute_begin
+        (
+            std::uint32_t,      // group (trace) id
+            std::uint32_t,      // contract id
+            std::uint64_t       // invokeTimestamp
+        );
+
+        // called by work_contract_group when a contract's execution returns
+        void on_execute_end();
+
+        // called by work_contract_group at the end of each execute_next_contract.  unless
+        // called from within another execution (a contract draining a group) this resets the
+        // arena and is a quiescent state for qsbr.
+        void on_execute_complete();
+
+        // called by work_stealing_executor around each task.  the end of an outermost task
+        // is a quiescent state for qsbr.
+        void on_task_begin();
+
+        void on_task_end();
+
+        // called around the waits of workers which have no work.  parked workers are offline
+        // for qsbr unless parked from within an execution.
+        void on_park();
+
+        void on_unpark();
+
+    private:
+
+        friend class thread_pool;
+
+        static inline thread_local worker_context * current_{nullptr};
+
+        std::size_t             workerIndex_;
+        std::optional<cpu_id>   cpuId_;
+        std::uint32_t           workerGroup_;
+        bool                    busyPoll_;
+        arena                   arena_;
+        buffer_pool             bufferPool_;
+        statistics_page::worker_statistics * statistics_{nullptr};
+        stall_watchdog::execution_slot * executionSlot_{nullptr};
+        std::stop_token         stopToken_;
+        std::optional<qsbr::participant> qsbrParticipant_;     // registered by the running worker thread
+        std::size_t             executionDepth_{0};     // contracts and tasks executing on this thread
+    };
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+inline auto maniscalco::system::worker_context::get_current
+(
+) -> worker_context *
+{
+    return current_;
+}
+
+
+//=============================================================================
+inline bool maniscalco::system::worker_context::is_busy_polling
+(
+) const
+{
+    return busyPoll_;
+}
+
+
+//=============================================================================
+inline void maniscalco::system::worker_context::on_execute_begin
+(
+    std::uint32_t groupId,
+    std::uint32_t contractId,
+    std::uint64_t invokeTimestamp
+)
+{
+    ++executionDepth_;
+    if (executionSlot_ != nullptr)
+        executionSlot_->begin(groupId, contractId);
+    if (statistics_ != nullptr)
+    {
+        if (invokeTimestamp == 0)
+            return statistics_->record_execution();
+        std::uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        statistics_->record_execution((now > invokeTimestamp) ? (now - invokeTimestamp) : 0);
+    }
+}
+
+
+//=============================================================================
+inline void maniscalco::system::worker_context::on_execute_end
+(
+)
+{
+    --executionDepth_;
+    if (executionSlot_ != nullptr)
+        executionSlot_->end();
+}
+
+
+//=============================================================================
+inline void maniscalco::system::worker_context::on_park
+(
+)
+{
+    if (executionDepth_ == 0)
+        qsbrParticipant_->go_offline();
+    if (statistics_ != nullptr)
+        statistics_->record_park();
+}
+
+
+//=============================================================================
+inline void maniscalco::system::worker_context::on_unpark
+(
+)
+{
+    if (executionDepth_ == 0)
+        qsbrParticipant_->go_online();
+    if (statistics_ != nullptr)
+        statistics_->record_wake();
+}
+
+
+//=============================================================================
+inline void maniscalco::system::worker_context::on_execute_complete
+(
+)
+{
+    if (executionDepth_ != 0)
+        return; // still within the outer execution
+    arena_.reset();
+    qsbrParticipant_->quiescent_state();
+}
+
+
+//=============================================================================
+inline void maniscalco::system::worker_context::on_task_begin
+(
+)
+{
+    ++executionDepth_;
+}
+
+
+//=============================================================================
+inline void maniscalco::system::worker_context::on_task_end
+(
+)
+{
+    if (--executionDepth_ == 0)
+        qsbrParticipant_->quiescent_state();
+}
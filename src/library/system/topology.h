@@ -0,0 +1,4 @@
+#pragma once
+
+#include "./topology/cpu_topology.h"
+#include "./topology/placement.h"
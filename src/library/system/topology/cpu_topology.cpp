@@ -0,0 +1,262 @@
+#include "./cpu_topology.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+
+
+namespace
+{
+
+    //=========================================================================
+    std::optional<std::string> read_file
+    (
+        std::filesystem::path const & path
+    )
+    {
+        std::ifstream stream(path);
+        if (!stream)
+            return std::nullopt;
+        std::string content;
+        std::getline(stream, content);
+        return content;
+    }
+
+
+    //=========================================================================
+    std::optional<std::size_t> read_number
+    (
+        std::filesystem::path const & path
+    )
+    {
+        if (auto content = read_file(path); content.has_value())
+            if (auto cpus = maniscalco::system::cpu_set::from_string(*content); cpus.size() == 1)
+                return cpus.front();
+        return std::nullopt;
+    }
+
+
+    //=========================================================================
+    std::optional<maniscalco::system::cpu_set> read_cpu_list
+    (
+        std::filesystem::path const & path
+    )
+    {
+        if (auto content = read_file(path); content.has_value())
+            return maniscalco::system::cpu_set::from_string(*content);
+        return std::nullopt;
+    }
+
+
+    //=========================================================================
+    std::optional<maniscalco::system::cpu_set> read_l3_cpu_list
+    (
+        std::filesystem::path const & cpuPath
+    )
+    {
+        std::error_code errorCode;
+        for (auto const & entry : std::filesystem::directory_iterator(cpuPath / "cache", errorCode))
+        {
+            if (entry.path().filename().string().rfind("index", 0) != 0)
+                continue;
+            if (auto level = read_number(entry.path() / "level"); level == 3)
+                return read_cpu_list(entry.path() / "shared_cpu_list");
+        }
+        return std::nullopt;
+    }
+
+} // namespace
+
+
+//=============================================================================
+auto maniscalco::system::cpu_topology::discover
+(
+    std::filesystem::path const & sysfsRoot
+) -> cpu_topology
+{
+    auto cpuRoot = sysfsRoot / "cpu";
+    auto nodeRoot = sysfsRoot / "node";
+
+    auto online = read_cpu_list(cpuRoot / "online");
+    if ((!online.has_value()) || (online->empty()))
+    {
+        online = cpu_set{};
+        for (auto i = 0u; i < std::max(1u, std::thread::hardware_concurrency()); ++i)
+            online->insert(i);
+    }
+
+    // numa nodes
+    std::map<numa_node_id, cpu_set> nodes;
+    std::error_code errorCode;
+    for (auto const & entry : std::filesystem::directory_iterator(nodeRoot, errorCode))
+    {
+        auto name = entry.path().filename().string();
+        if ((name.rfind("node", 0) != 0) || (name.size() == 4) || (!std::all_of(name.begin() + 4, name.end(), ::isdigit)))
+            continue;
+        if (auto cpus = read_cpu_list(entry.path() / "cpulist"); cpus.has_value())
+            nodes[std::stoul(name.substr(4))] = *cpus;
+    }
+
+    struct raw_cpu
+    {
+        cpu_id          id_;
+        std::size_t     socketId_;
+        numa_node_id    numaNodeId_;
+        cpu_id          coreKey_;   // lowest cpu among smt siblings
+        cpu_id          l3Key_;     // lowest cpu sharing the l3
+        cpu_set         siblings_;
+        cpu_set         l3Cpus_;
+    };
+
+    auto only_online = [&](cpu_set const & cpus)
+            {
+                cpu_set result;
+                for (auto id : cpus)
+                    if (online->contains(id))
+                        result.insert(id);
+                return result;
+            };
+
+    std::vector<raw_cpu> rawCpus;
+    for (auto cpuId : *online)
+    {
+        auto cpuPath = cpuRoot / ("cpu" + std::to_string(cpuId));
+        raw_cpu rawCpu{.id_ = cpuId, .socketId_ = 0, .numaNodeId_ = 0, .coreKey_ = cpuId, .l3Key_ = cpuId};
+        rawCpu.socketId_ = read_number(cpuPath / "topology" / "physical_package_id").value_or(0);
+        rawCpu.siblings_ = read_cpu_list(cpuPath / "topology" / "thread_siblings_list").value_or(cpu_set{cpuId});
+        rawCpu.l3Cpus_ = read_l3_cpu_list(cpuPath).value_or(cpu_set{});
+        for (auto const & [nodeId, cpus] : nodes)
+            if (cpus.contains(cpuId))
+                rawCpu.numaNodeId_ = nodeId;
+        // only online cpus participate in cores and l3 domains
+        rawCpu.siblings_ = only_online(rawCpu.siblings_);
+        rawCpu.l3Cpus_ = only_online(rawCpu.l3Cpus_);
+        rawCpu.siblings_.insert(cpuId);
+        rawCpu.coreKey_ = rawCpu.siblings_.front();
+        // without l3 information treat the whole socket as one l3 domain
+        rawCpu.l3Key_ = rawCpu.l3Cpus_.empty() ? cpu_id(-1) : rawCpu.l3Cpus_.front();
+        rawCpus.push_back(rawCpu);
+    }
+
+    cpu_topology topology;
+
+    // sockets
+    std::map<std::size_t, std::size_t> socketIndex;
+    for (auto const & rawCpu : rawCpus)
+    {
+        auto [iter, inserted] = socketIndex.try_emplace(rawCpu.socketId_, topology.sockets_.size());
+        if (inserted)
+            topology.sockets_.push_back({.id_ = rawCpu.socketId_});
+        topology.sockets_[iter->second].cpus_.insert(rawCpu.id_);
+    }
+
+    // numa nodes (ensure at least one node exists)
+    for (auto const & [nodeId, cpus] : nodes)
+        topology.numaNodes_.push_back({.id_ = nodeId, .cpus_ = cpus});
+    if (topology.numaNodes_.empty())
+        topology.numaNodes_.push_back({.id_ = 0, .cpus_ = *online});
+
+    // l3 domains
+    std::map<std::tuple<std::size_t, cpu_id>, std::size_t> l3Index;
+    for (auto const & rawCpu : rawCpus)
+    {
+        auto [iter, inserted] = l3Index.try_emplace({rawCpu.socketId_, rawCpu.l3Key_}, topology.l3Domains_.size());
+        if (inserted)
+            topology.l3Domains_.push_back({.socketId_ = rawCpu.socketId_});
+        topology.l3Domains_[iter->second].cpus_.insert(rawCpu.id_);
+    }
+
+    // cores and logical cpus
+    std::map<cpu_id, std::size_t> coreIndex;
+    for (auto const & rawCpu : rawCpus)
+    {
+        auto l3 = l3Index[{rawCpu.socketId_, rawCpu.l3Key_}];
+        auto [iter, inserted] = coreIndex.try_emplace(rawCpu.coreKey_, topology.cores_.size());
+        if (inserted)
+            topology.cores_.push_back({.socketId_ = rawCpu.socketId_, .numaNodeId_ = rawCpu.numaNodeId_, .l3Index_ = l3});
+        auto & core = topology.cores_[iter->second];
+        core.cpus_.insert(rawCpu.id_);
+        topology.cpus_.push_back(
+                {
+                    .id_ = rawCpu.id_,
+                    .socketId_ = rawCpu.socketId_,
+                    .numaNodeId_ = rawCpu.numaNodeId_,
+                    .l3Index_ = l3,
+                    .coreIndex_ = iter->second,
+                    .smtIndex_ = (core.cpus_.size() - 1)
+                });
+    }
+    return topology;
+}
+
+
+//=============================================================================
+auto maniscalco::system::cpu_topology::get_cpus
+(
+) const -> std::vector<logical_cpu> const &
+{
+    return cpus_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::cpu_topology::get_cores
+(
+) const -> std::vector<core> const &
+{
+    return cores_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::cpu_topology::get_l3_domains
+(
+) const -> std::vector<l3_domain> const &
+{
+    return l3Domains_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::cpu_topology::get_numa_nodes
+(
+) const -> std::vector<numa_node> const &
+{
+    return numaNodes_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::cpu_topology::get_sockets
+(
+) const -> std::vector<socket> const &
+{
+    return sockets_;
+}
+
+
+//=============================================================================
+auto maniscalco::system::cpu_topology::get_cpu
+(
+    cpu_id cpuId
+) const -> logical_cpu const *
+{
+    auto iter = std::lower_bound(cpus_.begin(), cpus_.end(), cpuId, [](auto const & cpu, auto id){return (cpu.id_ < id);});
+    return ((iter != cpus_.end()) && (iter->id_ == cpuId)) ? &*iter : nullptr;
+}
+
+
+//=============================================================================
+auto maniscalco::system::cpu_topology::get_numa_node_id
+(
+    cpu_id cpuId
+) const -> numa_node_id
+{
+    auto cpu = get_cpu(cpuId);
+    return (cpu != nullptr) ? cpu->numaNodeId_ : 0;
+}
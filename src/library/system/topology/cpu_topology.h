@@ -0,0 +1,94 @@
+#pragma once
+
+#include <library/system/cpu_id.h>
+#include <library/system/cpu_set.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    using numa_node_id = std::size_t;
+
+
+    class cpu_topology
+    {
+    public:
+
+        struct logical_cpu
+        {
+            cpu_id          id_;
+            std::size_t     socketId_;
+            numa_node_id    numaNodeId_;
+            std::size_t     l3Index_;       // index into get_l3_domains()
+            std::size_t     coreIndex_;     // index into get_cores()
+            std::size_t     smtIndex_;      // position of this cpu among its core's siblings
+        };
+
+        struct core
+        {
+            std::size_t     socketId_;
+            numa_node_id    numaNodeId_;
+            std::size_t     l3Index_;
+            cpu_set         cpus_;          // smt siblings
+        };
+
+        struct l3_domain
+        {
+            std::size_t     socketId_;
+            cpu_set         cpus_;
+        };
+
+        struct numa_node
+        {
+            numa_node_id    id_;
+            cpu_set         cpus_;
+        };
+
+        struct socket
+        {
+            std::size_t     id_;
+            cpu_set         cpus_;
+        };
+
+        // read /sys/devices/system/cpu and /sys/devices/system/node.
+        // falls back to a flat topology (one socket, one node, no smt)
+        // when sysfs is not available.
+        static cpu_topology discover
+        (
+            std::filesystem::path const & = "/sys/devices/system"
+        );
+
+        std::vector<logical_cpu> const & get_cpus() const;
+
+        std::vector<core> const & get_cores() const;
+
+        std::vector<l3_domain> const & get_l3_domains() const;
+
+        std::vector<numa_node> const & get_numa_nodes() const;
+
+        std::vector<socket> const & get_sockets() const;
+
+        logical_cpu const * get_cpu
+        (
+            cpu_id
+        ) const;
+
+        numa_node_id get_numa_node_id
+        (
+            cpu_id
+        ) const;
+
+    private:
+
+        std::vector<logical_cpu>    cpus_;      // sorted by cpu id
+        std::vector<core>           cores_;
+        std::vector<l3_domain>      l3Domains_;
+        std::vector<numa_node>      numaNodes_;
+        std::vector<socket>         sockets_;
+    };
+
+} // namespace maniscalco::system
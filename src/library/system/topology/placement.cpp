@@ -0,0 +1,139 @@
+#include "./placement.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+
+namespace
+{
+
+    using logical_cpu = maniscalco::system::cpu_topology::logical_cpu;
+
+
+    //=========================================================================
+    std::vector<logical_cpu> compact_order
+    (
+        std::vector<logical_cpu> cpus
+    )
+    {
+        std::sort(cpus.begin(), cpus.end(), [](auto const & a, auto const & b)
+                {
+                    return std::tie(a.socketId_, a.numaNodeId_, a.l3Index_, a.coreIndex_, a.smtIndex_) <
+                            std::tie(b.socketId_, b.numaNodeId_, b.l3Index_, b.coreIndex_, b.smtIndex_);
+                });
+        return cpus;
+    }
+
+
+    //=========================================================================
+    template <typename T>
+    std::vector<logical_cpu> interleave
+    (
+        // round robin across the buckets formed by key (in compact order within each bucket)
+        std::vector<logical_cpu> const & cpus,
+        T key
+    )
+    {
+        std::map<decltype(key(cpus.front())), std::vector<logical_cpu>> buckets;
+        for (auto const & cpu : cpus)
+            buckets[key(cpu)].push_back(cpu);
+
+        std::vector<logical_cpu> result;
+        for (std::size_t i = 0; result.size() < cpus.size(); ++i)
+            for (auto const & [_, bucket] : buckets)
+                if (i < bucket.size())
+                    result.push_back(bucket[i]);
+        return result;
+    }
+
+
+    //=========================================================================
+    std::vector<logical_cpu> scatter_order
+    (
+        std::vector<logical_cpu> const & cpus
+    )
+    {
+        std::map<std::size_t, std::vector<logical_cpu>> bySmtIndex;
+        for (auto const & cpu : compact_order(cpus))
+            bySmtIndex[cpu.smtIndex_].push_back(cpu);
+
+        std::vector<logical_cpu> result;
+        for (auto const & [_, rank] : bySmtIndex)
+        {
+            // spread across l3 domains within each socket, then across sockets
+            std::vector<logical_cpu> spread;
+            std::map<std::size_t, std::vector<logical_cpu>> bySocket;
+            for (auto const & cpu : rank)
+                bySocket[cpu.socketId_].push_back(cpu);
+            for (auto const & [__, socketCpus] : bySocket)
+                for (auto const & cpu : interleave(socketCpus, [](auto const & cpu){return cpu.l3Index_;}))
+                    spread.push_back(cpu);
+            for (auto const & cpu : interleave(spread, [](auto const & cpu){return cpu.socketId_;}))
+                result.push_back(cpu);
+        }
+        return result;
+    }
+
+
+    //=========================================================================
+    std::vector<logical_cpu> physical_cores_first
+    (
+        std::vector<logical_cpu> cpus
+    )
+    {
+        cpus = compact_order(cpus);
+        std::stable_sort(cpus.begin(), cpus.end(), [](auto const & a, auto const & b){return (a.smtIndex_ < b.smtIndex_);});
+        return cpus;
+    }
+
+} // namespace
+
+
+//=============================================================================
+auto maniscalco::system::select_cpus
+(
+    cpu_topology const & topology,
+    placement const & placement
+) -> std::vector<cpu_id>
+{
+    std::vector<logical_cpu> ordered;
+    auto const & cpus = topology.get_cpus();
+    switch (placement.policy_)
+    {
+        case placement_policy::compact:
+        {
+            ordered = compact_order(cpus);
+            break;
+        }
+        case placement_policy::scatter:
+        {
+            ordered = scatter_order(cpus);
+            break;
+        }
+        case placement_policy::one_per_physical_core:
+        {
+            for (auto const & cpu : compact_order(cpus))
+                if (cpu.smtIndex_ == 0)
+                    ordered.push_back(cpu);
+            break;
+        }
+        case placement_policy::numa_node:
+        {
+            std::vector<logical_cpu> subset;
+            for (auto const & cpu : cpus)
+                if (std::find(placement.numaNodes_.begin(), placement.numaNodes_.end(), cpu.numaNodeId_) != placement.numaNodes_.end())
+                    subset.push_back(cpu);
+            ordered = physical_cores_first(subset);
+            break;
+        }
+    }
+
+    if ((placement.threadCount_ > 0) && (placement.threadCount_ < ordered.size()))
+        ordered.resize(placement.threadCount_);
+
+    std::vector<cpu_id> result;
+    for (auto const & cpu : ordered)
+        result.push_back(cpu.id_);
+    return result;
+}
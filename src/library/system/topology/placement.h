@@ -0,0 +1,35 @@
+#pragma once
+
+#include "./cpu_topology.h"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    enum class placement_policy : std::uint32_t
+    {
+        compact                 = 0,    // fill smt siblings, then cores, then l3 domains, then sockets
+        scatter                 = 1,    // spread across sockets and l3 domains, physical cores before siblings
+        one_per_physical_core   = 2,    // first smt sibling of each core only
+        numa_node               = 3     // cpus of the selected numa nodes, physical cores before siblings
+    };
+
+
+    struct placement
+    {
+        placement_policy            policy_{placement_policy::compact};
+        std::size_t                 threadCount_{0};    // zero selects every cpu the policy allows
+        std::vector<numa_node_id>   numaNodes_;         // numa_node policy only
+    };
+
+
+    std::vector<cpu_id> select_cpus
+    (
+        cpu_topology const &,
+        placement const &
+    );
+
+} // namespace maniscalco::system
@@ -2,4 +2,8 @@
 
 #include "./work_contract/work_contract_group.h"
 #include "./work_contract/work_contract.h"
-
+#include "./work_contract/this_contract.h"
+#include "./work_contract/work_contract_executor.h"
+#include "./work_contract/nested_work_contract_group.h"
+#include "./work_contract/pollable_work_contract_group.h"
+#include "./work_contract/shared_work_contract_group.h"
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "./work_contract_group.h"
+#include "./work_contract.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+
+namespace maniscalco::system
+{
+
+    // a work_contract_group which is itself scheduled as a single contract in a 
+    // parent group.  the parent contract is invoked when the child's active contract 
+    // count goes from zero to non-zero.  each execution of the parent contract 
+    // executes at most batchSize child contracts and re-invokes itself if work remains,
+    // so children sharing a parent are serviced fairly and idle children cost nothing.
+    //
+    // destruction waits for the parent contract's surrender to execute (unless the parent
+    // group has been stopped) and helps execute the parent group's contracts meanwhile, so it
+    // completes without the parent's workers and from within another of the parent's
+    // contracts.  the child must not be destroyed from within one of its own contracts.
+    template <work_contract_mode T, work_contract_mode P = T>
+    class nested_work_contract_group :
+        public work_contract_group<T>
+    {
+    public:
+
+        using parent_group_type = work_contract_group<P>;
+        using configuration = typename work_contract_group<T>::configuration;
+
+        nested_work_contract_group
+        (
+            parent_group_type &,
+            std::int64_t,           // capacity
+            std::size_t             // max child contracts executed per parent execution
+        );
+
+        nested_work_contract_group
+        (
+            parent_group_type &,
+            configuration const &,
+            std::size_t
+        );
+
+        ~nested_work_contract_group();
+
+        std::size_t get_batch_size() const;
+
+    private:
+
+        void execute_batch();
+
+        void invoke_parent();
+
+        parent_group_type & parentGroup_;
+
+        std::size_t         batchSize_;
+
+        std::atomic<bool>   surrendered_{false};
+
+        // serializes invocations of the parent contract with its surrender
+        std::mutex          parentContractMutex_;
+
+        work_contract<P>    parentContract_;
+
+    }; // class nested_work_contract_group
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T, maniscalco::system::work_contract_mode P>
+inline maniscalco::system::nested_work_contract_group<T, P>::nested_work_contract_group
+(
+    parent_group_type & parentGroup,
+    std::int64_t capacity,
+    std::size_t batchSize
+):
+    nested_work_contract_group(parentGroup, configuration{.capacity_ = capacity}, batchSize)
+{
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T, maniscalco::system::work_contract_mode P>
+inline maniscalco::system::nested_work_contract_group<T, P>::nested_work_contract_group
+(
+    parent_group_type & parentGroup,
+    configuration const & config,
+    std::size_t batchSize
+):
+    work_contract_group<T>(config),
+    parentGroup_(parentGroup),
+    batchSize_(std::max<std::size_t>(batchSize, 1)),
+    parentContract_(parentGroup.create_contract([this](){execute_batch();},
+            [this](){surrendered_.store(true, std::memory_order_release);}))
+{
+    if (!parentContract_.is_valid())
+        throw std::runtime_error("nested_work_contract_group: parent work_contract_group has no free contracts");
+    this->set_activation_handler([this](){invoke_parent();});
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T, maniscalco::system::work_contract_mode P>
+inline maniscalco::system::nested_work_contract_group<T, P>::~nested_work_contract_group
+(
+)
+{
+    bool surrendering = false;
+    {
+        std::lock_guard lockGuard(parentContractMutex_);
+        surrendering = parentContract_.surrender();
+    }
+    // a batch might still be executing.  once the surrender has executed it can not be.
+    while ((surrendering) && (!surrendered_.load(std::memory_order_acquire)))
+    {
+        parentGroup_.try_execute_next_contract();
+        std::this_thread::yield();
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T, maniscalco::system::work_contract_mode P>
+inline void maniscalco::system::nested_work_contract_group<T, P>::execute_batch
+(
+)
+{
+    // the parent contract executes exclusively so this is the only thread draining 
+    // the child.  if the child empties mid batch then any later invocation is an 
+    // activation which re-invokes the parent contract, so nothing is lost.  the batch
+    // also ends when the parent group's time slice is used.
+    for (std::size_t i = 0; ((i < batchSize_) && (this->get_active_contract_count() > 0)); ++i)
+    {
+        this->try_execute_next_contract();
+        if (this_contract::should_yield())
+            break;
+    }
+    if (this->get_active_contract_count() > 0)
+        invoke_parent();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T, maniscalco::system::work_contract_mode P>
+inline void maniscalco::system::nested_work_contract_group<T, P>::invoke_parent
+(
+)
+{
+    // no effect once the destructor has surrendered the parent contract
+    std::lock_guard lockGuard(parentContractMutex_);
+    if (parentContract_.is_valid())
+        parentContract_.invoke();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T, maniscalco::system::work_contract_mode P>
+inline std::size_t maniscalco::system::nested_work_contract_group<T, P>::get_batch_size
+(
+) const
+{
+    return batchSize_;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "./work_contract_group.h"
+#include "./work_contract.h"
+
+#include <include/file_descriptor.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+
+namespace maniscalco::system
+{
+
+    // a work_contract_group for threads which are driven by an external event loop
+    // (epoll, poll, libevent etc.) rather than blocking in execute_next_contract.
+    // get_file_descriptor() is an eventfd which becomes readable when the active contract
+    // count goes from zero to non-zero.  the event loop calls drain() when it is readable.
+    // invokes on a group that is already active make no system calls, nor do activations
+    // while drain() is running (drain() signals once at the end if work remains).
+    template <work_contract_mode T = work_contract_mode::non_waitable>
+    class pollable_work_contract_group :
+        public work_contract_group<T>
+    {
+    public:
+
+        using configuration = typename work_contract_group<T>::configuration;
+
+        pollable_work_contract_group
+        (
+            std::int64_t            // capacity
+        );
+
+        pollable_work_contract_group
+        (
+            configuration const &
+        );
+
+        ~pollable_work_contract_group();
+
+        // register for read readiness (EPOLLIN/POLLIN).  level triggered or edge triggered
+        // polling both work.  do not read from it directly, drain() does so.
+        file_descriptor const & get_file_descriptor() const;
+
+        // execute up to maxContracts contracts.  if work remains afterwards the descriptor
+        // is made readable again so that the event loop comes back after servicing its other
+        // events.  returns the number of contracts still active.
+        std::size_t drain
+        (
+            std::size_t = ~std::size_t(0)
+        );
+
+    private:
+
+        void on_activation();
+
+        void signal();
+
+        file_descriptor     eventFileDescriptor_;
+
+        std::atomic<bool>   draining_{false};
+
+    }; // class pollable_work_contract_group
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::pollable_work_contract_group<T>::pollable_work_contract_group
+(
+    std::int64_t capacity
+):
+    pollable_work_contract_group(configuration{.capacity_ = capacity})
+{
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::pollable_work_contract_group<T>::pollable_work_contract_group
+(
+    configuration const & config
+):
+    work_contract_group<T>(config),
+    eventFileDescriptor_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (!eventFileDescriptor_.is_valid())
+        throw std::runtime_error("pollable_work_contract_group: eventfd failed");
+    this->set_activation_handler([this](){on_activation();});
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::pollable_work_contract_group<T>::~pollable_work_contract_group
+(
+)
+{
+    // waits for an activation which is in progress.  the descriptor is not written after.
+    this->set_activation_handler(nullptr);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::pollable_work_contract_group<T>::get_file_descriptor
+(
+) const -> file_descriptor const &
+{
+    return eventFileDescriptor_;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::pollable_work_contract_group<T>::on_activation
+(
+)
+{
+    // pairs with the fence in drain: either the drain sees the active contract or this
+    // sees that the drain is over
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!draining_.load(std::memory_order_relaxed))
+        signal();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::pollable_work_contract_group<T>::signal
+(
+)
+{
+    std::uint64_t value = 1;
+    [[maybe_unused]] auto result = ::write(eventFileDescriptor_.get(), &value, sizeof(value));
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::size_t maniscalco::system::pollable_work_contract_group<T>::drain
+(
+    std::size_t maxContracts
+)
+{
+    // consume the readiness before executing.  activations during the drain (a contract
+    // which re-invokes itself drops the count to zero and back on every execution) are
+    // not written.  the check once the drain is over signals for them instead.
+    std::uint64_t value;
+    [[maybe_unused]] auto result = ::read(eventFileDescriptor_.get(), &value, sizeof(value));
+    draining_.store(true, std::memory_order_relaxed);
+    for (std::size_t i = 0; ((i < maxContracts) && (this->get_active_contract_count() > 0)); ++i)
+        this->try_execute_next_contract();
+    draining_.store(false, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto activeContractCount = this->get_active_contract_count();
+    if (activeContractCount > 0)
+        signal();
+    return activeContractCount;
+}
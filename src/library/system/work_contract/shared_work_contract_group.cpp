@@ -0,0 +1,341 @@
+#include "./shared_work_contract_group.h"
+#include "./this_contract.h"
+
+#include <include/file_descriptor.h>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <bit>
+#include <climits>
+#include <new>
+#include <stdexcept>
+
+
+namespace
+{
+
+    //=========================================================================
+    std::string get_path
+    (
+        std::string const & name
+    )
+    {
+        return ("/dev/shm/" + name);
+    }
+
+} // namespace
+
+
+//=============================================================================
+std::size_t maniscalco::system::shared_work_contract_group::region::get_size
+(
+    std::uint32_t capacity,
+    std::size_t & counterOffset,
+    std::size_t & flagsOffset
+)
+{
+    counterOffset = sizeof(header);
+    flagsOffset = counterOffset + (((capacity * sizeof(std::uint64_t)) + 63) & ~63ull);
+    return flagsOffset + (capacity * sizeof(std::int32_t));
+}
+
+
+//=============================================================================
+maniscalco::system::shared_work_contract_group::region::region
+(
+    std::string const & name,
+    std::uint32_t capacity
+):
+    path_(get_path(name)),
+    owner_(true),
+    capacity_(capacity),
+    firstContractIndex_(capacity - 1)
+{
+    std::size_t counterOffset;
+    std::size_t flagsOffset;
+    size_ = get_size(capacity, counterOffset, flagsOffset);
+
+    file_descriptor fileDescriptor(::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600));
+    if ((!fileDescriptor.is_valid()) || (::ftruncate(fileDescriptor.get(), size_) != 0))
+        throw std::runtime_error("shared_work_contract_group: failed to create " + path_);
+    address_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fileDescriptor.get(), 0);
+    if (address_ == MAP_FAILED)
+    {
+        address_ = nullptr;
+        throw std::runtime_error("shared_work_contract_group: failed to map " + path_);
+    }
+
+    // zero filled by ftruncate: empty counters and unallocated contracts
+    auto base = static_cast<std::byte *>(address_);
+    invocationCounter_ = new (base + counterOffset) std::atomic<std::uint64_t>[capacity]{};
+    flags_ = new (base + flagsOffset) std::atomic<std::int32_t>[capacity]{};
+    header_ = new (base) header{};
+    header_->version_ = header::current_version;
+    header_->capacity_ = capacity;
+    header_->counterOffset_ = counterOffset;
+    header_->flagsOffset_ = flagsOffset;
+    // magic last so that clients never see a partially initialized region
+    std::atomic_ref(header_->magic_).store(header::magic, std::memory_order_release);
+}
+
+
+//=============================================================================
+maniscalco::system::shared_work_contract_group::region::region
+(
+    std::string const & name
+):
+    path_(get_path(name))
+{
+    file_descriptor fileDescriptor(::open(path_.c_str(), O_RDWR));
+    struct stat fileStatus;
+    if ((!fileDescriptor.is_valid()) || (::fstat(fileDescriptor.get(), &fileStatus) != 0) || ((std::size_t)fileStatus.st_size < sizeof(header)))
+        throw std::runtime_error("shared_work_contract_group: failed to open " + path_);
+    size_ = fileStatus.st_size;
+    address_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor.get(), 0);
+    if (address_ == MAP_FAILED)
+    {
+        address_ = nullptr;
+        throw std::runtime_error("shared_work_contract_group: failed to map " + path_);
+    }
+
+    header_ = static_cast<header *>(address_);
+    std::size_t counterOffset;
+    std::size_t flagsOffset;
+    if ((std::atomic_ref(header_->magic_).load(std::memory_order_acquire) != header::magic) ||
+        (header_->version_ != header::current_version) ||
+        (get_size(header_->capacity_, counterOffset, flagsOffset) != size_) ||
+        (counterOffset != header_->counterOffset_) || (flagsOffset != header_->flagsOffset_))
+    {
+        ::munmap(address_, size_);
+        throw std::runtime_error("shared_work_contract_group: incompatible region " + path_);
+    }
+    auto base = static_cast<std::byte *>(address_);
+    invocationCounter_ = reinterpret_cast<std::atomic<std::uint64_t> *>(base + counterOffset);
+    flags_ = reinterpret_cast<std::atomic<std::int32_t> *>(base + flagsOffset);
+    capacity_ = header_->capacity_;
+    firstContractIndex_ = capacity_ - 1;
+}
+
+
+//=============================================================================
+maniscalco::system::shared_work_contract_group::region::~region
+(
+)
+{
+    if (address_ != nullptr)
+        ::munmap(address_, size_);
+    if (owner_)
+        ::unlink(path_.c_str());
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_work_contract_group::region::wake
+(
+    std::uint32_t count
+)
+{
+    // not FUTEX_PRIVATE_FLAG.  waiters are in other processes' mappings of the same page.
+    ++header_->signal_;
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&header_->signal_), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+
+//=============================================================================
+bool maniscalco::system::shared_work_contract_group::region::wait
+(
+    std::uint32_t signal,
+    std::chrono::nanoseconds timeout
+)
+{
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec relativeTimeout{.tv_sec = seconds.count(), .tv_nsec = (timeout - seconds).count()};
+    return (::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&header_->signal_), FUTEX_WAIT, signal, 
+            (timeout == std::chrono::nanoseconds::max()) ? nullptr : &relativeTimeout, nullptr, 0) == 0);
+}
+
+
+//=============================================================================
+maniscalco::system::shared_work_contract_group::shared_work_contract_group
+(
+    configuration const & config
+):
+    region_(std::make_unique<region>(config.name_, std::bit_ceil(std::max<std::uint32_t>(config.capacity_, 2)))),
+    work_(region_->capacity_),
+    surrender_(region_->capacity_)
+{
+    for (auto contractId = region_->capacity_; contractId > 0; --contractId)
+        freeIds_.push_back(contractId - 1);
+}
+
+
+//=============================================================================
+maniscalco::system::shared_work_contract_group::~shared_work_contract_group
+(
+)
+{
+    stop();
+}
+
+
+//=============================================================================
+auto maniscalco::system::shared_work_contract_group::create_contract
+(
+    std::function<void()> work,
+    std::function<void()> surrender
+) -> id_type
+{
+    std::lock_guard lockGuard(mutex_);
+    if (freeIds_.empty())
+        return invalid_id;
+    auto contractId = freeIds_.back();
+    freeIds_.pop_back();
+    work_[contractId] = work;
+    surrender_[contractId] = surrender;
+    region_->flags_[contractId].store(region::allocated_flag, std::memory_order_release);
+    return contractId;
+}
+
+
+//=============================================================================
+bool maniscalco::system::shared_work_contract_group::release
+(
+    id_type contractId
+)
+{
+    return region_->set_flags(contractId, region::surrender_flag | region::invoke_flag);
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::shared_work_contract_group::execute_next_contract
+(
+)
+{
+    return execute_next_contract(std::chrono::nanoseconds::max());
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::shared_work_contract_group::execute_next_contract
+(
+    std::chrono::nanoseconds maxWaitTime
+)
+{
+    if (get_active_contract_count() == 0)
+        park(maxWaitTime);
+    return try_execute_next_contract();
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_work_contract_group::park
+(
+    std::chrono::nanoseconds maxWaitTime
+)
+{
+    auto & header = *region_->header_;
+    auto signal = header.signal_.load();
+    ++header.sleepers_;
+    // re-check after announcing the intent to sleep.  an invoker either sees sleepers_ 
+    // (and changes signal_ before waking) or its increment is seen here.
+    if ((!stopped_) && (get_active_contract_count() == 0))
+        region_->wait(signal, maxWaitTime);
+    --header.sleepers_;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::shared_work_contract_group::try_execute_next_contract
+(
+)
+{
+    auto & region = *region_;
+    std::uint64_t preferenceFlags = preferenceFlags_++;
+    if (auto parent = (preferenceFlags & 1) ? region.decrement_contract_count<false>(0) : region.decrement_contract_count<true>(0))
+    {
+        while (parent < region.firstContractIndex_)
+        {
+            preferenceFlags >>= 1;
+            parent = (parent * 2) + ((preferenceFlags & 1) ? region.decrement_contract_count<false>(parent) : region.decrement_contract_count<true>(parent));
+        }
+
+        auto contractId = (parent - region.firstContractIndex_);
+        auto & flags = region.flags_[contractId];
+        if ((++flags & region::surrender_flag) != region::surrender_flag)
+        {
+            {
+                // no budget but this_contract::yield() is available
+                detail::execution_slice executionSlice(flags, {});
+                work_[contractId]();
+            }
+            if (((flags -= region::execute_flag) & region::invoke_flag) == region::invoke_flag)
+                region.increment_contract_count(contractId);
+        }
+        else
+        {
+            if (surrender_[contractId])
+                std::exchange(surrender_[contractId], nullptr)();
+            std::lock_guard lockGuard(mutex_);
+            flags = 0;
+            work_[contractId] = nullptr;
+            freeIds_.push_back(contractId);
+        }
+    }
+    auto remaining = get_active_contract_count();
+    // pass the wake along if more work remains and other workers are asleep
+    if ((remaining > 0) && (region.header_->sleepers_.load(std::memory_order_relaxed) > 0))
+        region.wake(1);
+    return remaining;
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::shared_work_contract_group::get_capacity
+(
+) const
+{
+    return region_->capacity_;
+}
+
+
+//=============================================================================
+void maniscalco::system::shared_work_contract_group::stop
+(
+)
+{
+    stopped_ = true;
+    region_->wake(INT_MAX);
+}
+
+
+//=============================================================================
+maniscalco::system::shared_work_contract_group::client::client
+(
+    std::string const & name
+):
+    region_(std::make_unique<region>(name))
+{
+}
+
+
+//=============================================================================
+maniscalco::system::shared_work_contract_group::client::~client
+(
+)
+{
+}
+
+
+//=============================================================================
+std::size_t maniscalco::system::shared_work_contract_group::client::get_capacity
+(
+) const
+{
+    return region_->capacity_;
+}
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // a work contract group whose invocation counter tree and contract flags live in a
+    // shared memory region in /dev/shm.  the owning process creates contracts and its workers
+    // execute them while any process on the host can invoke a contract by id using a client.
+    // an invoke is the same handful of atomics as an in process invoke.  a futex (process shared)
+    // wakes sleeping workers and is only touched when the active count transitions from zero
+    // while workers are sleeping.
+    //
+    // contract ids are published to clients out of band.  invoking an id which has been released
+    // is ignored, invoking an id which has been released and reused invokes the new contract.
+    class shared_work_contract_group
+    {
+    private:
+
+        class region;
+
+    public:
+
+        using id_type = std::uint32_t;
+
+        static auto constexpr invalid_id = ~id_type(0);
+
+        struct configuration
+        {
+            std::string     name_;          // file name within /dev/shm
+            std::uint32_t   capacity_;      // rounded up to a power of two
+        };
+
+        class client;
+
+        // create (or replace) the shared region
+        shared_work_contract_group
+        (
+            configuration const &
+        );
+
+        ~shared_work_contract_group();
+
+        shared_work_contract_group(shared_work_contract_group const &) = delete;
+        shared_work_contract_group & operator = (shared_work_contract_group const &) = delete;
+
+        // invalid_id if the group is full
+        id_type create_contract
+        (
+            std::function<void()>,
+            std::function<void()> = nullptr     // surrender
+        );
+
+        bool invoke
+        (
+            id_type
+        );
+
+        // schedules the contract's surrender.  the id is free for reuse once the surrender has executed.
+        bool release
+        (
+            id_type
+        );
+
+        std::size_t execute_next_contract();
+
+        std::size_t execute_next_contract
+        (
+            std::chrono::nanoseconds
+        );
+
+        std::size_t try_execute_next_contract();
+
+        std::size_t get_capacity() const;
+
+        std::size_t get_active_contract_count() const;
+
+        void stop();
+
+    private:
+
+        void park
+        (
+            std::chrono::nanoseconds
+        );
+
+        std::unique_ptr<region>                 region_;
+
+        std::vector<std::function<void()>>      work_;
+
+        std::vector<std::function<void()>>      surrender_;
+
+        std::mutex                              mutex_;
+
+        std::vector<id_type>                    freeIds_;
+
+        std::atomic<std::uint64_t>              preferenceFlags_{0};
+
+        std::atomic<bool>                       stopped_{false};
+    };
+
+
+    // invokes contracts of a shared_work_contract_group owned by another process
+    class shared_work_contract_group::client
+    {
+    public:
+
+        // map an existing group.  throws if the region does not exist or is incompatible.
+        client
+        (
+            std::string const &
+        );
+
+        ~client();
+
+        client(client const &) = delete;
+        client & operator = (client const &) = delete;
+
+        // false if the id is not a live contract
+        bool invoke
+        (
+            id_type
+        );
+
+        std::size_t get_capacity() const;
+
+        std::size_t get_active_contract_count() const;
+
+    private:
+
+        std::unique_ptr<region>     region_;
+    };
+
+
+    class shared_work_contract_group::region
+    {
+    public:
+
+        static auto constexpr surrender_flag    = 0x00000004;
+        static auto constexpr execute_flag      = 0x00000002;
+        static auto constexpr invoke_flag       = 0x00000001;
+        static auto constexpr allocated_flag    = 0x00000008;
+
+        struct alignas(64) header
+        {
+            static auto constexpr magic = 0x5052485343435721ull; // "!WCCSHRP"
+            static auto constexpr current_version = 1;
+
+            std::uint64_t                           magic_;
+            std::uint32_t                           version_;
+            std::uint32_t                           capacity_;
+            std::uint64_t                           counterOffset_;
+            std::uint64_t                           flagsOffset_;
+            alignas(64) std::atomic<std::uint32_t>  signal_;        // futex word
+            alignas(64) std::atomic<std::uint32_t>  sleepers_;
+        };
+
+        // create
+        region
+        (
+            std::string const &,
+            std::uint32_t
+        );
+
+        // open existing
+        region
+        (
+            std::string const &
+        );
+
+        ~region();
+
+        // total size of a region for the given capacity along with the offsets of the counters and flags
+        static std::size_t get_size
+        (
+            std::uint32_t,
+            std::size_t &,
+            std::size_t &
+        );
+
+        bool set_flags
+        (
+            id_type,
+            std::int32_t
+        );
+
+        void increment_contract_count
+        (
+            id_type
+        );
+
+        template <bool prefer_left>
+        std::int64_t decrement_contract_count
+        (
+            std::int64_t
+        );
+
+        std::size_t get_active_contract_count() const;
+
+        void wake
+        (
+            std::uint32_t
+        );
+
+        bool wait
+        (
+            std::uint32_t,
+            std::chrono::nanoseconds
+        );
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+        static_assert(std::atomic<std::int32_t>::is_always_lock_free);
+
+        void *                          address_{nullptr};
+        std::size_t                     size_{0};
+        std::string                     path_;
+        bool                            owner_{false};
+        header *                        header_{nullptr};
+        std::atomic<std::uint64_t> *    invocationCounter_{nullptr};
+        std::atomic<std::int32_t> *     flags_{nullptr};
+        std::int64_t                    capacity_{0};
+        std::int64_t                    firstContractIndex_{0};
+    };
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+inline bool maniscalco::system::shared_work_contract_group::region::set_flags
+(
+    id_type contractId,
+    std::int32_t flagsToSet
+)
+{
+    static auto constexpr flags_mask = (execute_flag | invoke_flag);
+    if (contractId >= capacity_)
+        return false;
+    auto & flags = flags_[contractId];
+    auto expected = flags.load(std::memory_order_relaxed);
+    do
+    {
+        if ((expected & allocated_flag) == 0)
+            return false;
+    } while (!flags.compare_exchange_weak(expected, expected | flagsToSet));
+    if ((expected & flags_mask) == 0)
+        increment_contract_count(contractId);
+    return true;
+}
+
+
+//=============================================================================
+inline void maniscalco::system::shared_work_contract_group::region::increment_contract_count
+(
+    id_type contractId
+)
+{
+    std::int64_t current = contractId + firstContractIndex_;
+    std::uint64_t previous = ~0ull;
+    while (current)
+    {
+        auto addend = ((current-- & 1ull) ? 0x0000000000000001ull : 0x0000000100000000ull);
+        previous = invocationCounter_[current >>= 1].fetch_add(addend);
+    }
+    // wake only on the transition from empty and only if someone is asleep
+    if ((previous == 0) && (header_->sleepers_.load() > 0))
+        wake(1);
+}
+
+
+//=============================================================================
+template <bool prefer_left>
+inline std::int64_t maniscalco::system::shared_work_contract_group::region::decrement_contract_count
+(
+    std::int64_t parent
+)
+{
+    static auto constexpr left_addend = 0x0000000000000001ull;
+    static auto constexpr right_addend = 0x0000000100000000ull;
+    static auto constexpr mask = (prefer_left) ? 0x00000000ffffffffull : 0xffffffff00000000ull;
+    static auto constexpr prefered_addend = (prefer_left) ? left_addend : right_addend;
+    static auto constexpr fallback_addend = (prefer_left) ? right_addend : left_addend;
+
+    auto & invocationCounter = invocationCounter_[parent];
+    auto expected = invocationCounter.load();
+    auto addend = (expected & mask) ? prefered_addend : fallback_addend;
+    while ((expected != 0) && (!invocationCounter.compare_exchange_strong(expected, expected - addend)))
+        addend = (expected & mask) ? prefered_addend : fallback_addend;
+    return expected ? (1 + (addend == right_addend)) : 0;
+}
+
+
+//=============================================================================
+inline std::size_t maniscalco::system::shared_work_contract_group::region::get_active_contract_count
+(
+) const
+{
+    auto n = invocationCounter_[0].load();
+    return ((n >> 32) + (n & 0xffffffff));
+}
+
+
+//=============================================================================
+inline bool maniscalco::system::shared_work_contract_group::invoke
+(
+    id_type contractId
+)
+{
+    return region_->set_flags(contractId, region::invoke_flag);
+}
+
+
+//=============================================================================
+inline std::size_t maniscalco::system::shared_work_contract_group::get_active_contract_count
+(
+) const
+{
+    return region_->get_active_contract_count();
+}
+
+
+//=============================================================================
+inline bool maniscalco::system::shared_work_contract_group::client::invoke
+(
+    id_type contractId
+)
+{
+    return region_->set_flags(contractId, region::invoke_flag);
+}
+
+
+//=============================================================================
+inline std::size_t maniscalco::system::shared_work_contract_group::client::get_active_contract_count
+(
+) const
+{
+    return region_->get_active_contract_count();
+}
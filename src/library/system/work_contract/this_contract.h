@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+
+namespace maniscalco::system
+{
+
+    // the budget for a single execution of a contract.  a contract which does a large amount
+    // of work polls this_contract::should_yield() between units of that work and, when it
+    // returns true, saves its progress, calls this_contract::yield() and returns.  the worker
+    // is then free to execute other contracts before this one continues.  zero places no bound.
+    struct time_slice
+    {
+        std::chrono::nanoseconds    duration_{0};
+        std::size_t                 iterations_{0};     // calls to should_yield() per execution
+
+        bool is_bounded() const{return ((duration_.count() > 0) || (iterations_ > 0));}
+    };
+
+
+    namespace this_contract
+    {
+
+        // true once the executing contract has used its group's time slice.  each call counts
+        // as one iteration and, if the slice has a duration, reads the clock.  always false
+        // outside of a contract's execution.
+        bool should_yield();
+
+        // re-invoke the executing contract.  the invocation is made while the contract is still
+        // executing so it takes effect as the execution ends, exactly as a call to invoke() from
+        // within the contract would, and cannot be lost.  the contract must return to end the
+        // execution.  no effect outside of a contract's execution.
+        void yield();
+
+    } // namespace this_contract
+
+
+    namespace detail
+    {
+
+        // the state of the contract executing on this thread.  constructed by a group around
+        // each execution.  nests (a contract may drain another group).
+        class execution_slice
+        {
+        public:
+
+            static auto constexpr invoke_flag = 0x00000001;
+
+            execution_slice
+            (
+                std::atomic<std::int32_t> & flags,
+                time_slice const & timeSlice
+            ):
+                previous_(current_),
+                flags_(flags),
+                deadline_((timeSlice.duration_.count() > 0) ? (now() + timeSlice.duration_.count()) : no_deadline),
+                iterationsRemaining_((timeSlice.iterations_ > 0) ? timeSlice.iterations_ : no_iteration_limit)
+            {
+                current_ = this;
+            }
+
+            ~execution_slice(){current_ = previous_;}
+
+            execution_slice(execution_slice const &) = delete;
+            execution_slice & operator = (execution_slice const &) = delete;
+
+            static execution_slice * get_current(){return current_;}
+
+            bool should_yield()
+            {
+                if ((iterationsRemaining_ == 0) || (--iterationsRemaining_ == 0))
+                    return true;
+                return ((deadline_ != no_deadline) && (now() >= deadline_));
+            }
+
+            void yield()
+            {
+                // the execute flag is set so this never increments the invocation counters itself
+                flags_.fetch_or(invoke_flag);
+            }
+
+        private:
+
+            static auto constexpr no_deadline = std::numeric_limits<std::int64_t>::max();
+            static auto constexpr no_iteration_limit = std::numeric_limits<std::size_t>::max();
+
+            static std::int64_t now()
+            {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            static inline thread_local execution_slice * current_{nullptr};
+
+            execution_slice *               previous_;
+            std::atomic<std::int32_t> &     flags_;
+            std::int64_t                    deadline_;
+            std::size_t                     iterationsRemaining_;
+        };
+
+    } // namespace detail
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+inline bool maniscalco::system::this_contract::should_yield
+(
+)
+{
+    auto executionSlice = detail::execution_slice::get_current();
+    return ((executionSlice != nullptr) && (executionSlice->should_yield()));
+}
+
+
+//=============================================================================
+inline void maniscalco::system::this_contract::yield
+(
+)
+{
+    if (auto executionSlice = detail::execution_slice::get_current(); executionSlice != nullptr)
+        executionSlice->yield();
+}
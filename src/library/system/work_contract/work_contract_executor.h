@@ -0,0 +1,223 @@
+#pragma once
+
+#include "./work_contract_group.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace maniscalco::system
+{
+
+    // services several work_contract_groups from a single worker loop.
+    // each group is given a weight and, while groups are busy, contracts are
+    // executed from each group in proportion to its weight (a smooth weighted
+    // round robin schedule).  workers park only when every group is empty and
+    // are woken when any group transitions from empty to non-empty.
+    //
+    // the executor installs itself as the activation handler of each group.
+    class work_contract_executor
+    {
+    public:
+
+        work_contract_executor() = default;
+
+        work_contract_executor(work_contract_executor const &) = delete;
+        work_contract_executor & operator = (work_contract_executor const &) = delete;
+
+        ~work_contract_executor();
+
+        // not thread safe.  add all groups before workers begin executing.
+        template <work_contract_mode T>
+        void add_group
+        (
+            work_contract_group<T> &,
+            std::size_t = 1
+        );
+
+        // execute the next contract from the scheduled group (or the next non-empty
+        // group after it).  parks the calling thread while all groups are empty (a thread_pool
+        // worker only until its stop is requested).
+        std::size_t execute_next_contract();
+
+        std::size_t get_active_contract_count() const;
+
+        // wake all parked workers.  subsequent calls to execute_next_contract do not park.
+        void stop();
+
+    private:
+
+        struct group_entry
+        {
+            void *          group_;
+            std::size_t     (*execute_)(void *);
+            std::size_t     (*getActiveContractCount_)(void const *);
+            std::size_t     weight_;
+        };
+
+        void build_schedule();
+
+        void on_activation();
+
+        void park();
+
+        std::vector<group_entry>                groups_;
+
+        std::vector<std::size_t>                schedule_;
+
+        std::atomic<bool>                       stopped_{false};
+
+        alignas(64) std::atomic<std::uint32_t>  signal_{0};
+
+        alignas(64) std::atomic<std::uint32_t>  parkedCount_{0};
+
+    }; // class work_contract_executor
+
+} // namespace maniscalco::system
+
+
+//=============================================================================
+inline maniscalco::system::work_contract_executor::~work_contract_executor
+(
+)
+{
+    stop();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::work_contract_executor::add_group
+(
+    work_contract_group<T> & workContractGroup,
+    std::size_t weight
+)
+{
+    groups_.push_back(
+            {
+                .group_ = &workContractGroup,
+                .execute_ = [](void * group){return static_cast<work_contract_group<T> *>(group)->try_execute_next_contract();},
+                .getActiveContractCount_ = [](void const * group){return static_cast<work_contract_group<T> const *>(group)->get_active_contract_count();},
+                .weight_ = std::max<std::size_t>(weight, 1)
+            });
+    workContractGroup.set_activation_handler([this](){on_activation();});
+    build_schedule();
+}
+
+
+//=============================================================================
+inline void maniscalco::system::work_contract_executor::build_schedule
+(
+)
+{
+    // smooth weighted round robin: spreads each group's slots evenly over the cycle
+    std::size_t totalWeight = 0;
+    for (auto const & group : groups_)
+        totalWeight += group.weight_;
+
+    std::vector<std::int64_t> current(groups_.size(), 0);
+    schedule_.clear();
+    for (std::size_t slot = 0; slot < totalWeight; ++slot)
+    {
+        std::size_t selected = 0;
+        for (std::size_t i = 0; i < groups_.size(); ++i)
+        {
+            current[i] += groups_[i].weight_;
+            if (current[i] > current[selected])
+                selected = i;
+        }
+        current[selected] -= totalWeight;
+        schedule_.push_back(selected);
+    }
+}
+
+
+//=============================================================================
+inline std::size_t maniscalco::system::work_contract_executor::execute_next_contract
+(
+)
+{
+    // each thread walks the schedule independently to avoid a shared cursor
+    thread_local std::size_t cursor = 0;
+
+    auto scheduleSize = schedule_.size();
+    for (std::size_t attempt = 0; attempt < scheduleSize; ++attempt)
+    {
+        auto & group = groups_[schedule_[cursor++ % scheduleSize]];
+        if (group.getActiveContractCount_(group.group_))
+        {
+            // if work remains somewhere and workers are parked then wake one to help
+            if ((group.execute_(group.group_) > 0) && (parkedCount_.load(std::memory_order_relaxed) > 0))
+            {
+                ++signal_;
+                signal_.notify_one();
+            }
+            return get_active_contract_count();
+        }
+    }
+    park();
+    return get_active_contract_count();
+}
+
+
+//=============================================================================
+inline std::size_t maniscalco::system::work_contract_executor::get_active_contract_count
+(
+) const
+{
+    std::size_t activeContractCount = 0;
+    for (auto const & group : groups_)
+        activeContractCount += group.getActiveContractCount_(group.group_);
+    return activeContractCount;
+}
+
+
+//=============================================================================
+inline void maniscalco::system::work_contract_executor::park
+(
+)
+{
+    auto signal = signal_.load();
+    ++parkedCount_;
+    // re-check after announcing the intent to park.  an activation after this point
+    // either is seen here or changes signal_ (and sees parkedCount_) before notifying.
+    if ((!stopped_) && (get_active_contract_count() == 0))
+    {
+        auto workerContext = worker_context::get_current();
+        // a retiring worker must not sleep here forever
+        std::stop_callback stopCallback((workerContext != nullptr) ? workerContext->get_stop_token() : std::stop_token(), 
+                [this](){++signal_; signal_.notify_all();});
+        if (workerContext != nullptr)
+            workerContext->on_park();
+        tracer::trace(tracer::event::worker_park);
+        signal_.wait(signal);
+        tracer::trace(tracer::event::worker_unpark);
+        if (workerContext != nullptr)
+            workerContext->on_unpark();
+    }
+    --parkedCount_;
+}
+
+
+//=============================================================================
+inline void maniscalco::system::work_contract_executor::on_activation
+(
+)
+{
+    ++signal_;
+    if (parkedCount_.load() > 0)
+        signal_.notify_one();
+}
+
+
+//=============================================================================
+inline void maniscalco::system::work_contract_executor::stop
+(
+)
+{
+    stopped_ = true;
+    ++signal_;
+    signal_.notify_all();
+}
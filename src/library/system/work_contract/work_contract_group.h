@@ -1,12 +1,25 @@
 #pragma once
 
+#include <library/system/diagnostics/statistics_page.h>
+#include <library/system/diagnostics/tracer.h>
+#include <library/system/memory/mapped_array.h>
+#include <library/system/memory/numa.h>
+#include <library/system/threading/pause_backoff.h>
+#include <library/system/threading/worker_context.h>
+#include "./this_contract.h"
 #include <range/v3/view/enumerate.hpp>
 
 #include <memory>
 #include <cstdint>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
+#include <stop_token>
+#include <vector>
 
 
 namespace maniscalco::system 
@@ -23,6 +36,31 @@ namespace maniscalco::system
     class work_contract;
 
 
+    // restricts a contract to the thread_pool workers selected by index (bit i of workerMask_
+    // selects worker index i, for the first 64 workers) or by worker group (see 
+    // worker_context::configuration::workerGroup_).  only selected workers execute the contract.
+    // a default constructed affinity places no restriction.
+    struct contract_affinity
+    {
+        std::uint64_t   workerMask_{0};
+        std::uint32_t   workerGroup_{worker_context::no_worker_group};
+
+        bool operator == (contract_affinity const &) const = default;
+
+        bool is_restricted() const{return ((workerMask_ != 0) || (workerGroup_ != worker_context::no_worker_group));}
+
+        bool is_eligible
+        (
+            worker_context const & workerContext
+        ) const
+        {
+            auto workerIndex = workerContext.get_worker_index();
+            return (((workerIndex < 64) && ((workerMask_ >> workerIndex) & 1)) || 
+                    ((workerGroup_ != worker_context::no_worker_group) && (workerGroup_ == workerContext.get_worker_group())));
+        }
+    };
+
+
     template <work_contract_mode T = work_contract_mode::waitable>
     class work_contract_group
     {
@@ -35,11 +73,47 @@ namespace maniscalco::system
 
         class surrender_token;
 
+        struct configuration
+        {
+            std::int64_t                capacity_;
+            // when not empty the contracts are split into equal, contiguous shards (rounded up to a 
+            // power of two) and shard i, along with its subtree of the invocation counters, is placed 
+            // on numaNodes_[i % numaNodes_.size()].  threads prefer to descend into a shard on their own node.
+            std::vector<numa_node_id>   numaNodes_;
+            // preferred page type for contract and counter storage.  huge falls back to 
+            // transparent_huge which falls back to normal.  see get_page_type()
+            page_type                   pageType_{page_type::normal};
+            // when set the group publishes its active contract count to the page and records
+            // the time at which each contract becomes ready so that workers can report queueing delay
+            statistics_page *           statisticsPage_{nullptr};
+            // contracts created with an affinity are held in a separate invocation tree (a lane) per
+            // distinct affinity, each with room for this many contracts.  lanes are created on first use.
+            std::int64_t                affinityLaneCapacity_{256};
+            // the budget for each execution of the group's contracts (see this_contract::should_yield)
+            time_slice                  timeSlice_{};
+        };
+
+        static auto constexpr max_affinity_lanes = 16;
+
+        struct numa_residency
+        {
+            numa_node_id    numaNodeId_;            // requested node for the shard
+            std::size_t     contractPages_;
+            std::size_t     contractPagesOnNode_;   // pages actually resident on the requested node
+            std::size_t     counterPages_;
+            std::size_t     counterPagesOnNode_;
+        };
+
         work_contract_group
         (
             std::int64_t
         );
 
+        work_contract_group
+        (
+            configuration const &
+        );
+
         ~work_contract_group();
 
         work_contract_type create_contract
@@ -53,6 +127,24 @@ namespace maniscalco::system
             std::function<void()>
         );
 
+        // a contract executed only by the workers selected by the affinity.  invalid if there
+        // is no free contract, the affinity's lane is full or there are already max_affinity_lanes
+        // distinct affinities.
+        work_contract_type create_contract
+        (
+            std::function<void()>,
+            contract_affinity const &
+        );
+
+        work_contract_type create_contract
+        (
+            std::function<void()>,
+            std::function<void()>,
+            contract_affinity const &
+        );
+
+        // waits (waitable groups) for an invoked contract, until stop() or, on a thread_pool
+        // worker, until the worker's stop is requested
         std::size_t execute_next_contract();
 
         std::size_t execute_next_contract
@@ -60,10 +152,37 @@ namespace maniscalco::system
             std::chrono::nanoseconds
         ) requires (waitable);
 
+        // execute the next invoked contract, if any, without ever waiting
+        std::size_t try_execute_next_contract();
+
+        // invoked (on the invoking thread) each time the active contract count transitions 
+        // from zero to non-zero.  thread safe: once set_activation_handler returns the previous
+        // handler is not executing and is not called again.  the handler must not invoke
+        // contracts of this group.
+        void set_activation_handler
+        (
+            std::function<void()>
+        );
+
+        // replace the budget for executions of the group's contracts.  thread safe, applies to
+        // executions which begin after the call.
+        void set_time_slice
+        (
+            time_slice const &
+        );
+
+        time_slice get_time_slice() const;
+
         std::size_t get_capacity() const;
 
         std::size_t get_active_contract_count() const;
 
+        // the page type actually obtained for the group's storage (the lesser of contracts and counters)
+        page_type get_page_type() const;
+
+        // per shard report of where the contract and counter storage actually resides
+        std::vector<numa_residency> get_numa_residency() const;
+
         void stop();
 
     private:
@@ -81,10 +200,13 @@ namespace maniscalco::system
             static auto constexpr surrender_flag    = 0x00000004;
             static auto constexpr execute_flag      = 0x00000002;
             static auto constexpr invoke_flag       = 0x00000001;
+            static auto constexpr no_lane           = ~std::uint32_t(0);
         
             std::function<void()>       work_;
             std::function<void()>       surrender_;
             std::atomic<std::int32_t>   flags_;
+            std::uint32_t               lane_{no_lane};     // affinity lane or no_lane
+            std::uint32_t               laneLeaf_{0};
         };
 
         void invoke
@@ -109,15 +231,33 @@ namespace maniscalco::system
             right = 1
         };
 
+        union invocation_counter;
+
         template <decrement_preference>
-        std::int64_t decrement_contract_count(std::int64_t);
+        static std::int64_t decrement_contract_count(invocation_counter *, std::int64_t);
+
+        static std::int64_t claim_invoked_leaf(invocation_counter *, std::int64_t, std::uint64_t);
+
+        static std::uint64_t increment_invocation_counters(invocation_counter *, std::int64_t);
 
         std::size_t process_contract();
 
-        void process_contract(std::int64_t);
+        void process_contract(std::int64_t, worker_context *);
+
+        bool process_affine_contract(worker_context *);
+
+        bool has_invoked_contracts(worker_context const *) const;
+
+        void busy_poll
+        (
+            worker_context const *,
+            std::chrono::nanoseconds
+        ) const;
 
         void increment_contract_count(std::int64_t);
 
+        void activate();
+
         union alignas(8) invocation_counter
         {
             invocation_counter():u64_(){static_assert(sizeof(*this) == sizeof(std::uint64_t));}
@@ -134,9 +274,36 @@ namespace maniscalco::system
             }
         };
 
-        std::vector<invocation_counter>                 invocationCounter_;
+        // invocation tree for the contracts which share one affinity
+        struct affinity_lane
+        {
+            affinity_lane
+            (
+                contract_affinity const &,
+                std::int64_t
+            );
+
+            contract_affinity                   affinity_;
+            mapped_array<invocation_counter>    invocationCounter_;
+            std::int64_t                        firstContractIndex_;
+            std::vector<std::uint32_t>          contractId_;        // by leaf
+            std::vector<std::uint32_t>          freeLeaves_;        // guarded by the group's mutex_
+            std::atomic<std::uint64_t>          preferenceFlags_{0};
+        };
 
-        std::vector<contract>                           contracts_;
+        static std::vector<typename mapped_array<contract>::numa_binding> make_contract_numa_bindings
+        (
+            configuration const &
+        );
+
+        static std::vector<typename mapped_array<invocation_counter>::numa_binding> make_invocation_counter_numa_bindings
+        (
+            configuration const &
+        );
+
+        mapped_array<invocation_counter>                invocationCounter_;
+
+        mapped_array<contract>                          contracts_;
 
         std::vector<std::shared_ptr<surrender_token>>   surrenderToken_;
 
@@ -150,7 +317,39 @@ namespace maniscalco::system
 
         std::condition_variable mutable                 conditionVariable_;
 
-        bool                                            stopped_{false};
+        std::function<void()>                           activationHandler_;
+
+        std::mutex                                      activationMutex_;
+
+        std::atomic<bool>                               hasActivationHandler_{false};
+
+        std::uint32_t                                   traceId_{tracer::allocate_group_id()};
+
+        std::atomic<bool>                               stopped_{false};
+
+        std::size_t                                     numaShardDepth_{0};
+
+        std::vector<numa_node_id>                       numaShardNode_;
+
+        std::vector<std::uint64_t>                      numaPreference_;    // indexed by numa node, descent bits for that node's shard
+
+        statistics_page *                               statisticsPage_{nullptr};
+
+        statistics_page::group_statistics *             groupStatistics_{nullptr};
+
+        std::size_t                                     statisticsPublisherId_{0};
+
+        std::unique_ptr<std::atomic<std::uint64_t>[]>   readyTimestamp_;    // per contract, only when statisticsPage_ is set
+
+        std::int64_t                                    affinityLaneCapacity_;
+
+        std::array<std::unique_ptr<affinity_lane>, max_affinity_lanes> affinityLanes_;
+
+        std::atomic<std::uint32_t>                      affinityLaneCount_{0};  // lanes are published, never removed
+
+        std::atomic<std::int64_t>                       timeSliceDuration_;     // nanoseconds
+
+        std::atomic<std::size_t>                        timeSliceIterations_;
     }; // class work_contract_group
 
 
@@ -192,15 +391,130 @@ inline maniscalco::system::work_contract_group<T>::work_contract_group
 (
     std::int64_t capacity
 ):
-    invocationCounter_(capacity - 1), 
-    contracts_(capacity),
-    surrenderToken_(capacity),
-    firstContractIndex_(capacity - 1)
+    work_contract_group(configuration{.capacity_ = capacity})
+{
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::work_contract_group<T>::work_contract_group
+(
+    configuration const & config
+):
+    invocationCounter_(config.capacity_ - 1, make_invocation_counter_numa_bindings(config), config.pageType_), 
+    contracts_(config.capacity_, make_contract_numa_bindings(config), config.pageType_),
+    surrenderToken_(config.capacity_),
+    firstContractIndex_(config.capacity_ - 1),
+    statisticsPage_(config.statisticsPage_),
+    affinityLaneCapacity_(std::bit_ceil<std::uint64_t>(std::max<std::int64_t>(config.affinityLaneCapacity_, 2))),
+    timeSliceDuration_(config.timeSlice_.duration_.count()),
+    timeSliceIterations_(config.timeSlice_.iterations_)
 {
     for (auto && [index, contract] : ranges::v3::views::enumerate(contracts_))
         contract.flags_ = (index + 1);
     contracts_.back().flags_ = ~0;
     nextAvail_ = 0;
+
+    if (!config.numaNodes_.empty())
+    {
+        auto shardCount = std::min<std::size_t>(std::bit_ceil(config.numaNodes_.size()), config.capacity_);
+        numaShardDepth_ = std::countr_zero(shardCount);
+        for (auto shard = 0ull; shard < shardCount; ++shard)
+        {
+            auto numaNodeId = config.numaNodes_[shard % config.numaNodes_.size()];
+            numaShardNode_.push_back(numaNodeId);
+            if (numaPreference_.size() <= numaNodeId)
+                numaPreference_.resize(numaNodeId + 1, ~0ull);
+            if (numaPreference_[numaNodeId] == ~0ull)
+            {
+                // descent bits are consumed lsb first from the root, so the shard's msb comes first
+                numaPreference_[numaNodeId] = 0;
+                for (auto depth = 0ull; depth < numaShardDepth_; ++depth)
+                    numaPreference_[numaNodeId] |= (((shard >> (numaShardDepth_ - depth - 1)) & 1) << depth);
+            }
+        }
+    }
+
+    if (statisticsPage_ != nullptr)
+    {
+        readyTimestamp_ = std::make_unique<std::atomic<std::uint64_t>[]>(config.capacity_);
+        if (groupStatistics_ = statisticsPage_->allocate_group_statistics(traceId_, config.capacity_); groupStatistics_ != nullptr)
+            statisticsPublisherId_ = statisticsPage_->add_publisher([this](){groupStatistics_->update(get_active_contract_count());});
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::work_contract_group<T>::make_contract_numa_bindings
+(
+    configuration const & config
+) -> std::vector<typename mapped_array<contract>::numa_binding>
+{
+    std::vector<typename mapped_array<contract>::numa_binding> numaBindings;
+    if (config.numaNodes_.empty())
+        return numaBindings;
+    std::size_t capacity = config.capacity_;
+    auto shardCount = std::min<std::size_t>(std::bit_ceil(config.numaNodes_.size()), capacity);
+    for (auto shard = 0ull; shard < shardCount; ++shard)
+        numaBindings.push_back({(shard * capacity) / shardCount, ((shard + 1) * capacity) / shardCount, 
+                config.numaNodes_[shard % config.numaNodes_.size()]});
+    return numaBindings;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::work_contract_group<T>::make_invocation_counter_numa_bindings
+(
+    configuration const & config
+) -> std::vector<typename mapped_array<invocation_counter>::numa_binding>
+{
+    // each level of the counter tree is contiguous and the shard's subtree occupies the
+    // same fraction of every level at or below the shard depth.  the levels above that are 
+    // shared by all shards and are left to first touch.
+    std::vector<typename mapped_array<invocation_counter>::numa_binding> numaBindings;
+    if (config.numaNodes_.empty())
+        return numaBindings;
+    std::size_t capacity = config.capacity_;
+    auto shardCount = std::min<std::size_t>(std::bit_ceil(config.numaNodes_.size()), capacity);
+    for (auto levelSize = shardCount; levelSize < capacity; levelSize <<= 1)
+        for (auto shard = 0ull; shard < shardCount; ++shard)
+            numaBindings.push_back({(levelSize - 1) + ((shard * levelSize) / shardCount), 
+                    (levelSize - 1) + (((shard + 1) * levelSize) / shardCount), 
+                    config.numaNodes_[shard % config.numaNodes_.size()]});
+    return numaBindings;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::work_contract_group<T>::get_numa_residency
+(
+) const -> std::vector<numa_residency>
+{
+    std::vector<numa_residency> result;
+    auto shardCount = numaShardNode_.size();
+    auto capacity = contracts_.size();
+    for (auto shard = 0ull; shard < shardCount; ++shard)
+    {
+        auto numaNodeId = numaShardNode_[shard];
+        auto [contractPages, contractPagesOnNode] = contracts_.get_numa_residency((shard * capacity) / shardCount, 
+                ((shard + 1) * capacity) / shardCount, numaNodeId);
+        numa_residency residency{.numaNodeId_ = numaNodeId, .contractPages_ = contractPages, 
+                .contractPagesOnNode_ = contractPagesOnNode, .counterPages_ = 0, .counterPagesOnNode_ = 0};
+        for (auto levelSize = shardCount; levelSize < capacity; levelSize <<= 1)
+        {
+            auto [counterPages, counterPagesOnNode] = invocationCounter_.get_numa_residency(
+                    (levelSize - 1) + ((shard * levelSize) / shardCount), 
+                    (levelSize - 1) + (((shard + 1) * levelSize) / shardCount), numaNodeId);
+            residency.counterPages_ += counterPages;
+            residency.counterPagesOnNode_ += counterPagesOnNode;
+        }
+        result.push_back(residency);
+    }
+    return result;
 }
 
 
@@ -211,6 +525,11 @@ inline maniscalco::system::work_contract_group<T>::~work_contract_group
 )
 {
     stop();
+    if (groupStatistics_ != nullptr)
+    {
+        statisticsPage_->remove_publisher(statisticsPublisherId_);
+        statisticsPage_->release_group_statistics(groupStatistics_);
+    }
 }
 
 
@@ -220,12 +539,18 @@ inline void maniscalco::system::work_contract_group<T>::stop
 (
 )
 {
-    std::lock_guard lockGuard(mutex_);
-    stopped_ = true;
-    for (auto & surrenderToken : surrenderToken_)
+    // tokens are orphaned outside of the lock.  a surrender holds its token's lock while it
+    // invokes the contract, which can take this lock to wake workers.
+    std::vector<std::shared_ptr<surrender_token>> surrenderTokens;
+    {
+        std::lock_guard lockGuard(mutex_);
+        stopped_ = true;
+        surrenderTokens = surrenderToken_;
+        conditionVariable_.notify_all();
+    }
+    for (auto & surrenderToken : surrenderTokens)
         if ((bool)surrenderToken)
             surrenderToken->orphan();
-    conditionVariable_.notify_all();
 }
 
 
@@ -250,18 +575,91 @@ inline auto maniscalco::system::work_contract_group<T>::create_contract
 {
     std::lock_guard lockGuard(mutex_);
     auto contractId = nextAvail_.load();
-    if (contractId == ~0)
+    if (contractId == ~0u)
         return {}; // no free contracts
     auto & contract = contracts_[contractId];
     nextAvail_ = contract.flags_.load();
     contract.flags_ = 0;
     contract.work_ = function;
     contract.surrender_ = surrender;
+    contract.lane_ = contract::no_lane;
     auto surrenderToken = surrenderToken_[contractId] = std::make_shared<surrender_token>(this);
     return {this, surrenderToken, contractId};
 }
 
 
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::work_contract_group<T>::create_contract
+(
+    std::function<void()> function,
+    contract_affinity const & affinity
+) -> work_contract_type
+{
+    return create_contract(function, nullptr, affinity);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::work_contract_group<T>::create_contract
+(
+    std::function<void()> function,
+    std::function<void()> surrender,
+    contract_affinity const & affinity
+) -> work_contract_type
+{
+    if (!affinity.is_restricted())
+        return create_contract(function, surrender);
+    std::lock_guard lockGuard(mutex_);
+    auto contractId = nextAvail_.load();
+    if (contractId == ~0u)
+        return {}; // no free contracts
+    auto laneCount = affinityLaneCount_.load(std::memory_order_relaxed);
+    auto laneIndex = 0u;
+    while ((laneIndex < laneCount) && (!(affinityLanes_[laneIndex]->affinity_ == affinity)))
+        ++laneIndex;
+    if (laneIndex == laneCount)
+    {
+        if (laneCount == max_affinity_lanes)
+            return {}; // no free lanes
+        affinityLanes_[laneIndex] = std::make_unique<affinity_lane>(affinity, affinityLaneCapacity_);
+        affinityLaneCount_.store(laneCount + 1, std::memory_order_release);
+    }
+    auto & lane = *affinityLanes_[laneIndex];
+    if (lane.freeLeaves_.empty())
+        return {}; // lane is full
+    auto & contract = contracts_[contractId];
+    nextAvail_ = contract.flags_.load();
+    contract.flags_ = 0;
+    contract.work_ = function;
+    contract.surrender_ = surrender;
+    contract.lane_ = laneIndex;
+    contract.laneLeaf_ = lane.freeLeaves_.back();
+    lane.freeLeaves_.pop_back();
+    lane.contractId_[contract.laneLeaf_] = contractId;
+    auto surrenderToken = surrenderToken_[contractId] = std::make_shared<surrender_token>(this);
+    return {this, surrenderToken, contractId};
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline maniscalco::system::work_contract_group<T>::affinity_lane::affinity_lane
+(
+    contract_affinity const & affinity,
+    std::int64_t capacity
+):
+    affinity_(affinity),
+    invocationCounter_(capacity - 1),
+    firstContractIndex_(capacity - 1),
+    contractId_(capacity)
+{
+    for (auto leaf = capacity; leaf-- > 0; )
+        freeLeaves_.push_back(leaf);
+}
+
+
 //=============================================================================
 template <maniscalco::system::work_contract_mode T>
 inline void maniscalco::system::work_contract_group<T>::surrender
@@ -280,6 +678,7 @@ inline void maniscalco::system::work_contract_group<T>::invoke
     work_contract_type const & workContract
 )
 {
+    tracer::trace(tracer::event::contract_invoke, traceId_, workContract.get_id());
     set_contract_flag<contract::invoke_flag>(workContract);
 }
 
@@ -305,7 +704,62 @@ inline std::size_t maniscalco::system::work_contract_group<T>::get_active_contra
 (
 ) const
 {
-    return invocationCounter_[0].get_count();
+    auto count = invocationCounter_[0].get_count();
+    for (auto i = 0u, laneCount = affinityLaneCount_.load(std::memory_order_acquire); i < laneCount; ++i)
+        count += affinityLanes_[i]->invocationCounter_[0].get_count();
+    return count;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline bool maniscalco::system::work_contract_group<T>::has_invoked_contracts
+(
+    // true if there are invoked contracts which the calling worker may execute
+    worker_context const * workerContext
+) const
+{
+    if (invocationCounter_[0].get_count())
+        return true;
+    if (workerContext != nullptr)
+        for (auto i = 0u, laneCount = affinityLaneCount_.load(std::memory_order_acquire); i < laneCount; ++i)
+            if ((affinityLanes_[i]->invocationCounter_[0].get_count()) && (affinityLanes_[i]->affinity_.is_eligible(*workerContext)))
+                return true;
+    return false;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::work_contract_group<T>::busy_poll
+(
+    // wait for an invoked contract by spinning rather than parking.  the worker is never
+    // descheduled so there is no wake up latency.  the clock is read first and then once per
+    // pauses_per_clock_read pauses, however long the backoff, so that the deadline is overshot
+    // by no more than that many pauses.
+    worker_context const * workerContext,
+    std::chrono::nanoseconds maxWaitTime
+) const
+{
+    static auto constexpr pauses_per_clock_read = (2 * pause_backoff::max_pauses);
+
+    if (has_invoked_contracts(workerContext))
+        return;
+    auto deadline = (maxWaitTime == std::chrono::nanoseconds::max()) ? std::chrono::steady_clock::time_point::max() : 
+            (std::chrono::steady_clock::now() + maxWaitTime);
+    auto stopToken = workerContext->get_stop_token();
+    pause_backoff pauseBackoff;
+    std::uint32_t pausesSinceClockRead = pauses_per_clock_read;
+    while ((!has_invoked_contracts(workerContext)) && (!stopped_.load(std::memory_order_relaxed)))
+    {
+        if (pausesSinceClockRead >= pauses_per_clock_read)
+        {
+            if ((std::chrono::steady_clock::now() >= deadline) || (stopToken.stop_requested()))
+                break;
+            pausesSinceClockRead = 0;
+        }
+        pausesSinceClockRead += pauseBackoff();
+    }
 }
 
 
@@ -316,16 +770,54 @@ inline void maniscalco::system::work_contract_group<T>::increment_contract_count
     std::int64_t current
 )
 {
-    current += firstContractIndex_;
-    while (current)
+    if (readyTimestamp_)
+        readyTimestamp_[current].store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+    if (auto const & contract = contracts_[current]; contract.lane_ == contract::no_lane)
     {
-        auto addend = ((current-- & 1ull) ? left_addend : right_addend);
-        invocationCounter_[current >>= 1].u64_ += addend;
+        if (increment_invocation_counters(invocationCounter_.data(), current + firstContractIndex_) == 0)
+            activate();
+        if constexpr (waitable)
+        {
+            conditionVariable_.notify_one();
+        }
     }
-    if constexpr (waitable)
+    else
+    {
+        auto & lane = *affinityLanes_[contract.lane_];
+        if (increment_invocation_counters(lane.invocationCounter_.data(), contract.laneLeaf_ + lane.firstContractIndex_) == 0)
+        {
+            activate();
+            if constexpr (waitable)
+            {
+                // the one worker woken might not be eligible.  while the lane is not empty
+                // its eligible workers do not park so later invokes need not wake them.
+                // taking the lock means that a worker which is about to park either sees
+                // the invoke or is already waiting for this notification.
+                std::lock_guard lockGuard(mutex_);
+                conditionVariable_.notify_all();
+            }
+        }
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::uint64_t maniscalco::system::work_contract_group<T>::increment_invocation_counters
+(
+    invocation_counter * invocationCounter,
+    std::int64_t current
+)
+{
+    std::uint64_t previous = ~0ull;
+    while (current)
     {
-        conditionVariable_.notify_one();
+        auto addend = ((current-- & 1ull) ? left_addend : right_addend);
+        previous = invocationCounter[current >>= 1].u64_.fetch_add(addend);
     }
+    // previous is the root's prior value
+    return previous;
 }
 
 
@@ -338,10 +830,20 @@ inline std::size_t maniscalco::system::work_contract_group<T>::execute_next_cont
 {
     if constexpr (waitable)
     {
-        if (!get_active_contract_count())
+        if (auto workerContext = worker_context::get_current(); (workerContext != nullptr) && (workerContext->is_busy_polling()))
+        {
+            busy_poll(workerContext, maxWaitTime);
+        }
+        else if (!has_invoked_contracts(workerContext))
         {
+            if (workerContext != nullptr)
+                workerContext->on_park();
+            tracer::trace(tracer::event::worker_park, traceId_);
             std::unique_lock uniqueLock(mutex_);
-            conditionVariable_.wait_for(uniqueLock, maxWaitTime, [&]{return get_active_contract_count();});
+            conditionVariable_.wait_for(uniqueLock, maxWaitTime, [&]{return has_invoked_contracts(workerContext);});
+            tracer::trace(tracer::event::worker_unpark, traceId_);
+            if (workerContext != nullptr)
+                workerContext->on_unpark();
         }
     }
     return process_contract();
@@ -356,36 +858,167 @@ inline std::size_t maniscalco::system::work_contract_group<T>::execute_next_cont
 {
     if constexpr (waitable)
     {
-        if (!get_active_contract_count())
+        if (auto workerContext = worker_context::get_current(); (workerContext != nullptr) && (workerContext->is_busy_polling()))
         {
+            busy_poll(workerContext, std::chrono::nanoseconds::max());
+        }
+        else if (!has_invoked_contracts(workerContext))
+        {
+            // a retiring worker must not sleep here forever
+            auto stopToken = (workerContext != nullptr) ? workerContext->get_stop_token() : std::stop_token();
+            std::stop_callback stopCallback(stopToken, [this](){std::lock_guard lockGuard(mutex_); conditionVariable_.notify_all();});
+            if (workerContext != nullptr)
+                workerContext->on_park();
+            tracer::trace(tracer::event::worker_park, traceId_);
             std::unique_lock uniqueLock(mutex_);
-            conditionVariable_.wait(uniqueLock, [&]{return ((stopped_) || (get_active_contract_count()));});
+            conditionVariable_.wait(uniqueLock, [&]{return ((stopped_) || (stopToken.stop_requested()) || (has_invoked_contracts(workerContext)));});
+            tracer::trace(tracer::event::worker_unpark, traceId_);
+            if (workerContext != nullptr)
+                workerContext->on_unpark();
         }
     }
     return process_contract();
 }
 
 
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::size_t maniscalco::system::work_contract_group<T>::try_execute_next_contract
+(
+)
+{
+    return process_contract();
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::work_contract_group<T>::set_activation_handler
+(
+    std::function<void()> activationHandler
+)
+{
+    std::lock_guard lockGuard(activationMutex_);
+    hasActivationHandler_.store((bool)activationHandler, std::memory_order_release);
+    activationHandler_ = activationHandler;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::work_contract_group<T>::activate
+(
+)
+{
+    // groups without a handler take no lock.  the handler is called under the lock so that
+    // replacing it waits for a call which is in progress.
+    if (hasActivationHandler_.load(std::memory_order_acquire))
+    {
+        std::lock_guard lockGuard(activationMutex_);
+        if (activationHandler_)
+            activationHandler_();
+    }
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline void maniscalco::system::work_contract_group<T>::set_time_slice
+(
+    time_slice const & timeSlice
+)
+{
+    timeSliceDuration_.store(timeSlice.duration_.count(), std::memory_order_relaxed);
+    timeSliceIterations_.store(timeSlice.iterations_, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::work_contract_group<T>::get_time_slice
+(
+) const -> time_slice
+{
+    return {std::chrono::nanoseconds(timeSliceDuration_.load(std::memory_order_relaxed)), timeSliceIterations_.load(std::memory_order_relaxed)};
+}
+
+
 //=============================================================================
 template <maniscalco::system::work_contract_mode T>
 inline std::size_t maniscalco::system::work_contract_group<T>::process_contract
 (
 )
+{
+    auto workerContext = worker_context::get_current();
+    // affine contracts first.  only eligible workers can execute them.
+    if ((affinityLaneCount_.load(std::memory_order_acquire) == 0) || (workerContext == nullptr) || (!process_affine_contract(workerContext)))
+    {
+        std::uint64_t preferenceFlags = preferenceFlags_++;
+        if (!numaPreference_.empty())
+            if (auto numaNodeId = get_thread_numa_node_id(); ((numaNodeId < numaPreference_.size()) && (numaPreference_[numaNodeId] != ~0ull)))
+                preferenceFlags = ((preferenceFlags << numaShardDepth_) | numaPreference_[numaNodeId]);
+        if (auto leaf = claim_invoked_leaf(invocationCounter_.data(), firstContractIndex_, preferenceFlags))
+            process_contract(leaf - firstContractIndex_, workerContext);
+    }
+    if (workerContext != nullptr)
+        workerContext->on_execute_complete();
+    // the contracts which remain for this worker, including those of its eligible lanes
+    auto count = invocationCounter_[0].get_count();
+    if (workerContext != nullptr)
+        for (auto i = 0u, laneCount = affinityLaneCount_.load(std::memory_order_acquire); i < laneCount; ++i)
+            if (affinityLanes_[i]->affinity_.is_eligible(*workerContext))
+                count += affinityLanes_[i]->invocationCounter_[0].get_count();
+    return count;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline bool maniscalco::system::work_contract_group<T>::process_affine_contract
+(
+    worker_context * workerContext
+)
+{
+    for (auto i = 0u, laneCount = affinityLaneCount_.load(std::memory_order_acquire); i < laneCount; ++i)
+    {
+        auto & lane = *affinityLanes_[i];
+        if ((lane.invocationCounter_[0].u64_.load(std::memory_order_relaxed) == 0) || (!lane.affinity_.is_eligible(*workerContext)))
+            continue;
+        if (auto leaf = claim_invoked_leaf(lane.invocationCounter_.data(), lane.firstContractIndex_, lane.preferenceFlags_++))
+        {
+            process_contract(lane.contractId_[leaf - lane.firstContractIndex_], workerContext);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline std::int64_t maniscalco::system::work_contract_group<T>::claim_invoked_leaf
+(
+    // descend from the root to an invoked leaf, decrementing the counters along the way.
+    // zero if there are no invoked contracts.
+    invocation_counter * invocationCounter,
+    std::int64_t firstLeaf,
+    std::uint64_t preferenceFlags
+)
 {
     static auto constexpr right = decrement_preference::right;
     static auto constexpr left = decrement_preference::left;
 
-    std::uint64_t preferenceFlags = preferenceFlags_++;
-    if (auto parent = (preferenceFlags & 1) ? decrement_contract_count<right>(0) : decrement_contract_count<left>(0))   
+    auto parent = (preferenceFlags & 1) ? decrement_contract_count<right>(invocationCounter, 0) : decrement_contract_count<left>(invocationCounter, 0);
+    if (parent)
     {
-        while (parent < firstContractIndex_) 
+        while (parent < firstLeaf) 
         {
-            parent = (parent * 2) + ((preferenceFlags & 1) ? decrement_contract_count<right>(parent) : decrement_contract_count<left>(parent));
             preferenceFlags >>= 1;
+            parent = (parent * 2) + ((preferenceFlags & 1) ? decrement_contract_count<right>(invocationCounter, parent) : 
+                    decrement_contract_count<left>(invocationCounter, parent));
         }
-        process_contract(parent);
     }
-    return invocationCounter_[0].get_count();
+    return parent;
 }
 
 
@@ -394,6 +1027,7 @@ template <maniscalco::system::work_contract_mode T>
 template <maniscalco::system::work_contract_group<T>::decrement_preference T_>
 inline std::int64_t maniscalco::system::work_contract_group<T>::decrement_contract_count
 (
+    invocation_counter * invocationCounters,
     std::int64_t parent
 )
 {
@@ -402,7 +1036,7 @@ inline std::int64_t maniscalco::system::work_contract_group<T>::decrement_contra
     static auto constexpr prefered_addend = (left_preference) ? left_addend : right_addend;
     static auto constexpr fallback_addend = (left_preference) ? right_addend : left_addend;
 
-    auto & invocationCounter = invocationCounter_[parent].u64_;
+    auto & invocationCounter = invocationCounters[parent].u64_;
     auto expected = invocationCounter.load();
     auto addend = (expected & mask) ? prefered_addend : fallback_addend;
     while ((expected != 0) && (!invocationCounter.compare_exchange_strong(expected, expected - addend)))
@@ -415,20 +1049,30 @@ inline std::int64_t maniscalco::system::work_contract_group<T>::decrement_contra
 template <maniscalco::system::work_contract_mode T>
 inline void maniscalco::system::work_contract_group<T>::process_contract
 (
-    std::int64_t parent
+    std::int64_t contractId,
+    worker_context * workerContext
 )
 {
-    auto contractId = (parent - firstContractIndex_);
     auto & contract = contracts_[contractId];
     auto & flags = contract.flags_;
     if ((++flags & contract::surrender_flag) != contract::surrender_flag)
     {
-        contract.work_();
+        if (workerContext != nullptr)
+            workerContext->on_execute_begin(traceId_, contractId, (readyTimestamp_) ? readyTimestamp_[contractId].load(std::memory_order_relaxed) : 0);
+        tracer::trace(tracer::event::contract_execute_begin, traceId_, contractId);
+        {
+            detail::execution_slice executionSlice(flags, get_time_slice());
+            contract.work_();
+        }
+        if (workerContext != nullptr)
+            workerContext->on_execute_end();
+        tracer::trace(tracer::event::contract_execute_end, traceId_, contractId);
         if (((flags -= contract::execute_flag) & contract::invoke_flag) == contract::invoke_flag)
             increment_contract_count(contractId);
     }
     else
     {
+        tracer::trace(tracer::event::contract_surrender, traceId_, contractId);
         if (contract.surrender_)
             std::exchange(contract.surrender_, nullptr)();
         std::lock_guard lockGuard(mutex_);
@@ -436,6 +1080,8 @@ inline void maniscalco::system::work_contract_group<T>::process_contract
         nextAvail_ = contractId;
         contract.work_ = nullptr;
         surrenderToken_[contractId] = {};
+        if (contract.lane_ != contract::no_lane)
+            affinityLanes_[std::exchange(contract.lane_, contract::no_lane)]->freeLeaves_.push_back(contract.laneLeaf_);
     }
 }
 
@@ -450,6 +1096,16 @@ inline std::size_t maniscalco::system::work_contract_group<T>::get_capacity
 }
 
 
+//=============================================================================
+template <maniscalco::system::work_contract_mode T>
+inline auto maniscalco::system::work_contract_group<T>::get_page_type
+(
+) const -> page_type
+{
+    return std::min(contracts_.get_page_type(), invocationCounter_.get_page_type());
+}
+
+
 //=============================================================================
 template <maniscalco::system::work_contract_mode T>
 inline maniscalco::system::work_contract_group<T>::surrender_token::surrender_token